@@ -1,31 +1,255 @@
 #include <application.h>
 #include <usb_talk.h>
+#include <config.h>
+#include <profiler.h>
+#include <ram.h>
+#include <led_strip_lut.h>
+#include <ws2812b.h>
 
 #define PREFIX_REMOTE "remote"
 #define PREFIX_BASE "base"
+#define SAMPLE_INTERVAL 1000
 #define UPDATE_INTERVAL 5000
-
-#define MAX_PIXELS 150
+#define CO2_SAMPLE_INTERVAL 30000
+#define CO2_UPDATE_INTERVAL 60000
+#define LCD_PAGE_INTERVAL 2000
+#define FILTER_ALPHA 0.3f
+#define CONFIG_INTERVAL_MIN 100
+#define CONFIG_INTERVAL_MAX 86400000
+#define CONFIG_ADDRESS 0
+#define SCENE_ADDRESS 0x100
+#define SCENE_PIXELS_ADDRESS 0x180
+
+#define MAX_PIXELS 600
+#define DEFAULT_PIXELS 150
 #define APPLICATION_TASK_ID 0
+#define STREAM_TIMEOUT 1000
+#define STREAM_REPORT_INTERVAL 1000
+#define GAMMA_MAX 5
+#define LED_STRIP_SEGMENT_COUNT 4
+// Segment i is cut into at most i + 1 pieces by the lower ids, with a gap possible around every piece
+#define LED_STRIP_RUN_COUNT (LED_STRIP_SEGMENT_COUNT * (LED_STRIP_SEGMENT_COUNT + 1) + 1)
+#define LED_STRIP_RUN_NONE 0xff
+#define LED_STRIP_EFFECT_WAIT 20
+#define LED_STRIP_EFFECT_WAIT_MIN 10
+#define LED_STRIP_EFFECT_WAIT_MAX 10000
+#define REMOTE_COUNT 8
+
+static config_t config;
+static const config_t config_default =
+{
+    .sensor = {
+        [CONFIG_SENSOR_THERMOMETER] = { SAMPLE_INTERVAL, UPDATE_INTERVAL, { SENSOR_FILTER_MEAN, 1, FILTER_ALPHA, 2 } },
+        [CONFIG_SENSOR_HYGROMETER] = { SAMPLE_INTERVAL, UPDATE_INTERVAL, { SENSOR_FILTER_MEDIAN, 3, FILTER_ALPHA, 5 } },
+        [CONFIG_SENSOR_LUX_METER] = { SAMPLE_INTERVAL, UPDATE_INTERVAL, { SENSOR_FILTER_MEDIAN, 3, FILTER_ALPHA, 100 } },
+        [CONFIG_SENSOR_BAROMETER] = { SAMPLE_INTERVAL, UPDATE_INTERVAL, { SENSOR_FILTER_MEAN, 1, FILTER_ALPHA, 100 } },
+        [CONFIG_SENSOR_CO2_METER] = { CO2_SAMPLE_INTERVAL, CO2_UPDATE_INTERVAL, { SENSOR_FILTER_MEAN, 1, FILTER_ALPHA, 200 } }
+    },
+    .lcd_page_interval = LCD_PAGE_INTERVAL
+};
+static const char *config_sensor_names[CONFIG_SENSOR_COUNT] =
+{
+    "thermometer", "hygrometer", "lux-meter", "barometer", "co2-meter"
+};
+
+static usb_talk_enum_t led_strip_type_enums[] =
+{
+    { .name = "rgb" }, { .name = "rgbw" }, { .name = NULL }
+};
+static usb_talk_field_t led_strip_config_fields[] =
+{
+    USB_TALK_FIELD_ENUM(led_strip_config_payload_t, type, "type", led_strip_type_enums, true),
+    USB_TALK_FIELD_INT(led_strip_config_payload_t, count, "count", 1, MAX_PIXELS, true)
+};
+static usb_talk_schema_t led_strip_config_schema = USB_TALK_SCHEMA(led_strip_config_fields);
+static usb_talk_field_t led_strip_brightness_fields[] =
+{
+    USB_TALK_FIELD_INT(led_strip_brightness_payload_t, brightness, "brightness", 0, 255, false),
+    USB_TALK_FIELD_FLOAT(led_strip_brightness_payload_t, gamma, "gamma", 0, GAMMA_MAX, false),
+    USB_TALK_FIELD_FLOAT(led_strip_brightness_payload_t, gamma_channel[0], "gamma-red", 0, GAMMA_MAX, false),
+    USB_TALK_FIELD_FLOAT(led_strip_brightness_payload_t, gamma_channel[1], "gamma-green", 0, GAMMA_MAX, false),
+    USB_TALK_FIELD_FLOAT(led_strip_brightness_payload_t, gamma_channel[2], "gamma-blue", 0, GAMMA_MAX, false),
+    USB_TALK_FIELD_FLOAT(led_strip_brightness_payload_t, gamma_channel[3], "gamma-white", 0, GAMMA_MAX, false)
+};
+static usb_talk_schema_t led_strip_brightness_schema = USB_TALK_SCHEMA(led_strip_brightness_fields);
+static usb_talk_field_t led_strip_segment_config_fields[] =
+{
+    USB_TALK_FIELD_INT(led_strip_segment_config_payload_t, offset, "offset", 0, MAX_PIXELS - 1, true),
+    USB_TALK_FIELD_INT(led_strip_segment_config_payload_t, count, "count", 0, MAX_PIXELS, true)
+};
+static usb_talk_schema_t led_strip_segment_config_schema = USB_TALK_SCHEMA(led_strip_segment_config_fields);
+static usb_talk_field_t led_strip_segment_brightness_fields[] =
+{
+    USB_TALK_FIELD_INT(led_strip_brightness_payload_t, brightness, "brightness", 0, 255, true)
+};
+static usb_talk_schema_t led_strip_segment_brightness_schema = USB_TALK_SCHEMA(led_strip_segment_brightness_fields);
+static usb_talk_enum_t led_strip_effect_enums[] =
+{
+    [LED_STRIP_EFFECT_NONE] = { .name = "none" },
+    [LED_STRIP_EFFECT_RAINBOW] = { .name = "rainbow" },
+    [LED_STRIP_EFFECT_PULSE] = { .name = "pulse" },
+    { .name = NULL }
+};
+static usb_talk_field_t led_strip_effect_fields[] =
+{
+    USB_TALK_FIELD_ENUM(led_strip_effect_payload_t, effect, "effect", led_strip_effect_enums, true),
+    USB_TALK_FIELD_INT(led_strip_effect_payload_t, wait, "wait", LED_STRIP_EFFECT_WAIT_MIN, LED_STRIP_EFFECT_WAIT_MAX, false)
+};
+static usb_talk_schema_t led_strip_effect_schema = USB_TALK_SCHEMA(led_strip_effect_fields);
+static usb_talk_field_t lcd_text_fields[] =
+{
+    USB_TALK_FIELD_INT(lcd_text_payload_t, x, "x", INT32_MIN + 1, INT32_MAX, true),
+    USB_TALK_FIELD_INT(lcd_text_payload_t, y, "y", INT32_MIN + 1, INT32_MAX, true),
+    USB_TALK_FIELD_STRING(lcd_text_payload_t, text, "text", true),
+    USB_TALK_FIELD_INT(lcd_text_payload_t, font, "font", 0, INT32_MAX, false)
+};
+static usb_talk_schema_t lcd_text_schema = USB_TALK_SCHEMA(lcd_text_fields);
+static usb_talk_field_t lcd_config_fields[] =
+{
+    USB_TALK_FIELD_INT(lcd_config_payload_t, page_interval, "page-interval", CONFIG_INTERVAL_MIN, CONFIG_INTERVAL_MAX, true)
+};
+static usb_talk_schema_t lcd_config_schema = USB_TALK_SCHEMA(lcd_config_fields);
+static usb_talk_enum_t sensor_filter_enums[] =
+{
+    [SENSOR_FILTER_MEAN] = { .name = "mean" },
+    [SENSOR_FILTER_MEDIAN] = { .name = "median" },
+    [SENSOR_FILTER_EMA] = { .name = "ema" },
+    [SENSOR_FILTER_OUTLIER] = { .name = "outlier" },
+    { .name = NULL }
+};
+static usb_talk_field_t sensor_config_fields[] =
+{
+    USB_TALK_FIELD_INT(sensor_config_payload_t, sample_interval, "sample-interval", CONFIG_INTERVAL_MIN, CONFIG_INTERVAL_MAX, false),
+    USB_TALK_FIELD_INT(sensor_config_payload_t, update_interval, "update-interval", CONFIG_INTERVAL_MIN, CONFIG_INTERVAL_MAX, false),
+    USB_TALK_FIELD_ENUM(sensor_config_payload_t, filter, "filter", sensor_filter_enums, false),
+    USB_TALK_FIELD_INT(sensor_config_payload_t, oversample, "oversample", 1, SENSOR_FILTER_LENGTH, false),
+    USB_TALK_FIELD_FLOAT(sensor_config_payload_t, alpha, "alpha", 0, 1, false),
+    USB_TALK_FIELD_FLOAT(sensor_config_payload_t, limit, "limit", 0, 100000, false)
+};
+static usb_talk_schema_t sensor_config_schema = USB_TALK_SCHEMA(sensor_config_fields);
+
+static struct
+{
+    profiler_t *application;
+    profiler_t *led_strip;
+    profiler_t *lcd;
+    profiler_t *button;
+    profiler_t *radio;
+    profiler_t *sensor[CONFIG_SENSOR_COUNT];
+    size_t index;
+    bc_scheduler_task_id_t task_id;
+
+} profilers;
 
 static bc_led_t led;
 static bool led_state;
 
 static bool light;
-static uint8_t pixels[MAX_PIXELS * 4];
+static uint8_t pixels_buffers[2][MAX_PIXELS * 4];
+// The strip is sent from the front buffer while uploads fill the back one, the two swap before a write
+static uint8_t *pixels = pixels_buffers[0];
 static size_t pixels_length;
-static uint32_t _dma_buffer[MAX_PIXELS * 4 * 2];
+// The driver sends straight from the pixels, segments and brightness are applied to each pixel as it goes out
 static bc_led_strip_buffer_t led_strip_buffer =
 {
     .type = BC_LED_STRIP_TYPE_RGBW,
-    .count = MAX_PIXELS,
-    .buffer = _dma_buffer
+    .count = DEFAULT_PIXELS,
+    .buffer = (uint32_t *) pixels_buffers[0]
 };
 static bc_led_strip_t led_strip;
-static int led_strip_count = MAX_PIXELS;
+static int led_strip_count = DEFAULT_PIXELS;
+
+static struct
+{
+    bc_scheduler_task_id_t task_id;
+    bool active;
+    bool started;
+    uint16_t sequence;
+    bool pending;
+    uint32_t received;
+    uint32_t shown;
+    uint32_t late;
+    uint32_t dropped;
+    uint32_t report_shown;
+    bc_tick_t report_tick;
+
+} stream;
+
+static struct
+{
+    uint8_t *back;
+    bool active;
+    bool ready;
+
+} upload = { .back = pixels_buffers[1] };
+
+static struct
+{
+    bc_scheduler_task_id_t task_id;
+    led_strip_reconfig_state_t state;
+    led_strip_config_payload_t request;
+    bool pending;
+
+} reconfig;
+
+static struct
+{
+    bc_scheduler_task_id_t task_id;
+    led_strip_segment_t list[LED_STRIP_SEGMENT_COUNT];
+    // Worked out before each write, the interrupt only walks them
+    led_strip_segment_frame_t frame[LED_STRIP_SEGMENT_COUNT];
+    led_strip_run_t runs[LED_STRIP_RUN_COUNT];
+    const led_strip_run_t *run;
+    uint8_t wheel;
+    uint16_t rest;
+
+} segments;
+
+static struct
+{
+    bc_scheduler_task_id_t task_id;
+    int index;
+
+} sensor_last;
+
+static struct
+{
+    bc_scheduler_task_id_t task_id;
+    size_t index;
+    ram_buffer_t *pixels;
+    ram_buffer_t *upload;
+
+} ram_stats;
+
+static struct
+{
+    bc_scheduler_task_id_t task_id;
+    boot_phase_t phase;
+    profiler_t phases[BOOT_PHASE_COUNT];
+    bc_tick_t ready_tick;
+
+} boot;
+static const char *boot_phase_names[BOOT_PHASE_COUNT] =
+{
+    "core", "light", "radio", "lcd", "tags", "modules"
+};
+
+static remote_t remotes[REMOTE_COUNT];
+
+static bc_tag_temperature_t temperature_tag[4];
+static sensor_t temperature_sensor[4];
+static bc_tag_humidity_t humidity_tag[6];
+static sensor_t humidity_sensor[6];
+static bc_tag_lux_meter_t lux_meter[4];
+static sensor_t lux_meter_sensor[4];
+static bc_tag_barometer_t barometer_tag[2];
+static barometer_t barometer_sensor[2];
+static sensor_filter_t co2_filter;
+static sensor_stats_t co2_stats;
 
 static struct {
     bc_tick_t next_update;
+    bc_tick_t next_page;
     bool mqtt;
     struct {
         float_t temperature;
@@ -43,7 +267,6 @@ static struct {
         float_t altitude;
         float_t co2_concentation;
     } remote;
-    uint8_t cnt;
     uint8_t page;
 
 } lcd;
@@ -93,6 +316,9 @@ static void barometer_tag_event_handler(bc_tag_barometer_t *self, bc_tag_baromet
 static void co2_event_handler(bc_module_co2_event_t event, void *event_param);
 static void encoder_event_handler(bc_module_encoder_event_t event, void *param);
 static void set_default_pixels(void);
+static void _sensor_stats_set_single(sensor_stats_t *stats, float value);
+static void _radio_buffer_get_stats(uint8_t *buffer, sensor_stats_t *stats);
+static void _remote_seen(uint32_t *peer_device_address);
 
 static void led_state_set(usb_talk_payload_t *payload, void *param);
 static void led_state_get(usb_talk_payload_t *payload, void *param);
@@ -103,164 +329,149 @@ static void relay_state_set(usb_talk_payload_t *payload, void *param);
 static void relay_state_get(usb_talk_payload_t *payload, void *param);
 static void module_relay_state_set(usb_talk_payload_t *payload, void *param);
 static void module_relay_state_get(usb_talk_payload_t *payload, void *param);
-static void led_strip_framebuffer_set(usb_talk_payload_t *payload, void *param);
-static void led_strip_framebuffer_set(usb_talk_payload_t *payload, void *param);
+static bool led_strip_framebuffer_set(usb_talk_data_t *data, void *param);
 static void led_strip_config_set(usb_talk_payload_t *payload, void *param);
 static void led_strip_config_get(usb_talk_payload_t *payload, void *param);
+static void _led_strip_reconfig_task(void *param);
+static void led_strip_brightness_set(usb_talk_payload_t *payload, void *param);
+static void led_strip_brightness_get(usb_talk_payload_t *payload, void *param);
+static void led_strip_segment_config_set(usb_talk_payload_t *payload, void *param);
+static void led_strip_segment_config_get(usb_talk_payload_t *payload, void *param);
+static bool led_strip_segment_framebuffer_set(usb_talk_data_t *data, void *param);
+static void led_strip_segment_brightness_set(usb_talk_payload_t *payload, void *param);
+static void led_strip_segment_effect_set(usb_talk_payload_t *payload, void *param);
+static void _led_strip_segment_task(void *param);
+static led_strip_segment_t *_led_strip_segment_find(int position);
+static void _led_strip_segment_prepare(void);
+static void _led_strip_wheel(uint8_t wheel, uint8_t color[4]);
+static void _led_strip_pixel(int position, uint8_t color[4]);
+static bool _led_strip_write(void);
+static uint8_t *_led_strip_upload_begin(void);
+static void _led_strip_upload_end(bool done);
+static bool _led_strip_scene_check(const led_strip_scene_t *scene);
+static void _led_strip_scene_restore(void);
+static void led_strip_scene_save(usb_talk_payload_t *payload, void *param);
+static void led_strip_stream_start(usb_talk_payload_t *payload, void *param);
+static bool _led_strip_stream_frame(usb_talk_frame_t *frame, void *param);
+static void _led_strip_stream_report(void);
+static void _led_strip_stream_task(void *param);
 static void lcd_text_set(usb_talk_payload_t *payload, void *param);
+static void lcd_config_set(usb_talk_payload_t *payload, void *param);
+static void lcd_config_get(usb_talk_payload_t *payload, void *param);
+static void sensor_config_set(usb_talk_payload_t *payload, void *param);
+static void sensor_config_get(usb_talk_payload_t *payload, void *param);
+static bool _config_check(const config_t *config);
+static void _config_apply(void);
+static void _config_apply_filter(sensor_filter_t *filter, const sensor_filter_config_t *config);
+static void sensor_last_get(usb_talk_payload_t *payload, void *param);
+static void sensor_last_get_channel(usb_talk_payload_t *payload, void *param);
+static void sensor_last_get_all(usb_talk_payload_t *payload, void *param);
+static void _sensor_last_task(void *param);
+static bool _sensor_last_channel(config_sensor_t sensor, uint8_t bus, uint8_t number, uint8_t *i2c);
+static sensor_stats_t *_sensor_last_find(config_sensor_t sensor, uint8_t i2c);
+static void _sensor_last_publish(config_sensor_t sensor, const uint8_t *i2c);
+static void stats_cpu_get(usb_talk_payload_t *payload, void *param);
+static void stats_cpu_reset(usb_talk_payload_t *payload, void *param);
+static void _stats_cpu_task(void *param);
+static void stats_usb_get(usb_talk_payload_t *payload, void *param);
+static void stats_usb_reset(usb_talk_payload_t *payload, void *param);
+static void stats_boot_get(usb_talk_payload_t *payload, void *param);
+static void stats_ram_get(usb_talk_payload_t *payload, void *param);
+static void _stats_ram_task(void *param);
+static void state_snapshot_get(usb_talk_payload_t *payload, void *param);
+static void _radio_buffer_process(uint8_t *buffer, size_t length);
+static bool _radio_buffer_legacy(uint8_t *buffer, size_t length, radio_schema_record_t *record);
+static void _radio_record_encoder(radio_schema_record_t *record);
+static void _radio_record_thermometer(radio_schema_record_t *record);
+static void _radio_record_humidity(radio_schema_record_t *record);
+static void _radio_record_lux_meter(radio_schema_record_t *record);
+static void _radio_record_barometer(radio_schema_record_t *record);
+static void _radio_record_co2(radio_schema_record_t *record);
+static void _boot_task(void *param);
+static bool _boot_is_ready(boot_phase_t phase);
+
+static void (*const radio_record_handlers[RADIO_BUFFER_COUNT])(radio_schema_record_t *record) =
+{
+    [RADIO_BUFFER_ENCODER] = _radio_record_encoder,
+    [RADIO_BUFFER_THERMOMETER] = _radio_record_thermometer,
+    [RADIO_BUFFER_HUMIDITY] = _radio_record_humidity,
+    [RADIO_BUFFER_LUX_METER] = _radio_record_lux_meter,
+    [RADIO_BUFFER_BAROMETER] = _radio_record_barometer,
+    [RADIO_BUFFER_CO2] = _radio_record_co2
+};
 
 void application_init(void)
 {
-    usb_talk_init();
-
-    bc_led_init(&led, BC_GPIO_LED, false, false);
+    // First, so the stack below is still untouched when it is painted
+    ram_init();
 
-    bc_module_power_init();
-
-    set_default_pixels();
-
-    bc_led_strip_init(&led_strip, bc_module_power_get_led_strip_driver(), &led_strip_buffer);
-
-    bc_module_lcd_init(&_bc_module_lcd_framebuffer);
-    bc_module_lcd_clear();
-    bc_module_lcd_update();
+    profiler_init();
+    profiler_start(&boot.phases[BOOT_PHASE_CORE]);
 
-    static bc_button_t button;
-    bc_button_init(&button, BC_GPIO_BUTTON, BC_GPIO_PULL_DOWN, false);
-    bc_button_set_event_handler(&button, button_event_handler, NULL);
+    // The checksum only tells the config is intact, not that it is in range for the divides and tables it feeds
+    if (!config_load(CONFIG_ADDRESS, &config, sizeof(config)) || !_config_check(&config))
+    {
+        config = config_default;
+    }
 
-    // Initialize radio
-    bc_radio_init();
-    bc_radio_set_event_handler(radio_event_handler, NULL);
-    bc_radio_listen();
-
-    // Tags
-    static bc_tag_temperature_t temperature_tag_0_48;
-    bc_tag_temperature_init(&temperature_tag_0_48, BC_I2C_I2C0, BC_TAG_TEMPERATURE_I2C_ADDRESS_DEFAULT);
-    bc_tag_temperature_set_update_interval(&temperature_tag_0_48, UPDATE_INTERVAL);
-    static uint8_t temperature_tag_0_48_i2c = (BC_I2C_I2C0 << 7) | BC_TAG_TEMPERATURE_I2C_ADDRESS_DEFAULT;
-    bc_tag_temperature_set_event_handler(&temperature_tag_0_48, temperature_tag_event_handler, &temperature_tag_0_48_i2c);
-
-    static bc_tag_temperature_t temperature_tag_0_49;
-    bc_tag_temperature_init(&temperature_tag_0_49, BC_I2C_I2C0, BC_TAG_TEMPERATURE_I2C_ADDRESS_ALTERNATE);
-    bc_tag_temperature_set_update_interval(&temperature_tag_0_49, UPDATE_INTERVAL);
-    static uint8_t temperature_tag_0_49_i2c = (BC_I2C_I2C0 << 7) | BC_TAG_TEMPERATURE_I2C_ADDRESS_ALTERNATE;
-    bc_tag_temperature_set_event_handler(&temperature_tag_0_49, temperature_tag_event_handler, &temperature_tag_0_49_i2c);
-
-    static bc_tag_temperature_t temperature_tag_1_48;
-    bc_tag_temperature_init(&temperature_tag_1_48, BC_I2C_I2C1, BC_TAG_TEMPERATURE_I2C_ADDRESS_DEFAULT);
-    bc_tag_temperature_set_update_interval(&temperature_tag_1_48, UPDATE_INTERVAL);
-    static uint8_t temperature_tag_1_48_i2c = (BC_I2C_I2C1 << 7) | BC_TAG_TEMPERATURE_I2C_ADDRESS_DEFAULT;
-    bc_tag_temperature_set_event_handler(&temperature_tag_1_48, temperature_tag_event_handler,&temperature_tag_1_48_i2c);
-
-    static bc_tag_temperature_t temperature_tag_1_49;
-    bc_tag_temperature_init(&temperature_tag_1_49, BC_I2C_I2C1, BC_TAG_TEMPERATURE_I2C_ADDRESS_ALTERNATE);
-    bc_tag_temperature_set_update_interval(&temperature_tag_1_49, UPDATE_INTERVAL);
-    static uint8_t temperature_tag_1_49_i2c = (BC_I2C_I2C1 << 7) | BC_TAG_TEMPERATURE_I2C_ADDRESS_ALTERNATE;
-    bc_tag_temperature_set_event_handler(&temperature_tag_1_49, temperature_tag_event_handler,&temperature_tag_1_49_i2c);
-
-    //----------------------------
-
-    static bc_tag_humidity_t humidity_tag_r2_0_40;
-    bc_tag_humidity_init(&humidity_tag_r2_0_40, BC_TAG_HUMIDITY_REVISION_R2, BC_I2C_I2C0, BC_TAG_HUMIDITY_I2C_ADDRESS_DEFAULT);
-    bc_tag_humidity_set_update_interval(&humidity_tag_r2_0_40, UPDATE_INTERVAL);
-    static uint8_t humidity_tag_r2_0_40_i2c = (BC_I2C_I2C0 << 7) | 0x40;
-    bc_tag_humidity_set_event_handler(&humidity_tag_r2_0_40, humidity_tag_event_handler, &humidity_tag_r2_0_40_i2c);
-
-    static bc_tag_humidity_t humidity_tag_r2_0_41;
-    bc_tag_humidity_init(&humidity_tag_r2_0_41, BC_TAG_HUMIDITY_REVISION_R2, BC_I2C_I2C0, BC_TAG_HUMIDITY_I2C_ADDRESS_ALTERNATE);
-    bc_tag_humidity_set_update_interval(&humidity_tag_r2_0_41, UPDATE_INTERVAL);
-    static uint8_t humidity_tag_r2_0_41_i2c = (BC_I2C_I2C0 << 7) | 0x41;
-    bc_tag_humidity_set_event_handler(&humidity_tag_r2_0_41, humidity_tag_event_handler, &humidity_tag_r2_0_41_i2c);
-
-    static bc_tag_humidity_t humidity_tag_r1_0_5f;
-    bc_tag_humidity_init(&humidity_tag_r1_0_5f, BC_TAG_HUMIDITY_REVISION_R1, BC_I2C_I2C0, BC_TAG_HUMIDITY_I2C_ADDRESS_DEFAULT);
-    bc_tag_humidity_set_update_interval(&humidity_tag_r1_0_5f, UPDATE_INTERVAL);
-    static uint8_t humidity_tag_r1_0_5f_i2c = (BC_I2C_I2C0 << 7) | 0x5f;
-    bc_tag_humidity_set_event_handler(&humidity_tag_r1_0_5f, humidity_tag_event_handler, &humidity_tag_r1_0_5f_i2c);
-
-    static bc_tag_humidity_t humidity_tag_r2_1_40;
-    bc_tag_humidity_init(&humidity_tag_r2_1_40, BC_TAG_HUMIDITY_REVISION_R2, BC_I2C_I2C1, BC_TAG_HUMIDITY_I2C_ADDRESS_DEFAULT);
-    bc_tag_humidity_set_update_interval(&humidity_tag_r2_1_40, UPDATE_INTERVAL);
-    static uint8_t humidity_tag_r2_1_40_i2c = (BC_I2C_I2C1 << 7) | 0x40;
-    bc_tag_humidity_set_event_handler(&humidity_tag_r2_1_40, humidity_tag_event_handler, &humidity_tag_r2_1_40_i2c);
-
-    static bc_tag_humidity_t humidity_tag_r2_1_41;
-    bc_tag_humidity_init(&humidity_tag_r2_1_41, BC_TAG_HUMIDITY_REVISION_R2, BC_I2C_I2C1, BC_TAG_HUMIDITY_I2C_ADDRESS_ALTERNATE);
-    bc_tag_humidity_set_update_interval(&humidity_tag_r2_1_41, UPDATE_INTERVAL);
-    static uint8_t humidity_tag_r2_1_41_i2c = (BC_I2C_I2C1 << 7) | 0x41;
-    bc_tag_humidity_set_event_handler(&humidity_tag_r2_1_41, humidity_tag_event_handler, &humidity_tag_r2_1_41_i2c);
-
-    static bc_tag_humidity_t humidity_tag_r1_1_5f;
-    bc_tag_humidity_init(&humidity_tag_r1_1_5f, BC_TAG_HUMIDITY_REVISION_R1, BC_I2C_I2C1, BC_TAG_HUMIDITY_I2C_ADDRESS_DEFAULT);
-    bc_tag_humidity_set_update_interval(&humidity_tag_r1_1_5f, UPDATE_INTERVAL);
-    static uint8_t humidity_tag_r1_1_5f_i2c = (BC_I2C_I2C1 << 7) | 0x5f;
-    bc_tag_humidity_set_event_handler(&humidity_tag_r1_1_5f, humidity_tag_event_handler, &humidity_tag_r1_1_5f_i2c);
-
-    //----------------------------
-
-    static bc_tag_lux_meter_t lux_meter_0_44;
-    bc_tag_lux_meter_init(&lux_meter_0_44, BC_I2C_I2C0, BC_TAG_LUX_METER_I2C_ADDRESS_DEFAULT);
-    bc_tag_lux_meter_set_update_interval(&lux_meter_0_44, UPDATE_INTERVAL);
-    static uint8_t lux_meter_0_44_i2c = (BC_I2C_I2C0 << 7) | BC_TAG_LUX_METER_I2C_ADDRESS_DEFAULT;
-    bc_tag_lux_meter_set_event_handler(&lux_meter_0_44, lux_meter_event_handler, &lux_meter_0_44_i2c);
-
-    static bc_tag_lux_meter_t lux_meter_0_45;
-    bc_tag_lux_meter_init(&lux_meter_0_45, BC_I2C_I2C0, BC_TAG_LUX_METER_I2C_ADDRESS_ALTERNATE);
-    bc_tag_lux_meter_set_update_interval(&lux_meter_0_45, UPDATE_INTERVAL);
-    static uint8_t lux_meter_0_45_i2c = (BC_I2C_I2C0 << 7) | BC_TAG_LUX_METER_I2C_ADDRESS_ALTERNATE;
-    bc_tag_lux_meter_set_event_handler(&lux_meter_0_45, lux_meter_event_handler, &lux_meter_0_45_i2c);
-
-    static bc_tag_lux_meter_t lux_meter_1_44;
-    bc_tag_lux_meter_init(&lux_meter_1_44, BC_I2C_I2C1, BC_TAG_LUX_METER_I2C_ADDRESS_DEFAULT);
-    bc_tag_lux_meter_set_update_interval(&lux_meter_1_44, UPDATE_INTERVAL);
-    static uint8_t lux_meter_1_44_i2c = (BC_I2C_I2C1 << 7) | BC_TAG_LUX_METER_I2C_ADDRESS_DEFAULT;
-    bc_tag_lux_meter_set_event_handler(&lux_meter_1_44, lux_meter_event_handler, &lux_meter_1_44_i2c);
-
-    static bc_tag_lux_meter_t lux_meter_1_45;
-    bc_tag_lux_meter_init(&lux_meter_1_45, BC_I2C_I2C1, BC_TAG_LUX_METER_I2C_ADDRESS_ALTERNATE);
-    bc_tag_lux_meter_set_update_interval(&lux_meter_1_45, UPDATE_INTERVAL);
-    static uint8_t lux_meter_1_45_i2c = (BC_I2C_I2C1 << 7) | BC_TAG_LUX_METER_I2C_ADDRESS_ALTERNATE;
-    bc_tag_lux_meter_set_event_handler(&lux_meter_1_45, lux_meter_event_handler, &lux_meter_1_45_i2c);
-
-    //----------------------------
-
-    static bc_tag_barometer_t barometer_tag_0;
-    bc_tag_barometer_init(&barometer_tag_0, BC_I2C_I2C0);
-    bc_tag_barometer_set_update_interval(&barometer_tag_0, UPDATE_INTERVAL);
-    static uint8_t barometer_tag_0_i2c = (BC_I2C_I2C0 << 7) | 0x60;
-    bc_tag_barometer_set_event_handler(&barometer_tag_0, barometer_tag_event_handler, &barometer_tag_0_i2c);
-
-    static bc_tag_barometer_t barometer_tag_1;
-    bc_tag_barometer_init(&barometer_tag_1, BC_I2C_I2C1);
-    bc_tag_barometer_set_update_interval(&barometer_tag_1, UPDATE_INTERVAL);
-    static uint8_t barometer_tag_1_i2c = (BC_I2C_I2C1 << 7) | 0x60;
-    bc_tag_barometer_set_event_handler(&barometer_tag_1, barometer_tag_event_handler, &barometer_tag_1_i2c);
-
-    //----------------------------
-
-    bc_module_co2_init();
-    bc_module_co2_set_update_interval(30000);
-    bc_module_co2_set_event_handler(co2_event_handler, NULL);
-
-    // ---------------------------
-
-    bc_module_encoder_init();
-    bc_module_encoder_set_event_handler(encoder_event_handler, NULL);
-
-    //----------------------------
-
-    bc_module_relay_init(&relay_0_0, BC_MODULE_RELAY_I2C_ADDRESS_DEFAULT);
-    bc_module_relay_init(&relay_0_1, BC_MODULE_RELAY_I2C_ADDRESS_ALTERNATE);
+    profilers.application = profiler_register("application");
+    profilers.led_strip = profiler_register("led-strip");
+    profilers.lcd = profiler_register("lcd");
+    profilers.button = profiler_register("button");
+    profilers.radio = profiler_register("radio");
+    for (int i = 0; i < CONFIG_SENSOR_COUNT; i++)
+    {
+        profilers.sensor[i] = profiler_register(config_sensor_names[i]);
+    }
+    profilers.task_id = profiler_task_register("stats-cpu", _stats_cpu_task, NULL, BC_TICK_INFINITY);
+    stream.task_id = profiler_task_register("led-strip-stream", _led_strip_stream_task, NULL, BC_TICK_INFINITY);
+    reconfig.task_id = profiler_task_register("led-strip-reconfig", _led_strip_reconfig_task, NULL, BC_TICK_INFINITY);
+    segments.task_id = profiler_task_register("led-strip-segments", _led_strip_segment_task, NULL, BC_TICK_INFINITY);
+    boot.task_id = profiler_task_register("boot", _boot_task, NULL, 0);
+    sensor_last.task_id = profiler_task_register("sensors-last", _sensor_last_task, NULL, BC_TICK_INFINITY);
+    ram_stats.task_id = profiler_task_register("stats-ram", _stats_ram_task, NULL, BC_TICK_INFINITY);
+    ram_stats.pixels = ram_buffer_register("pixels", sizeof(pixels_buffers[0]));
+    ram_stats.upload = ram_buffer_register("pixels-upload", sizeof(pixels_buffers[1]));
+    for (int i = 0; i < LED_STRIP_SEGMENT_COUNT; i++)
+    {
+        segments.list[i].id = i;
+        segments.list[i].brightness = 255;
+        segments.list[i].wait = LED_STRIP_EFFECT_WAIT;
+    }
 
+    usb_talk_init(PREFIX_BASE);
 
     usb_talk_sub(PREFIX_BASE "/led/-/state/set", led_state_set, NULL);
     usb_talk_sub(PREFIX_BASE "/led/-/state/get", led_state_get, NULL);
     usb_talk_sub(PREFIX_BASE "/light/-/state/set", light_state_set, NULL);
     usb_talk_sub(PREFIX_BASE "/light/-/state/get", light_state_get, NULL);
-    usb_talk_sub(PREFIX_BASE "/led-strip/-/framebuffer/set", led_strip_framebuffer_set, NULL);
+    usb_talk_sub_data(PREFIX_BASE "/led-strip/-/framebuffer/set", led_strip_framebuffer_set, NULL);
     usb_talk_sub(PREFIX_BASE "/led-strip/-/config/set", led_strip_config_set, NULL);
     usb_talk_sub(PREFIX_BASE "/led-strip/-/config/get", led_strip_config_get, NULL);
+    usb_talk_sub(PREFIX_BASE "/led-strip/-/brightness/set", led_strip_brightness_set, NULL);
+    usb_talk_sub(PREFIX_BASE "/led-strip/-/brightness/get", led_strip_brightness_get, NULL);
+    usb_talk_sub(PREFIX_BASE "/led-strip/-/scene/save", led_strip_scene_save, NULL);
+    usb_talk_sub(PREFIX_BASE "/led-strip/-/stream/start", led_strip_stream_start, NULL);
+    usb_talk_sub_data(PREFIX_BASE "/led-strip/0/framebuffer/set", led_strip_segment_framebuffer_set, &segments.list[0]);
+    usb_talk_sub(PREFIX_BASE "/led-strip/0/config/set", led_strip_segment_config_set, &segments.list[0]);
+    usb_talk_sub(PREFIX_BASE "/led-strip/0/config/get", led_strip_segment_config_get, &segments.list[0]);
+    usb_talk_sub(PREFIX_BASE "/led-strip/0/brightness/set", led_strip_segment_brightness_set, &segments.list[0]);
+    usb_talk_sub(PREFIX_BASE "/led-strip/0/effect/set", led_strip_segment_effect_set, &segments.list[0]);
+    usb_talk_sub_data(PREFIX_BASE "/led-strip/1/framebuffer/set", led_strip_segment_framebuffer_set, &segments.list[1]);
+    usb_talk_sub(PREFIX_BASE "/led-strip/1/config/set", led_strip_segment_config_set, &segments.list[1]);
+    usb_talk_sub(PREFIX_BASE "/led-strip/1/config/get", led_strip_segment_config_get, &segments.list[1]);
+    usb_talk_sub(PREFIX_BASE "/led-strip/1/brightness/set", led_strip_segment_brightness_set, &segments.list[1]);
+    usb_talk_sub(PREFIX_BASE "/led-strip/1/effect/set", led_strip_segment_effect_set, &segments.list[1]);
+    usb_talk_sub_data(PREFIX_BASE "/led-strip/2/framebuffer/set", led_strip_segment_framebuffer_set, &segments.list[2]);
+    usb_talk_sub(PREFIX_BASE "/led-strip/2/config/set", led_strip_segment_config_set, &segments.list[2]);
+    usb_talk_sub(PREFIX_BASE "/led-strip/2/config/get", led_strip_segment_config_get, &segments.list[2]);
+    usb_talk_sub(PREFIX_BASE "/led-strip/2/brightness/set", led_strip_segment_brightness_set, &segments.list[2]);
+    usb_talk_sub(PREFIX_BASE "/led-strip/2/effect/set", led_strip_segment_effect_set, &segments.list[2]);
+    usb_talk_sub_data(PREFIX_BASE "/led-strip/3/framebuffer/set", led_strip_segment_framebuffer_set, &segments.list[3]);
+    usb_talk_sub(PREFIX_BASE "/led-strip/3/config/set", led_strip_segment_config_set, &segments.list[3]);
+    usb_talk_sub(PREFIX_BASE "/led-strip/3/config/get", led_strip_segment_config_get, &segments.list[3]);
+    usb_talk_sub(PREFIX_BASE "/led-strip/3/brightness/set", led_strip_segment_brightness_set, &segments.list[3]);
+    usb_talk_sub(PREFIX_BASE "/led-strip/3/effect/set", led_strip_segment_effect_set, &segments.list[3]);
     usb_talk_sub(PREFIX_BASE "/relay/-/state/set", relay_state_set, NULL);
     usb_talk_sub(PREFIX_BASE "/relay/-/state/get", relay_state_get, NULL);
     usb_talk_sub(PREFIX_BASE "/relay/0:0/state/set", module_relay_state_set, &relay_0_0);
@@ -268,26 +479,244 @@ void application_init(void)
     usb_talk_sub(PREFIX_BASE "/relay/0:1/state/set", module_relay_state_set, &relay_0_1);
     usb_talk_sub(PREFIX_BASE "/relay/0:1/state/get", module_relay_state_get, &relay_0_1);
     usb_talk_sub(PREFIX_BASE "/lcd/-/text/set", lcd_text_set, NULL);
+    usb_talk_sub(PREFIX_BASE "/lcd/-/config/set", lcd_config_set, NULL);
+    usb_talk_sub(PREFIX_BASE "/lcd/-/config/get", lcd_config_get, NULL);
+    usb_talk_sub(PREFIX_BASE "/thermometer/-/config/set", sensor_config_set, &config.sensor[CONFIG_SENSOR_THERMOMETER]);
+    usb_talk_sub(PREFIX_BASE "/thermometer/-/config/get", sensor_config_get, &config.sensor[CONFIG_SENSOR_THERMOMETER]);
+    usb_talk_sub(PREFIX_BASE "/hygrometer/-/config/set", sensor_config_set, &config.sensor[CONFIG_SENSOR_HYGROMETER]);
+    usb_talk_sub(PREFIX_BASE "/hygrometer/-/config/get", sensor_config_get, &config.sensor[CONFIG_SENSOR_HYGROMETER]);
+    usb_talk_sub(PREFIX_BASE "/lux-meter/-/config/set", sensor_config_set, &config.sensor[CONFIG_SENSOR_LUX_METER]);
+    usb_talk_sub(PREFIX_BASE "/lux-meter/-/config/get", sensor_config_get, &config.sensor[CONFIG_SENSOR_LUX_METER]);
+    usb_talk_sub(PREFIX_BASE "/barometer/-/config/set", sensor_config_set, &config.sensor[CONFIG_SENSOR_BAROMETER]);
+    usb_talk_sub(PREFIX_BASE "/barometer/-/config/get", sensor_config_get, &config.sensor[CONFIG_SENSOR_BAROMETER]);
+    usb_talk_sub(PREFIX_BASE "/co2-meter/-/config/set", sensor_config_set, &config.sensor[CONFIG_SENSOR_CO2_METER]);
+    usb_talk_sub(PREFIX_BASE "/co2-meter/-/config/get", sensor_config_get, &config.sensor[CONFIG_SENSOR_CO2_METER]);
+    usb_talk_sub(PREFIX_BASE "/thermometer/-/temperature/get", sensor_last_get, &config.sensor[CONFIG_SENSOR_THERMOMETER]);
+    usb_talk_sub(PREFIX_BASE "/hygrometer/-/relative-humidity/get", sensor_last_get, &config.sensor[CONFIG_SENSOR_HYGROMETER]);
+    usb_talk_sub(PREFIX_BASE "/lux-meter/-/illuminance/get", sensor_last_get, &config.sensor[CONFIG_SENSOR_LUX_METER]);
+    usb_talk_sub(PREFIX_BASE "/barometer/-/pressure/get", sensor_last_get, &config.sensor[CONFIG_SENSOR_BAROMETER]);
+    usb_talk_sub(PREFIX_BASE "/co2-meter/-/concentration/get", sensor_last_get, &config.sensor[CONFIG_SENSOR_CO2_METER]);
+    usb_talk_sub(PREFIX_BASE "/thermometer/+/temperature/get", sensor_last_get_channel, &config.sensor[CONFIG_SENSOR_THERMOMETER]);
+    usb_talk_sub(PREFIX_BASE "/hygrometer/+/relative-humidity/get", sensor_last_get_channel, &config.sensor[CONFIG_SENSOR_HYGROMETER]);
+    usb_talk_sub(PREFIX_BASE "/lux-meter/+/illuminance/get", sensor_last_get_channel, &config.sensor[CONFIG_SENSOR_LUX_METER]);
+    usb_talk_sub(PREFIX_BASE "/barometer/+/pressure/get", sensor_last_get_channel, &config.sensor[CONFIG_SENSOR_BAROMETER]);
+    usb_talk_sub(PREFIX_BASE "/sensors/-/all/get", sensor_last_get_all, NULL);
+    usb_talk_sub(PREFIX_BASE "/stats/-/cpu/get", stats_cpu_get, NULL);
+    usb_talk_sub(PREFIX_BASE "/stats/-/cpu/reset", stats_cpu_reset, NULL);
+    usb_talk_sub(PREFIX_BASE "/stats/-/usb/get", stats_usb_get, NULL);
+    usb_talk_sub(PREFIX_BASE "/stats/-/usb/reset", stats_usb_reset, NULL);
+    usb_talk_sub(PREFIX_BASE "/stats/-/boot/get", stats_boot_get, NULL);
+    usb_talk_sub(PREFIX_BASE "/stats/-/ram/get", stats_ram_get, NULL);
+    usb_talk_sub(PREFIX_BASE "/state/-/snapshot/get", state_snapshot_get, NULL);
+
+    profiler_stop(&boot.phases[BOOT_PHASE_CORE]);
+
+    profiler_start(&boot.phases[BOOT_PHASE_LIGHT]);
+
+    bc_led_init(&led, BC_GPIO_LED, false, false);
+
+    bc_module_power_init();
+
+    led_strip_lut_init();
+
+    _led_strip_scene_restore();
+
+    bc_led_strip_init(&led_strip, ws2812b_get_driver(), &led_strip_buffer);
+    ws2812b_set_pixel_handler(_led_strip_pixel);
+
+    // The pixels are always kept, the light only decides whether they are sent
+    ws2812b_set_blank(!light);
+    bc_led_set_mode(&led, light ? BC_LED_MODE_ON : BC_LED_MODE_OFF);
+    led_state = light;
+
+    static bc_button_t button;
+    bc_button_init(&button, BC_GPIO_BUTTON, BC_GPIO_PULL_DOWN, false);
+    bc_button_set_event_handler(&button, button_event_handler, NULL);
+
+    profiler_stop(&boot.phases[BOOT_PHASE_LIGHT]);
 
     memset(&lcd.base, 0xff, sizeof(lcd.base));
     memset(&lcd.remote, 0xff, sizeof(lcd.remote));
+
+    // The rest is brought up one phase per scheduler pass so USB and the light are served in between
+    boot.phase = BOOT_PHASE_RADIO;
+}
+
+static void _boot_task(void *param)
+{
+    (void) param;
+
+    if (boot.phase >= BOOT_PHASE_COUNT)
+    {
+        return;
+    }
+
+    profiler_start(&boot.phases[boot.phase]);
+
+    switch (boot.phase)
+    {
+        case BOOT_PHASE_RADIO:
+        {
+            bc_radio_init();
+            bc_radio_set_event_handler(radio_event_handler, NULL);
+            bc_radio_listen();
+            break;
+        }
+        case BOOT_PHASE_LCD:
+        {
+            bc_module_lcd_init(&_bc_module_lcd_framebuffer);
+            bc_module_lcd_clear();
+            bc_module_lcd_update();
+            break;
+        }
+        case BOOT_PHASE_TAGS:
+        {
+            bc_tag_temperature_init(&temperature_tag[0], BC_I2C_I2C0, BC_TAG_TEMPERATURE_I2C_ADDRESS_DEFAULT);
+            temperature_sensor[0].i2c = (BC_I2C_I2C0 << 7) | BC_TAG_TEMPERATURE_I2C_ADDRESS_DEFAULT;
+            bc_tag_temperature_set_event_handler(&temperature_tag[0], temperature_tag_event_handler, &temperature_sensor[0]);
+
+            bc_tag_temperature_init(&temperature_tag[1], BC_I2C_I2C0, BC_TAG_TEMPERATURE_I2C_ADDRESS_ALTERNATE);
+            temperature_sensor[1].i2c = (BC_I2C_I2C0 << 7) | BC_TAG_TEMPERATURE_I2C_ADDRESS_ALTERNATE;
+            bc_tag_temperature_set_event_handler(&temperature_tag[1], temperature_tag_event_handler, &temperature_sensor[1]);
+
+            bc_tag_temperature_init(&temperature_tag[2], BC_I2C_I2C1, BC_TAG_TEMPERATURE_I2C_ADDRESS_DEFAULT);
+            temperature_sensor[2].i2c = (BC_I2C_I2C1 << 7) | BC_TAG_TEMPERATURE_I2C_ADDRESS_DEFAULT;
+            bc_tag_temperature_set_event_handler(&temperature_tag[2], temperature_tag_event_handler, &temperature_sensor[2]);
+
+            bc_tag_temperature_init(&temperature_tag[3], BC_I2C_I2C1, BC_TAG_TEMPERATURE_I2C_ADDRESS_ALTERNATE);
+            temperature_sensor[3].i2c = (BC_I2C_I2C1 << 7) | BC_TAG_TEMPERATURE_I2C_ADDRESS_ALTERNATE;
+            bc_tag_temperature_set_event_handler(&temperature_tag[3], temperature_tag_event_handler, &temperature_sensor[3]);
+
+            //----------------------------
+
+            bc_tag_humidity_init(&humidity_tag[0], BC_TAG_HUMIDITY_REVISION_R2, BC_I2C_I2C0, BC_TAG_HUMIDITY_I2C_ADDRESS_DEFAULT);
+            humidity_sensor[0].i2c = (BC_I2C_I2C0 << 7) | 0x40;
+            bc_tag_humidity_set_event_handler(&humidity_tag[0], humidity_tag_event_handler, &humidity_sensor[0]);
+
+            bc_tag_humidity_init(&humidity_tag[1], BC_TAG_HUMIDITY_REVISION_R2, BC_I2C_I2C0, BC_TAG_HUMIDITY_I2C_ADDRESS_ALTERNATE);
+            humidity_sensor[1].i2c = (BC_I2C_I2C0 << 7) | 0x41;
+            bc_tag_humidity_set_event_handler(&humidity_tag[1], humidity_tag_event_handler, &humidity_sensor[1]);
+
+            bc_tag_humidity_init(&humidity_tag[2], BC_TAG_HUMIDITY_REVISION_R1, BC_I2C_I2C0, BC_TAG_HUMIDITY_I2C_ADDRESS_DEFAULT);
+            humidity_sensor[2].i2c = (BC_I2C_I2C0 << 7) | 0x5f;
+            bc_tag_humidity_set_event_handler(&humidity_tag[2], humidity_tag_event_handler, &humidity_sensor[2]);
+
+            bc_tag_humidity_init(&humidity_tag[3], BC_TAG_HUMIDITY_REVISION_R2, BC_I2C_I2C1, BC_TAG_HUMIDITY_I2C_ADDRESS_DEFAULT);
+            humidity_sensor[3].i2c = (BC_I2C_I2C1 << 7) | 0x40;
+            bc_tag_humidity_set_event_handler(&humidity_tag[3], humidity_tag_event_handler, &humidity_sensor[3]);
+
+            bc_tag_humidity_init(&humidity_tag[4], BC_TAG_HUMIDITY_REVISION_R2, BC_I2C_I2C1, BC_TAG_HUMIDITY_I2C_ADDRESS_ALTERNATE);
+            humidity_sensor[4].i2c = (BC_I2C_I2C1 << 7) | 0x41;
+            bc_tag_humidity_set_event_handler(&humidity_tag[4], humidity_tag_event_handler, &humidity_sensor[4]);
+
+            bc_tag_humidity_init(&humidity_tag[5], BC_TAG_HUMIDITY_REVISION_R1, BC_I2C_I2C1, BC_TAG_HUMIDITY_I2C_ADDRESS_DEFAULT);
+            humidity_sensor[5].i2c = (BC_I2C_I2C1 << 7) | 0x5f;
+            bc_tag_humidity_set_event_handler(&humidity_tag[5], humidity_tag_event_handler, &humidity_sensor[5]);
+
+            //----------------------------
+
+            bc_tag_lux_meter_init(&lux_meter[0], BC_I2C_I2C0, BC_TAG_LUX_METER_I2C_ADDRESS_DEFAULT);
+            lux_meter_sensor[0].i2c = (BC_I2C_I2C0 << 7) | BC_TAG_LUX_METER_I2C_ADDRESS_DEFAULT;
+            bc_tag_lux_meter_set_event_handler(&lux_meter[0], lux_meter_event_handler, &lux_meter_sensor[0]);
+
+            bc_tag_lux_meter_init(&lux_meter[1], BC_I2C_I2C0, BC_TAG_LUX_METER_I2C_ADDRESS_ALTERNATE);
+            lux_meter_sensor[1].i2c = (BC_I2C_I2C0 << 7) | BC_TAG_LUX_METER_I2C_ADDRESS_ALTERNATE;
+            bc_tag_lux_meter_set_event_handler(&lux_meter[1], lux_meter_event_handler, &lux_meter_sensor[1]);
+
+            bc_tag_lux_meter_init(&lux_meter[2], BC_I2C_I2C1, BC_TAG_LUX_METER_I2C_ADDRESS_DEFAULT);
+            lux_meter_sensor[2].i2c = (BC_I2C_I2C1 << 7) | BC_TAG_LUX_METER_I2C_ADDRESS_DEFAULT;
+            bc_tag_lux_meter_set_event_handler(&lux_meter[2], lux_meter_event_handler, &lux_meter_sensor[2]);
+
+            bc_tag_lux_meter_init(&lux_meter[3], BC_I2C_I2C1, BC_TAG_LUX_METER_I2C_ADDRESS_ALTERNATE);
+            lux_meter_sensor[3].i2c = (BC_I2C_I2C1 << 7) | BC_TAG_LUX_METER_I2C_ADDRESS_ALTERNATE;
+            bc_tag_lux_meter_set_event_handler(&lux_meter[3], lux_meter_event_handler, &lux_meter_sensor[3]);
+
+            //----------------------------
+
+            bc_tag_barometer_init(&barometer_tag[0], BC_I2C_I2C0);
+            barometer_sensor[0].i2c = (BC_I2C_I2C0 << 7) | 0x60;
+            bc_tag_barometer_set_event_handler(&barometer_tag[0], barometer_tag_event_handler, &barometer_sensor[0]);
+
+            bc_tag_barometer_init(&barometer_tag[1], BC_I2C_I2C1);
+            barometer_sensor[1].i2c = (BC_I2C_I2C1 << 7) | 0x60;
+            bc_tag_barometer_set_event_handler(&barometer_tag[1], barometer_tag_event_handler, &barometer_sensor[1]);
+            break;
+        }
+        case BOOT_PHASE_MODULES:
+        {
+            bc_module_co2_init();
+            bc_module_co2_set_event_handler(co2_event_handler, &co2_stats);
+
+            bc_module_encoder_init();
+            bc_module_encoder_set_event_handler(encoder_event_handler, NULL);
+
+            //----------------------------
+
+            bc_module_relay_init(&relay_0_0, BC_MODULE_RELAY_I2C_ADDRESS_DEFAULT);
+            bc_module_relay_init(&relay_0_1, BC_MODULE_RELAY_I2C_ADDRESS_ALTERNATE);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+
+    profiler_stop(&boot.phases[boot.phase]);
+
+    if (++boot.phase < BOOT_PHASE_COUNT)
+    {
+        bc_scheduler_plan_current_now();
+
+        return;
+    }
+
+    boot.ready_tick = bc_tick_get();
+
+    _config_apply();
+
+    stats_boot_get(NULL, NULL);
+}
+
+static bool _boot_is_ready(boot_phase_t phase)
+{
+    return boot.phase > phase;
 }
 
 void application_task(void)
 {
-    if (bc_led_strip_write(&led_strip))
+    profiler_start(profilers.application);
+
+    profiler_start(profilers.led_strip);
+    if (reconfig.state != LED_STRIP_RECONFIG_IDLE)
     {
+        // The strip belongs to the reconfiguration until it is done
+        bc_scheduler_plan_current_relative(50);
+    }
+    else if (_led_strip_write())
+    {
+        ram_buffer_use(ram_stats.pixels, led_strip_count * led_strip_buffer.type);
+
+        if (stream.pending)
+        {
+            stream.pending = false;
+            stream.shown++;
+        }
+
         bc_scheduler_plan_current_relative(50);
     }
     else
     {
         bc_scheduler_plan_current_now();
     }
+    profiler_stop(profilers.led_strip);
 
     bc_tick_t now = bc_tick_get();
-    if (lcd.next_update < now)
+    if (_boot_is_ready(BOOT_PHASE_LCD) && (lcd.next_update < now))
     {
-        if (!lcd.mqtt && (lcd.cnt++ > 2))
+        profiler_start(profilers.lcd);
+
+        if (!lcd.mqtt && (lcd.next_page <= now))
         {
             char str[32];
             int w;
@@ -316,7 +745,7 @@ void application_task(void)
 
             bc_module_lcd_draw_string(w, 110, pages[lcd.page].unit1);
 
-            lcd.cnt = 0;
+            lcd.next_page = now + config.lcd_page_interval;
             if (++lcd.page == (sizeof(pages) / sizeof(pages[0])))
             {
                 lcd.page = 0;
@@ -325,7 +754,11 @@ void application_task(void)
 
         bc_module_lcd_update();
         lcd.next_update = now + 500;
+
+        profiler_stop(profilers.lcd);
     }
+
+    profiler_stop(profilers.application);
 }
 
 static void button_event_handler(bc_button_t *self, bc_button_event_t event, void *event_param)
@@ -335,10 +768,12 @@ static void button_event_handler(bc_button_t *self, bc_button_event_t event, voi
 
     if (event == BC_BUTTON_EVENT_PRESS)
     {
+        profiler_start(profilers.button);
         static uint16_t event_count = 0;
         usb_talk_publish_push_button(PREFIX_BASE, &event_count);
         event_count++;
         _light_set(!light);
+        profiler_stop(profilers.button);
     }
     else if (event == BC_BUTTON_EVENT_HOLD)
     {
@@ -364,75 +799,247 @@ static void radio_event_handler(bc_radio_event_t event, void *event_param)
 
 void bc_radio_on_push_button(uint32_t *peer_device_address, uint16_t *event_count)
 {
-    (void) peer_device_address;
+    profiler_start(profilers.radio);
+
+    _remote_seen(peer_device_address);
 
     _light_set(!light);
 
     usb_talk_publish_push_button(PREFIX_REMOTE, event_count);
+
+    profiler_stop(profilers.radio);
 }
 
 void bc_radio_on_thermometer(uint32_t *peer_device_address, uint8_t *i2c, float *temperature)
 {
-    (void) peer_device_address;
+    profiler_start(profilers.radio);
 
-    usb_talk_publish_thermometer(PREFIX_REMOTE, i2c, temperature);
+    _remote_seen(peer_device_address);
+
+    sensor_stats_t stats;
+    _sensor_stats_set_single(&stats, *temperature);
+
+    usb_talk_publish_thermometer(PREFIX_REMOTE, i2c, &stats);
     lcd.remote.temperature = *temperature;
+
+    profiler_stop(profilers.radio);
 }
 
 
 void bc_radio_on_humidity(uint32_t *peer_device_address, uint8_t *i2c, float *percentage)
 {
-    (void) peer_device_address;
+    profiler_start(profilers.radio);
+
+    _remote_seen(peer_device_address);
 
-    usb_talk_publish_humidity_sensor(PREFIX_REMOTE, i2c, percentage);
+    sensor_stats_t stats;
+    _sensor_stats_set_single(&stats, *percentage);
+
+    usb_talk_publish_humidity_sensor(PREFIX_REMOTE, i2c, &stats);
     lcd.remote.humidity = *percentage;
+
+    profiler_stop(profilers.radio);
 }
 
 void bc_radio_on_lux_meter(uint32_t *peer_device_address, uint8_t *i2c, float *illuminance)
 {
-    (void) peer_device_address;
+    profiler_start(profilers.radio);
+
+    _remote_seen(peer_device_address);
+
+    sensor_stats_t stats;
+    _sensor_stats_set_single(&stats, *illuminance);
 
-    usb_talk_publish_lux_meter(PREFIX_REMOTE, i2c, illuminance);
+    usb_talk_publish_lux_meter(PREFIX_REMOTE, i2c, &stats);
     lcd.remote.illuminance = *illuminance;
+
+    profiler_stop(profilers.radio);
 }
 
 void bc_radio_on_barometer(uint32_t *peer_device_address, uint8_t *i2c, float *pressure, float *altitude)
 {
-    (void) peer_device_address;
+    profiler_start(profilers.radio);
+
+    _remote_seen(peer_device_address);
 
-    usb_talk_publish_barometer(PREFIX_REMOTE, i2c, pressure, altitude);
+    sensor_stats_t pressure_stats;
+    sensor_stats_t altitude_stats;
+    _sensor_stats_set_single(&pressure_stats, *pressure);
+    _sensor_stats_set_single(&altitude_stats, *altitude);
+
+    usb_talk_publish_barometer(PREFIX_REMOTE, i2c, &pressure_stats, &altitude_stats);
     lcd.remote.pressure = *pressure / 100;
     lcd.remote.altitude = *altitude;
+
+    profiler_stop(profilers.radio);
 }
 
 void bc_radio_on_co2(uint32_t *peer_device_address, float *concentration)
 {
-    (void) peer_device_address;
+    profiler_start(profilers.radio);
 
-    usb_talk_publish_co2_concentation(PREFIX_REMOTE, concentration);
+    _remote_seen(peer_device_address);
+
+    sensor_stats_t stats;
+    _sensor_stats_set_single(&stats, *concentration);
+
+    usb_talk_publish_co2_concentation(PREFIX_REMOTE, &stats);
     lcd.remote.co2_concentation = *concentration;
+
+    profiler_stop(profilers.radio);
 }
 
 void bc_radio_on_buffer(uint32_t *peer_device_address, uint8_t *buffer, size_t *length)
 {
-    (void) peer_device_address;
+    profiler_start(profilers.radio);
+
+    _remote_seen(peer_device_address);
+
+    _radio_buffer_process(buffer, *length);
+
+    profiler_stop(profilers.radio);
+}
+
+static void _remote_seen(uint32_t *peer_device_address)
+{
+    remote_t *slot = &remotes[0];
+
+    // Refresh a known remote, otherwise take a free slot or evict the longest silent one
+    for (size_t i = 0; i < REMOTE_COUNT; i++)
+    {
+        if (remotes[i].address == *peer_device_address)
+        {
+            slot = &remotes[i];
+            break;
+        }
+
+        if ((slot->address != 0) && ((remotes[i].address == 0) || (remotes[i].tick < slot->tick)))
+        {
+            slot = &remotes[i];
+        }
+    }
+
+    slot->address = *peer_device_address;
+    slot->tick = bc_tick_get();
+}
+
+static void _radio_buffer_process(uint8_t *buffer, size_t length)
+{
+    radio_schema_record_t record;
+    size_t offset = 1;
 
-    if (*length < 1 + sizeof(int))
+    if (length < 1)
     {
         return;
     }
 
-    if (buffer[0] == 0x00)
+    // One packet may carry several records, remotes with older firmware still send one legacy buffer
+    if (buffer[0] == RADIO_SCHEMA_VERSION)
+    {
+        while (radio_schema_next(buffer, length, &offset, &record))
+        {
+            radio_record_handlers[record.type](&record);
+        }
+    }
+    else if (_radio_buffer_legacy(buffer, length, &record))
+    {
+        radio_record_handlers[record.type](&record);
+    }
+}
+
+static bool _radio_buffer_legacy(uint8_t *buffer, size_t length, radio_schema_record_t *record)
+{
+    memset(record, 0, sizeof(*record));
+
+    record->type = buffer[0];
+
+    switch (buffer[0])
     {
-        int increment;
-        memcpy(&increment, &buffer[1], sizeof(increment));
+        case RADIO_BUFFER_ENCODER:
+        {
+            if (length < 1 + sizeof(int))
+            {
+                return false;
+            }
 
-        usb_talk_publish_encoder(PREFIX_REMOTE, &increment);
+            memcpy(&record->value, &buffer[1], sizeof(int));
+
+            return true;
+        }
+        case RADIO_BUFFER_THERMOMETER:
+        case RADIO_BUFFER_HUMIDITY:
+        case RADIO_BUFFER_LUX_METER:
+        case RADIO_BUFFER_CO2:
+        {
+            if (length < 2 + RADIO_BUFFER_STATS_SIZE)
+            {
+                return false;
+            }
+
+            record->i2c = buffer[1];
+            _radio_buffer_get_stats(&buffer[2], &record->stats[0]);
+
+            return true;
+        }
+        case RADIO_BUFFER_BAROMETER:
+        {
+            if (length < 2 + 2 * RADIO_BUFFER_STATS_SIZE)
+            {
+                return false;
+            }
+
+            record->i2c = buffer[1];
+            _radio_buffer_get_stats(&buffer[2], &record->stats[0]);
+            _radio_buffer_get_stats(&buffer[2 + RADIO_BUFFER_STATS_SIZE], &record->stats[1]);
+
+            return true;
+        }
+        default:
+        {
+            return false;
+        }
     }
 }
 
+static void _radio_record_encoder(radio_schema_record_t *record)
+{
+    usb_talk_publish_encoder(PREFIX_REMOTE, &record->value);
+}
+
+static void _radio_record_thermometer(radio_schema_record_t *record)
+{
+    usb_talk_publish_thermometer(PREFIX_REMOTE, &record->i2c, &record->stats[0]);
+    lcd.remote.temperature = sensor_stats_get_mean(&record->stats[0]);
+}
+
+static void _radio_record_humidity(radio_schema_record_t *record)
+{
+    usb_talk_publish_humidity_sensor(PREFIX_REMOTE, &record->i2c, &record->stats[0]);
+    lcd.remote.humidity = sensor_stats_get_mean(&record->stats[0]);
+}
+
+static void _radio_record_lux_meter(radio_schema_record_t *record)
+{
+    usb_talk_publish_lux_meter(PREFIX_REMOTE, &record->i2c, &record->stats[0]);
+    lcd.remote.illuminance = sensor_stats_get_mean(&record->stats[0]);
+}
+
+static void _radio_record_barometer(radio_schema_record_t *record)
+{
+    usb_talk_publish_barometer(PREFIX_REMOTE, &record->i2c, &record->stats[0], &record->stats[1]);
+    lcd.remote.pressure = sensor_stats_get_mean(&record->stats[0]) / 100;
+    lcd.remote.altitude = sensor_stats_get_mean(&record->stats[1]);
+}
+
+static void _radio_record_co2(radio_schema_record_t *record)
+{
+    usb_talk_publish_co2_concentation(PREFIX_REMOTE, &record->stats[0]);
+    lcd.remote.co2_concentation = sensor_stats_get_mean(&record->stats[0]);
+}
+
 static void temperature_tag_event_handler(bc_tag_temperature_t *self, bc_tag_temperature_event_t event, void *event_param)
 {
+    sensor_t *sensor = (sensor_t *) event_param;
     float value;
 
     if (event != BC_TAG_TEMPERATURE_EVENT_UPDATE)
@@ -440,15 +1047,24 @@ static void temperature_tag_event_handler(bc_tag_temperature_t *self, bc_tag_tem
         return;
     }
 
-    if (bc_tag_temperature_get_temperature_celsius(self, &value))
+    if (bc_tag_temperature_get_temperature_celsius(self, &value) && sensor_filter_add(&sensor->filter, value, &value))
     {
-        usb_talk_publish_thermometer(PREFIX_BASE, (uint8_t *)event_param, &value);
+        profiler_start(profilers.sensor[CONFIG_SENSOR_THERMOMETER]);
+
+        if (sensor_stats_add(&sensor->stats, value))
+        {
+            usb_talk_publish_thermometer(PREFIX_BASE, &sensor->i2c, &sensor->stats);
+            sensor_stats_reset(&sensor->stats);
+        }
         lcd.base.temperature = value;
+
+        profiler_stop(profilers.sensor[CONFIG_SENSOR_THERMOMETER]);
     }
 }
 
 static void humidity_tag_event_handler(bc_tag_humidity_t *self, bc_tag_humidity_event_t event, void *event_param)
 {
+    sensor_t *sensor = (sensor_t *) event_param;
     float value;
 
     if (event != BC_TAG_HUMIDITY_EVENT_UPDATE)
@@ -456,15 +1072,24 @@ static void humidity_tag_event_handler(bc_tag_humidity_t *self, bc_tag_humidity_
         return;
     }
 
-    if (bc_tag_humidity_get_humidity_percentage(self, &value))
+    if (bc_tag_humidity_get_humidity_percentage(self, &value) && sensor_filter_add(&sensor->filter, value, &value))
     {
-        usb_talk_publish_humidity_sensor(PREFIX_BASE, (uint8_t *)event_param, &value);
+        profiler_start(profilers.sensor[CONFIG_SENSOR_HYGROMETER]);
+
+        if (sensor_stats_add(&sensor->stats, value))
+        {
+            usb_talk_publish_humidity_sensor(PREFIX_BASE, &sensor->i2c, &sensor->stats);
+            sensor_stats_reset(&sensor->stats);
+        }
         lcd.base.humidity = value;
+
+        profiler_stop(profilers.sensor[CONFIG_SENSOR_HYGROMETER]);
     }
 }
 
 static void lux_meter_event_handler(bc_tag_lux_meter_t *self, bc_tag_lux_meter_event_t event, void *event_param)
 {
+    sensor_t *sensor = (sensor_t *) event_param;
     float value;
 
     if (event != BC_TAG_LUX_METER_EVENT_UPDATE)
@@ -472,15 +1097,24 @@ static void lux_meter_event_handler(bc_tag_lux_meter_t *self, bc_tag_lux_meter_e
         return;
     }
 
-    if (bc_tag_lux_meter_get_luminosity_lux(self, &value))
+    if (bc_tag_lux_meter_get_luminosity_lux(self, &value) && sensor_filter_add(&sensor->filter, value, &value))
     {
-        usb_talk_publish_lux_meter(PREFIX_BASE, (uint8_t *)event_param, &value);
+        profiler_start(profilers.sensor[CONFIG_SENSOR_LUX_METER]);
+
+        if (sensor_stats_add(&sensor->stats, value))
+        {
+            usb_talk_publish_lux_meter(PREFIX_BASE, &sensor->i2c, &sensor->stats);
+            sensor_stats_reset(&sensor->stats);
+        }
         lcd.base.illuminance = value;
+
+        profiler_stop(profilers.sensor[CONFIG_SENSOR_LUX_METER]);
     }
 }
 
 static void barometer_tag_event_handler(bc_tag_barometer_t *self, bc_tag_barometer_event_t event, void *event_param)
 {
+    barometer_t *sensor = (barometer_t *) event_param;
     float pascal;
     float meter;
 
@@ -499,23 +1133,48 @@ static void barometer_tag_event_handler(bc_tag_barometer_t *self, bc_tag_baromet
         return;
     }
 
-    usb_talk_publish_barometer(PREFIX_BASE, (uint8_t *)event_param, &pascal, &meter);
-    lcd.base.pressure = pascal / 100;
-    lcd.base.altitude = meter;
+    profiler_start(profilers.sensor[CONFIG_SENSOR_BAROMETER]);
 
-}
+    if (sensor_filter_add(&sensor->altitude_filter, meter, &meter))
+    {
+        sensor_stats_add(&sensor->altitude, meter);
+        lcd.base.altitude = meter;
+    }
+
+    if (sensor_filter_add(&sensor->pressure_filter, pascal, &pascal))
+    {
+        if (sensor_stats_add(&sensor->pressure, pascal))
+        {
+            usb_talk_publish_barometer(PREFIX_BASE, &sensor->i2c, &sensor->pressure, &sensor->altitude);
+            sensor_stats_reset(&sensor->pressure);
+            sensor_stats_reset(&sensor->altitude);
+        }
+        lcd.base.pressure = pascal / 100;
+    }
+
+    profiler_stop(profilers.sensor[CONFIG_SENSOR_BAROMETER]);
+
+}
 
 void co2_event_handler(bc_module_co2_event_t event, void *event_param)
 {
-    (void) event_param;
+    sensor_stats_t *stats = (sensor_stats_t *) event_param;
     float value;
 
     if (event == BC_MODULE_CO2_EVENT_UPDATE)
     {
-        if (bc_module_co2_get_concentration(&value))
+        if (bc_module_co2_get_concentration(&value) && sensor_filter_add(&co2_filter, value, &value))
         {
-            usb_talk_publish_co2_concentation(PREFIX_BASE, &value);
+            profiler_start(profilers.sensor[CONFIG_SENSOR_CO2_METER]);
+
+            if (sensor_stats_add(stats, value))
+            {
+                usb_talk_publish_co2_concentation(PREFIX_BASE, stats);
+                sensor_stats_reset(stats);
+            }
             lcd.base.co2_concentation = value;
+
+            profiler_stop(profilers.sensor[CONFIG_SENSOR_CO2_METER]);
         }
     }
 }
@@ -535,7 +1194,7 @@ static void set_default_pixels(void)
 {
     pixels_length = led_strip_buffer.type * led_strip_count;
 
-    memset(pixels, 0x00, sizeof(pixels));
+    memset(pixels, 0x00, sizeof(pixels_buffers[0]));
 
     int tmp = 0;
 
@@ -545,12 +1204,33 @@ static void set_default_pixels(void)
     }
 }
 
+static void _sensor_stats_set_single(sensor_stats_t *stats, float value)
+{
+    stats->min = value;
+    stats->max = value;
+    stats->sum = value;
+    stats->count = 1;
+}
+
+static void _radio_buffer_get_stats(uint8_t *buffer, sensor_stats_t *stats)
+{
+    float mean;
+
+    memcpy(&stats->min, &buffer[0], sizeof(float));
+    memcpy(&stats->max, &buffer[4], sizeof(float));
+    memcpy(&mean, &buffer[8], sizeof(float));
+    memcpy(&stats->count, &buffer[12], sizeof(uint16_t));
+
+    stats->sum = mean * stats->count;
+}
+
 static void led_state_set(usb_talk_payload_t *payload, void *param)
 {
     (void) param;
 
     if (!usb_talk_payload_get_bool(payload, &led_state))
     {
+        usb_talk_nack("payload");
         return;
     }
 
@@ -571,16 +1251,9 @@ static void _light_set(bool state)
 {
     light = state;
 
-    bc_led_set_mode(&led, light ? BC_LED_MODE_ON : BC_LED_MODE_OFF);
+    ws2812b_set_blank(!light);
 
-    if (light)
-    {
-        bc_led_strip_set_rgbw_framebuffer(&led_strip, pixels, pixels_length);
-    }
-    else
-    {
-        bc_led_strip_fill(&led_strip, 0x00000000);
-    }
+    bc_led_set_mode(&led, light ? BC_LED_MODE_ON : BC_LED_MODE_OFF);
 
     bc_scheduler_plan_now(APPLICATION_TASK_ID);
 
@@ -597,6 +1270,7 @@ static void light_state_set(usb_talk_payload_t *payload, void *param)
 
     if (!usb_talk_payload_get_bool(payload, &new_state))
     {
+        usb_talk_nack("payload");
         return;
     }
 
@@ -618,6 +1292,7 @@ static void relay_state_set(usb_talk_payload_t *payload, void *param)
 
     if (!usb_talk_payload_get_bool(payload, &state))
     {
+        usb_talk_nack("payload");
         return;
     }
 
@@ -644,8 +1319,15 @@ static void module_relay_state_set(usb_talk_payload_t *payload, void *param)
 
     bool state;
 
+    if (!_boot_is_ready(BOOT_PHASE_MODULES))
+    {
+        usb_talk_nack("not-ready");
+        return;
+    }
+
     if (!usb_talk_payload_get_bool(payload, &state))
     {
+        usb_talk_nack("payload");
         return;
     }
 
@@ -662,6 +1344,12 @@ static void module_relay_state_get(usb_talk_payload_t *payload, void *param)
     (void) payload;
     bc_module_relay_t *relay = (bc_module_relay_t *)param;
 
+    if (!_boot_is_ready(BOOT_PHASE_MODULES))
+    {
+        usb_talk_nack("not-ready");
+        return;
+    }
+
     bc_module_relay_state_t state = bc_module_relay_get_state(relay);
 
     uint8_t number = (&relay_0_0 == relay) ? 0 : 1;
@@ -669,70 +1357,143 @@ static void module_relay_state_get(usb_talk_payload_t *payload, void *param)
     usb_talk_publish_module_relay(PREFIX_BASE, &number, &state);
 }
 
-static void led_strip_framebuffer_set(usb_talk_payload_t *payload, void *param)
+static bool led_strip_framebuffer_set(usb_talk_data_t *data, void *param)
 {
     (void) param;
 
     size_t length = led_strip_count * led_strip_buffer.type;
 
-    if (usb_talk_payload_get_data(payload, pixels, &length))
+    if (data->event == USB_TALK_DATA_EVENT_CHUNK)
     {
-        pixels_length = length;
-
-        if (light)
+        if (data->offset + data->length > length)
         {
-            bc_led_strip_set_rgbw_framebuffer(&led_strip, pixels, pixels_length);
+            _led_strip_upload_end(false);
+
+            return false;
         }
 
-        bc_scheduler_plan_now(APPLICATION_TASK_ID);
+        memcpy(_led_strip_upload_begin() + data->offset, data->buffer, data->length);
+
+        return true;
+    }
+
+    if (data->event == USB_TALK_DATA_EVENT_DONE)
+    {
+        pixels_length = data->offset;
+
+        _led_strip_upload_end(true);
 
         usb_talk_send_string("[\"" PREFIX_BASE "/led-strip/-/framebuffer/set/ok\", null]\n");
+
+        return true;
     }
 
+    _led_strip_upload_end(false);
+
+    return false;
 }
 
 static void led_strip_config_set(usb_talk_payload_t *payload, void *param)
 {
     (void) param;
 
-    int type;
-    int count;
+    led_strip_config_payload_t request;
 
-    if (!usb_talk_payload_get_key_enum(payload, "type", &type, "rgb", "rgbw"))
+    if (!usb_talk_payload_decode(payload, &led_strip_config_schema, &request, NULL))
     {
+        usb_talk_nack("payload");
         return;
     }
 
-    if (!usb_talk_payload_get_key_int(payload, "count", &count))
+    // A request arriving during a reconfiguration is applied once the running one is shown
+    reconfig.request = request;
+    reconfig.pending = true;
+
+    if (reconfig.state == LED_STRIP_RECONFIG_IDLE)
     {
-        return;
+        bc_led_strip_effect_stop(&led_strip);
+
+        reconfig.state = LED_STRIP_RECONFIG_BLANK;
+
+        bc_scheduler_plan_now(reconfig.task_id);
     }
+}
+
+static void _led_strip_reconfig_task(void *param)
+{
+    (void) param;
 
-    if ((count > MAX_PIXELS) || (count < 1))
+    switch (reconfig.state)
     {
-        return;
-    }
+        case LED_STRIP_RECONFIG_BLANK:
+        {
+            // The driver encodes from the pixels while it sends, so they are not touched during a transfer
+            if (!bc_led_strip_is_ready(&led_strip))
+            {
+                bc_scheduler_plan_current_now();
+                return;
+            }
+
+            // A blank frame goes out whatever the pixels and segments hold
+            ws2812b_set_blank(true);
+            bc_led_strip_write(&led_strip);
 
-    bc_led_strip_effect_stop(&led_strip);
+            reconfig.state = LED_STRIP_RECONFIG_WAIT;
+            bc_scheduler_plan_current_now();
+            return;
+        }
+        case LED_STRIP_RECONFIG_WAIT:
+        {
+            // The black frame has to reach the strip in the old layout before the layout changes
+            if (!bc_led_strip_is_ready(&led_strip))
+            {
+                bc_scheduler_plan_current_now();
+                return;
+            }
 
-    bc_led_strip_fill(&led_strip, 0x00000000);
+            led_strip_count = reconfig.request.count;
+            led_strip_buffer.count = led_strip_count;
+            led_strip_buffer.type = reconfig.request.type == 0 ? BC_LED_STRIP_TYPE_RGB : BC_LED_STRIP_TYPE_RGBW;
+            reconfig.pending = false;
 
-    while(!bc_led_strip_write(&led_strip)) { }
-    while(!bc_led_strip_write(&led_strip)) { }
+            // A frame waiting for the old layout is not shown in the new one
+            upload.ready = false;
 
-    led_strip_count = count;
-    led_strip_buffer.type = type == 0 ? BC_LED_STRIP_TYPE_RGB : BC_LED_STRIP_TYPE_RGBW;
+            set_default_pixels();
+            ws2812b_set_blank(!light);
 
-    set_default_pixels();
-    if (light)
-    {
-        bc_led_strip_set_rgbw_framebuffer(&led_strip, pixels, pixels_length);
-    }
+            reconfig.state = LED_STRIP_RECONFIG_SHOW;
+            bc_scheduler_plan_current_now();
+            return;
+        }
+        case LED_STRIP_RECONFIG_SHOW:
+        {
+            if (!_led_strip_write())
+            {
+                bc_scheduler_plan_current_now();
+                return;
+            }
 
-    while(!bc_led_strip_write(&led_strip)) { }
+            usb_talk_publish_led_strip_config(PREFIX_BASE, led_strip_buffer.type == BC_LED_STRIP_TYPE_RGB ? "rgb" : "rgbw", &led_strip_count);
 
-    usb_talk_publish_led_strip_config(PREFIX_BASE, led_strip_buffer.type == BC_LED_STRIP_TYPE_RGB ? "rgb" : "rgbw", &led_strip_count);
+            if (reconfig.pending)
+            {
+                reconfig.state = LED_STRIP_RECONFIG_BLANK;
+                bc_scheduler_plan_current_now();
+            }
+            else
+            {
+                reconfig.state = LED_STRIP_RECONFIG_IDLE;
+            }
 
+            return;
+        }
+        case LED_STRIP_RECONFIG_IDLE:
+        default:
+        {
+            return;
+        }
+    }
 }
 
 static void led_strip_config_get(usb_talk_payload_t *payload, void *param)
@@ -744,73 +1505,1243 @@ static void led_strip_config_get(usb_talk_payload_t *payload, void *param)
 
 }
 
-static void lcd_text_set(usb_talk_payload_t *payload, void *param)
+static void led_strip_brightness_set(usb_talk_payload_t *payload, void *param)
+{
+    led_strip_brightness_payload_t request = { .brightness = led_strip_lut_get_brightness() };
+    uint32_t found;
+
+    led_strip_lut_get_gamma(request.gamma_channel);
+
+    if (!usb_talk_payload_decode(payload, &led_strip_brightness_schema, &request, &found) || (found == 0))
+    {
+        usb_talk_nack("payload");
+        return;
+    }
+
+    for (int channel = 0; channel < LED_STRIP_LUT_CHANNELS; channel++)
+    {
+        // A common gamma applies to the channels that were not given their own
+        if ((found & (1 << 1)) && !(found & (1 << (2 + channel))))
+        {
+            request.gamma_channel[channel] = request.gamma;
+        }
+
+        if (request.gamma_channel[channel] <= 0.f)
+        {
+            usb_talk_nack("invalid");
+            return;
+        }
+    }
+
+    led_strip_lut_set(request.brightness, request.gamma_channel);
+
+    // The lookup is applied to every pixel as it is sent, the next write already shows the new values
+    bc_scheduler_plan_now(APPLICATION_TASK_ID);
+
+    led_strip_brightness_get(payload, param);
+}
+
+static void led_strip_brightness_get(usb_talk_payload_t *payload, void *param)
 {
+    (void) payload;
     (void) param;
-    int x;
-    int y;
-    int font_size = 0;
-    char text[32];
-    size_t length = sizeof(text);
 
-    memset(text, 0, length);
-    if (!usb_talk_payload_get_key_int(payload, "x", &x))
+    int brightness = led_strip_lut_get_brightness();
+    float gamma[LED_STRIP_LUT_CHANNELS];
+
+    led_strip_lut_get_gamma(gamma);
+
+    usb_talk_publish_led_strip_brightness(PREFIX_BASE, &brightness, gamma);
+}
+
+static void led_strip_segment_config_set(usb_talk_payload_t *payload, void *param)
+{
+    led_strip_segment_t *segment = (led_strip_segment_t *) param;
+    led_strip_segment_config_payload_t request;
+
+    if (!usb_talk_payload_decode(payload, &led_strip_segment_config_schema, &request, NULL))
     {
+        usb_talk_nack("payload");
         return;
     }
-    if (!usb_talk_payload_get_key_int(payload, "y", &y))
+
+    if (request.offset + request.count > MAX_PIXELS)
     {
+        usb_talk_nack("invalid");
         return;
     }
-    if (!usb_talk_payload_get_key_string(payload, "text", text, &length))
+
+    segment->offset = request.offset;
+    segment->count = request.count;
+
+    bc_scheduler_plan_now(segments.task_id);
+    bc_scheduler_plan_now(APPLICATION_TASK_ID);
+
+    led_strip_segment_config_get(payload, param);
+}
+
+static void led_strip_segment_config_get(usb_talk_payload_t *payload, void *param)
+{
+    (void) payload;
+
+    led_strip_segment_t *segment = (led_strip_segment_t *) param;
+    int effect = segment->effect;
+
+    usb_talk_publish_led_strip_segment(PREFIX_BASE, &segment->id, &segment->offset, &segment->count, &segment->brightness,
+                                       led_strip_effect_enums[effect].name, &segment->wait);
+}
+
+static bool led_strip_segment_framebuffer_set(usb_talk_data_t *data, void *param)
+{
+    led_strip_segment_t *segment = (led_strip_segment_t *) param;
+    int count = segment->count;
+
+    if (segment->offset + count > led_strip_count)
+    {
+        count = segment->offset < led_strip_count ? led_strip_count - segment->offset : 0;
+    }
+
+    size_t length = count * led_strip_buffer.type;
+
+    if (data->event == USB_TALK_DATA_EVENT_CHUNK)
+    {
+        if (data->offset + data->length > length)
+        {
+            _led_strip_upload_end(false);
+
+            return false;
+        }
+
+        uint8_t *buffer = _led_strip_upload_begin() + segment->offset * led_strip_buffer.type;
+
+        memcpy(buffer + data->offset, data->buffer, data->length);
+
+        return true;
+    }
+
+    if (data->event == USB_TALK_DATA_EVENT_DONE)
+    {
+        _led_strip_upload_end(true);
+
+        usb_talk_publish_led_strip_segment_framebuffer(PREFIX_BASE, &segment->id);
+
+        return true;
+    }
+
+    _led_strip_upload_end(false);
+
+    return false;
+}
+
+static void led_strip_segment_brightness_set(usb_talk_payload_t *payload, void *param)
+{
+    led_strip_segment_t *segment = (led_strip_segment_t *) param;
+    led_strip_brightness_payload_t request;
+
+    if (!usb_talk_payload_decode(payload, &led_strip_segment_brightness_schema, &request, NULL))
     {
+        usb_talk_nack("payload");
         return;
     }
 
-    if (!lcd.mqtt)
+    segment->brightness = request.brightness;
+
+    bc_scheduler_plan_now(APPLICATION_TASK_ID);
+
+    led_strip_segment_config_get(payload, param);
+}
+
+static void led_strip_segment_effect_set(usb_talk_payload_t *payload, void *param)
+{
+    led_strip_segment_t *segment = (led_strip_segment_t *) param;
+    led_strip_effect_payload_t request = { .wait = segment->wait };
+
+    if (!usb_talk_payload_decode(payload, &led_strip_effect_schema, &request, NULL))
     {
-        bc_module_lcd_clear();
-        lcd.mqtt = true;
+        usb_talk_nack("payload");
+        return;
     }
 
-    usb_talk_payload_get_key_int(payload, "font", &font_size);
-    switch (font_size) {
-        case 11:
+    segment->effect = request.effect;
+    segment->wait = request.wait;
+    segment->step = 0;
+    segment->next = 0;
+
+    bc_scheduler_plan_now(segments.task_id);
+    bc_scheduler_plan_now(APPLICATION_TASK_ID);
+
+    led_strip_segment_config_get(payload, param);
+}
+
+static void _led_strip_segment_task(void *param)
+{
+    (void) param;
+
+    bc_tick_t now = bc_tick_get();
+    bc_tick_t next = BC_TICK_INFINITY;
+
+    for (int i = 0; i < LED_STRIP_SEGMENT_COUNT; i++)
+    {
+        led_strip_segment_t *segment = &segments.list[i];
+
+        if ((segment->effect == LED_STRIP_EFFECT_NONE) || (segment->count == 0))
         {
-            bc_module_lcd_set_font(&bc_font_ubuntu_11);
-            break;
+            continue;
         }
-        case 13:
+
+        if (segment->next <= now)
         {
-            bc_module_lcd_set_font(&bc_font_ubuntu_13);
-            break;
+            segment->step++;
+            segment->next = now + segment->wait;
+
+            bc_scheduler_plan_now(APPLICATION_TASK_ID);
         }
-        case 15:
+
+        if (segment->next < next)
         {
-            bc_module_lcd_set_font(&bc_font_ubuntu_15);
-            break;
+            next = segment->next;
         }
-        case 24:
+    }
+
+    bc_scheduler_plan_current_absolute(next);
+}
+
+static led_strip_segment_t *_led_strip_segment_find(int position)
+{
+    // Where segments overlap the one with the lowest id wins
+    for (int i = 0; i < LED_STRIP_SEGMENT_COUNT; i++)
+    {
+        led_strip_segment_t *segment = &segments.list[i];
+
+        if ((position >= segment->offset) && (position < segment->offset + segment->count))
         {
-            bc_module_lcd_set_font(&bc_font_ubuntu_24);
-            break;
+            return segment;
         }
-        case 28:
+    }
+
+    return NULL;
+}
+
+static void _led_strip_segment_prepare(void)
+{
+    for (int i = 0; i < LED_STRIP_SEGMENT_COUNT; i++)
+    {
+        led_strip_segment_t *segment = &segments.list[i];
+        led_strip_segment_frame_t *frame = &segments.frame[i];
+        int level = segment->brightness;
+
+        if (segment->effect == LED_STRIP_EFFECT_PULSE)
         {
-            bc_module_lcd_set_font(&bc_font_ubuntu_28);
-            break;
+            int pulse = segment->step < 128 ? segment->step * 2 : (255 - segment->step) * 2;
+
+            level = level * pulse / 255;
         }
-        case 33:
+
+        frame->level = level;
+        frame->rainbow = (segment->effect == LED_STRIP_EFFECT_RAINBOW) && (segment->count > 0);
+
+        if (frame->rainbow)
         {
-            bc_module_lcd_set_font(&bc_font_ubuntu_33);
-            break;
+            frame->wheel_step = 256 / segment->count;
+            frame->wheel_rest = 256 % segment->count;
+            frame->count = segment->count;
         }
-        default:
+    }
+
+    led_strip_run_t *run = NULL;
+
+    for (int position = 0; position < led_strip_count; position++)
+    {
+        led_strip_segment_t *segment = _led_strip_segment_find(position);
+        uint8_t id = segment != NULL ? segment->id : LED_STRIP_RUN_NONE;
+
+        if ((run == NULL) || (run->segment != id))
         {
-            bc_module_lcd_set_font(&bc_font_ubuntu_15);
-            break;
+            run = run == NULL ? segments.runs : run + 1;
+            run->segment = id;
+
+            if ((segment != NULL) && segments.frame[id].rainbow)
+            {
+                int wheel = (position - segment->offset) * 256;
+
+                run->wheel = wheel / segment->count + segment->step;
+                run->rest = wheel % segment->count;
+            }
+        }
+
+        run->end = position + 1;
+    }
+}
+
+static void _led_strip_wheel(uint8_t wheel, uint8_t color[4])
+{
+    if (wheel < 85)
+    {
+        color[0] = 255 - wheel * 3;
+        color[1] = wheel * 3;
+        color[2] = 0;
+    }
+    else if (wheel < 170)
+    {
+        wheel -= 85;
+        color[0] = 0;
+        color[1] = 255 - wheel * 3;
+        color[2] = wheel * 3;
+    }
+    else
+    {
+        wheel -= 170;
+        color[0] = wheel * 3;
+        color[1] = 0;
+        color[2] = 255 - wheel * 3;
+    }
+
+    color[3] = 0;
+}
+
+// Runs in the DMA interrupt of the strip for every pixel as it is sent, so it has no divide and no search
+static void _led_strip_pixel(int position, uint8_t color[4])
+{
+    if ((position == 0) || (position == segments.run->end))
+    {
+        segments.run = position == 0 ? segments.runs : segments.run + 1;
+        segments.wheel = segments.run->wheel;
+        segments.rest = segments.run->rest;
+    }
+
+    if (segments.run->segment != LED_STRIP_RUN_NONE)
+    {
+        const led_strip_segment_frame_t *frame = &segments.frame[segments.run->segment];
+
+        if (frame->rainbow)
+        {
+            _led_strip_wheel(segments.wheel, color);
+
+            // The wheel moves by 256 / count per pixel, the remainder carries as in a line drawing
+            segments.wheel += frame->wheel_step;
+            segments.rest += frame->wheel_rest;
+
+            if (segments.rest >= frame->count)
+            {
+                segments.rest -= frame->count;
+                segments.wheel++;
+            }
+        }
+
+        if (frame->level != 255)
+        {
+            for (int channel = 0; channel < 4; channel++)
+            {
+                int value = color[channel] * frame->level;
+
+                // Divides by 255 exactly for any product of two bytes
+                color[channel] = (value + 1 + (value >> 8)) >> 8;
+            }
+        }
+    }
+
+    led_strip_lut_apply(color);
+}
+
+static bool _led_strip_write(void)
+{
+    if (!bc_led_strip_is_ready(&led_strip))
+    {
+        return false;
+    }
+
+    // The finished upload becomes the front buffer only now that the strip no longer sends the old one
+    if (upload.ready)
+    {
+        uint8_t *front = pixels;
+
+        pixels = upload.back;
+        upload.back = front;
+        upload.ready = false;
+
+        led_strip_buffer.buffer = (uint32_t *) pixels;
+    }
+
+    _led_strip_segment_prepare();
+
+    return bc_led_strip_write(&led_strip);
+}
+
+static uint8_t *_led_strip_upload_begin(void)
+{
+    // An upload may cover only part of the strip, the rest starts as the latest frame, a waiting one included
+    if (!upload.active && !upload.ready)
+    {
+        memcpy(upload.back, pixels, led_strip_count * led_strip_buffer.type);
+    }
+
+    upload.active = true;
+    upload.ready = false;
+
+    return upload.back;
+}
+
+static void _led_strip_upload_end(bool done)
+{
+    // Without a chunk nothing was written, a frame already waiting stays as it is
+    if (!upload.active)
+    {
+        return;
+    }
+
+    upload.active = false;
+    upload.ready = done;
+
+    if (done)
+    {
+        ram_buffer_use(ram_stats.upload, led_strip_count * led_strip_buffer.type);
+
+        bc_scheduler_plan_now(APPLICATION_TASK_ID);
+    }
+}
+
+static bool _led_strip_scene_check(const led_strip_scene_t *scene)
+{
+    // The checksum only proves the scene was saved whole, its values get the bounds of the topics that set them
+    if ((scene->count < 1) || (scene->count > MAX_PIXELS) ||
+        ((scene->type != BC_LED_STRIP_TYPE_RGB) && (scene->type != BC_LED_STRIP_TYPE_RGBW)))
+    {
+        return false;
+    }
+
+    for (int channel = 0; channel < LED_STRIP_LUT_CHANNELS; channel++)
+    {
+        if (!((scene->gamma[channel] > 0.f) && (scene->gamma[channel] <= GAMMA_MAX)))
+        {
+            return false;
+        }
+    }
+
+    for (int i = 0; i < LED_STRIP_SEGMENT_COUNT; i++)
+    {
+        const led_strip_scene_segment_t *segment = &scene->segment[i];
+
+        if ((segment->offset >= MAX_PIXELS) || (segment->offset + segment->count > MAX_PIXELS) ||
+            (segment->effect > LED_STRIP_EFFECT_PULSE) ||
+            (segment->wait < LED_STRIP_EFFECT_WAIT_MIN) || (segment->wait > LED_STRIP_EFFECT_WAIT_MAX))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void _led_strip_scene_restore(void)
+{
+    led_strip_scene_t scene;
+
+    if (!config_load(SCENE_ADDRESS, &scene, sizeof(scene)) || !_led_strip_scene_check(&scene))
+    {
+        set_default_pixels();
+
+        return;
+    }
+
+    led_strip_count = scene.count;
+    led_strip_buffer.count = led_strip_count;
+    led_strip_buffer.type = scene.type;
+
+    // Only the pixels of the configured strip are kept, a scene of a short strip costs a short write
+    pixels_length = led_strip_count * led_strip_buffer.type;
+
+    if (!config_load(SCENE_PIXELS_ADDRESS, pixels, pixels_length))
+    {
+        set_default_pixels();
+    }
+
+    led_strip_lut_set(scene.brightness, scene.gamma);
+
+    for (int i = 0; i < LED_STRIP_SEGMENT_COUNT; i++)
+    {
+        segments.list[i].offset = scene.segment[i].offset;
+        segments.list[i].count = scene.segment[i].count;
+        segments.list[i].wait = scene.segment[i].wait;
+        segments.list[i].brightness = scene.segment[i].brightness;
+        segments.list[i].effect = scene.segment[i].effect;
+    }
+
+    bc_scheduler_plan_now(segments.task_id);
+
+    light = scene.light;
+}
+
+static void led_strip_scene_save(usb_talk_payload_t *payload, void *param)
+{
+    (void) payload;
+    (void) param;
+
+    led_strip_scene_t scene;
+
+    // The layout is in flux until the reconfiguration is done
+    if (reconfig.state != LED_STRIP_RECONFIG_IDLE)
+    {
+        usb_talk_nack("busy");
+        return;
+    }
+
+    memset(&scene, 0, sizeof(scene));
+
+    scene.count = led_strip_count;
+    scene.type = led_strip_buffer.type;
+    scene.brightness = led_strip_lut_get_brightness();
+    led_strip_lut_get_gamma(scene.gamma);
+    scene.light = light;
+
+    for (int i = 0; i < LED_STRIP_SEGMENT_COUNT; i++)
+    {
+        scene.segment[i].offset = segments.list[i].offset;
+        scene.segment[i].count = segments.list[i].count;
+        scene.segment[i].wait = segments.list[i].wait;
+        scene.segment[i].brightness = segments.list[i].brightness;
+        scene.segment[i].effect = segments.list[i].effect;
+    }
+
+    // Pixels of another layout fail the length check on load and fall back to the default pattern
+    if (!config_save(SCENE_PIXELS_ADDRESS, pixels, led_strip_count * led_strip_buffer.type))
+    {
+        usb_talk_nack("storage");
+        return;
+    }
+
+    if (!config_save(SCENE_ADDRESS, &scene, sizeof(scene)))
+    {
+        usb_talk_nack("storage");
+        return;
+    }
+
+    usb_talk_send_string("[\"" PREFIX_BASE "/led-strip/-/scene/save/ok\", null]\n");
+}
+
+static void led_strip_stream_start(usb_talk_payload_t *payload, void *param)
+{
+    (void) payload;
+    (void) param;
+
+    stream.active = true;
+    stream.started = false;
+    stream.pending = false;
+    stream.received = 0;
+    stream.shown = 0;
+    stream.late = 0;
+    stream.dropped = 0;
+    stream.report_shown = 0;
+    stream.report_tick = bc_tick_get();
+
+    usb_talk_stream_start(_led_strip_stream_frame, NULL, STREAM_TIMEOUT);
+
+    bc_scheduler_plan_relative(stream.task_id, STREAM_REPORT_INTERVAL);
+
+    usb_talk_send_string("[\"" PREFIX_BASE "/led-strip/-/stream/start/ok\", null]\n");
+}
+
+static bool _led_strip_stream_frame(usb_talk_frame_t *frame, void *param)
+{
+    (void) param;
+
+    switch (frame->event)
+    {
+        case USB_TALK_FRAME_EVENT_BEGIN:
+        {
+            if (frame->length > (size_t) (led_strip_count * led_strip_buffer.type))
+            {
+                stream.dropped++;
+
+                return false;
+            }
+
+            // Only frames newer than the last one taken are worth the bytes
+            if (stream.started && ((int16_t) (frame->sequence - stream.sequence) <= 0))
+            {
+                stream.late++;
+
+                return false;
+            }
+
+            return true;
+        }
+        case USB_TALK_FRAME_EVENT_CHUNK:
+        {
+            memcpy(_led_strip_upload_begin() + frame->offset, frame->buffer, frame->buffer_length);
+
+            return true;
+        }
+        case USB_TALK_FRAME_EVENT_DONE:
+        {
+            stream.started = true;
+            stream.sequence = frame->sequence;
+            stream.received++;
+
+            pixels_length = frame->length;
+
+            _led_strip_upload_end(true);
+
+            if (light)
+            {
+                // The previous frame never reached the strip
+                if (stream.pending)
+                {
+                    stream.dropped++;
+                }
+
+                stream.pending = true;
+
+                bc_scheduler_plan_now(APPLICATION_TASK_ID);
+            }
+
+            return true;
+        }
+        case USB_TALK_FRAME_EVENT_END:
+        {
+            // A frame cut off by the end of the stream is not shown
+            _led_strip_upload_end(false);
+
+            stream.active = false;
+
+            _led_strip_stream_report();
+
+            bc_scheduler_plan_absolute(stream.task_id, BC_TICK_INFINITY);
+
+            return true;
+        }
+        default:
+        {
+            return false;
+        }
+    }
+}
+
+static void _led_strip_stream_report(void)
+{
+    bc_tick_t now = bc_tick_get();
+    float fps = now > stream.report_tick ? (stream.shown - stream.report_shown) * 1000.f / (now - stream.report_tick) : 0.f;
+
+    usb_talk_publish_led_strip_stream(PREFIX_BASE, &fps, &stream.received, &stream.shown, &stream.late, &stream.dropped);
+
+    stream.report_shown = stream.shown;
+    stream.report_tick = now;
+}
+
+static void _led_strip_stream_task(void *param)
+{
+    (void) param;
+
+    if (!stream.active)
+    {
+        return;
+    }
+
+    _led_strip_stream_report();
+
+    bc_scheduler_plan_current_relative(STREAM_REPORT_INTERVAL);
+}
+
+static void lcd_text_set(usb_talk_payload_t *payload, void *param)
+{
+    (void) param;
+    lcd_text_payload_t request = { .font = 0 };
+
+    if (!_boot_is_ready(BOOT_PHASE_LCD))
+    {
+        usb_talk_nack("not-ready");
+        return;
+    }
+
+    if (!usb_talk_payload_decode(payload, &lcd_text_schema, &request, NULL))
+    {
+        usb_talk_nack("payload");
+        return;
+    }
+
+    if (!lcd.mqtt)
+    {
+        bc_module_lcd_clear();
+        lcd.mqtt = true;
+    }
+
+    switch (request.font) {
+        case 11:
+        {
+            bc_module_lcd_set_font(&bc_font_ubuntu_11);
+            break;
+        }
+        case 13:
+        {
+            bc_module_lcd_set_font(&bc_font_ubuntu_13);
+            break;
+        }
+        case 15:
+        {
+            bc_module_lcd_set_font(&bc_font_ubuntu_15);
+            break;
+        }
+        case 24:
+        {
+            bc_module_lcd_set_font(&bc_font_ubuntu_24);
+            break;
+        }
+        case 28:
+        {
+            bc_module_lcd_set_font(&bc_font_ubuntu_28);
+            break;
+        }
+        case 33:
+        {
+            bc_module_lcd_set_font(&bc_font_ubuntu_33);
+            break;
+        }
+        default:
+        {
+            bc_module_lcd_set_font(&bc_font_ubuntu_15);
+            break;
+        }
+    }
+
+    bc_module_lcd_draw_string(request.x, request.y, request.text);
+}
+
+static void lcd_config_set(usb_talk_payload_t *payload, void *param)
+{
+    (void) param;
+    lcd_config_payload_t request;
+
+    if (!usb_talk_payload_decode(payload, &lcd_config_schema, &request, NULL))
+    {
+        usb_talk_nack("payload");
+        return;
+    }
+
+    config.lcd_page_interval = request.page_interval;
+
+    _config_apply();
+
+    // The config is in use either way, the nack tells the host it will not survive a reset
+    if (!config_save(CONFIG_ADDRESS, &config, sizeof(config)))
+    {
+        usb_talk_nack("storage");
+        return;
+    }
+
+    usb_talk_publish_lcd_config(PREFIX_BASE, &config.lcd_page_interval);
+}
+
+static void lcd_config_get(usb_talk_payload_t *payload, void *param)
+{
+    (void) payload;
+    (void) param;
+
+    usb_talk_publish_lcd_config(PREFIX_BASE, &config.lcd_page_interval);
+}
+
+static void sensor_config_set(usb_talk_payload_t *payload, void *param)
+{
+    config_interval_t *interval = (config_interval_t *) param;
+    sensor_config_payload_t request = {
+        .sample_interval = interval->sample_interval,
+        .update_interval = interval->update_interval,
+        .filter = interval->filter.type,
+        .oversample = interval->filter.oversample,
+        .alpha = interval->filter.alpha,
+        .limit = interval->filter.limit
+    };
+    uint32_t found;
+
+    if (!usb_talk_payload_decode(payload, &sensor_config_schema, &request, &found) || (found == 0))
+    {
+        usb_talk_nack("payload");
+        return;
+    }
+
+    // The tag is read oversample times per sample interval, an EMA with alpha 0 would never move,
+    // and a window holds at most as many samples as its 16 bit count takes
+    if ((request.update_interval < request.sample_interval) ||
+        (request.update_interval / request.sample_interval > UINT16_MAX) ||
+        (request.sample_interval / request.oversample < CONFIG_INTERVAL_MIN) || (request.alpha <= 0))
+    {
+        usb_talk_nack("invalid");
+        return;
+    }
+
+    interval->sample_interval = request.sample_interval;
+    interval->update_interval = request.update_interval;
+    interval->filter.type = request.filter;
+    interval->filter.oversample = request.oversample;
+    interval->filter.alpha = request.alpha;
+    interval->filter.limit = request.limit;
+
+    _config_apply();
+
+    if (!config_save(CONFIG_ADDRESS, &config, sizeof(config)))
+    {
+        usb_talk_nack("storage");
+        return;
+    }
+
+    sensor_config_get(payload, param);
+}
+
+static void sensor_config_get(usb_talk_payload_t *payload, void *param)
+{
+    (void) payload;
+    config_interval_t *interval = (config_interval_t *) param;
+
+    usb_talk_publish_sensor_config(PREFIX_BASE, config_sensor_names[interval - config.sensor],
+                                   &interval->sample_interval, &interval->update_interval,
+                                   sensor_filter_enums[interval->filter.type].name, &interval->filter.oversample,
+                                   &interval->filter.alpha, &interval->filter.limit);
+}
+
+static void sensor_last_get(usb_talk_payload_t *payload, void *param)
+{
+    (void) payload;
+    config_interval_t *interval = (config_interval_t *) param;
+
+    _sensor_last_publish(interval - config.sensor, NULL);
+}
+
+static void sensor_last_get_channel(usb_talk_payload_t *payload, void *param)
+{
+    config_interval_t *interval = (config_interval_t *) param;
+    config_sensor_t sensor = interval - config.sensor;
+    sensor_stats_t *stats;
+    uint8_t bus;
+    uint8_t number;
+    uint8_t i2c;
+    float value;
+    bc_tick_t age;
+
+    if (!usb_talk_payload_get_channel(payload, &bus, &number) || !_sensor_last_channel(sensor, bus, number, &i2c) ||
+        ((stats = _sensor_last_find(sensor, i2c)) == NULL))
+    {
+        usb_talk_nack("invalid");
+        return;
+    }
+
+    if (!sensor_stats_get_last(stats, &value, &age))
+    {
+        usb_talk_nack("not-ready");
+        return;
+    }
+
+    _sensor_last_publish(sensor, &i2c);
+}
+
+static void sensor_last_get_all(usb_talk_payload_t *payload, void *param)
+{
+    (void) payload;
+    (void) param;
+
+    sensor_last.index = 0;
+
+    bc_scheduler_plan_now(sensor_last.task_id);
+}
+
+static void _sensor_last_task(void *param)
+{
+    (void) param;
+
+    if (sensor_last.index >= CONFIG_SENSOR_COUNT)
+    {
+        return;
+    }
+
+    // One kind per pass keeps the burst within the USB transmit FIFO
+    _sensor_last_publish(sensor_last.index++, NULL);
+
+    bc_scheduler_plan_current_relative(5);
+}
+
+static bool _sensor_last_channel(config_sensor_t sensor, uint8_t bus, uint8_t number, uint8_t *i2c)
+{
+    // Addresses by the channel number in the topics, the hygrometer has no number 1
+    static const uint8_t address[CONFIG_SENSOR_CO2_METER][4] =
+    {
+        [CONFIG_SENSOR_THERMOMETER] = { BC_TAG_TEMPERATURE_I2C_ADDRESS_DEFAULT, BC_TAG_TEMPERATURE_I2C_ADDRESS_ALTERNATE },
+        [CONFIG_SENSOR_HYGROMETER] = { 0x5f, 0, 0x40, 0x41 },
+        [CONFIG_SENSOR_LUX_METER] = { BC_TAG_LUX_METER_I2C_ADDRESS_DEFAULT, BC_TAG_LUX_METER_I2C_ADDRESS_ALTERNATE },
+        [CONFIG_SENSOR_BAROMETER] = { 0x60 }
+    };
+
+    if ((sensor >= CONFIG_SENSOR_CO2_METER) || (bus > BC_I2C_I2C1) || (number >= 4) || (address[sensor][number] == 0))
+    {
+        return false;
+    }
+
+    *i2c = (bus << 7) | address[sensor][number];
+
+    return true;
+}
+
+static sensor_stats_t *_sensor_last_find(config_sensor_t sensor, uint8_t i2c)
+{
+    switch (sensor)
+    {
+        case CONFIG_SENSOR_THERMOMETER:
+        {
+            for (size_t i = 0; i < sizeof(temperature_sensor) / sizeof(temperature_sensor[0]); i++)
+            {
+                if (temperature_sensor[i].i2c == i2c)
+                {
+                    return &temperature_sensor[i].stats;
+                }
+            }
+            break;
+        }
+        case CONFIG_SENSOR_HYGROMETER:
+        {
+            for (size_t i = 0; i < sizeof(humidity_sensor) / sizeof(humidity_sensor[0]); i++)
+            {
+                if (humidity_sensor[i].i2c == i2c)
+                {
+                    return &humidity_sensor[i].stats;
+                }
+            }
+            break;
+        }
+        case CONFIG_SENSOR_LUX_METER:
+        {
+            for (size_t i = 0; i < sizeof(lux_meter_sensor) / sizeof(lux_meter_sensor[0]); i++)
+            {
+                if (lux_meter_sensor[i].i2c == i2c)
+                {
+                    return &lux_meter_sensor[i].stats;
+                }
+            }
+            break;
+        }
+        case CONFIG_SENSOR_BAROMETER:
+        {
+            for (size_t i = 0; i < sizeof(barometer_sensor) / sizeof(barometer_sensor[0]); i++)
+            {
+                if (barometer_sensor[i].i2c == i2c)
+                {
+                    return &barometer_sensor[i].pressure;
+                }
+            }
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+static void _sensor_last_publish(config_sensor_t sensor, const uint8_t *i2c)
+{
+    // Without a channel every channel of the kind goes out
+    switch (sensor)
+    {
+        case CONFIG_SENSOR_THERMOMETER:
+        {
+            for (size_t i = 0; i < sizeof(temperature_sensor) / sizeof(temperature_sensor[0]); i++)
+            {
+                if ((i2c == NULL) || (temperature_sensor[i].i2c == *i2c))
+                {
+                    usb_talk_publish_thermometer_last(PREFIX_BASE, &temperature_sensor[i].i2c, &temperature_sensor[i].stats);
+                }
+            }
+            break;
+        }
+        case CONFIG_SENSOR_HYGROMETER:
+        {
+            for (size_t i = 0; i < sizeof(humidity_sensor) / sizeof(humidity_sensor[0]); i++)
+            {
+                if ((i2c == NULL) || (humidity_sensor[i].i2c == *i2c))
+                {
+                    usb_talk_publish_humidity_sensor_last(PREFIX_BASE, &humidity_sensor[i].i2c, &humidity_sensor[i].stats);
+                }
+            }
+            break;
+        }
+        case CONFIG_SENSOR_LUX_METER:
+        {
+            for (size_t i = 0; i < sizeof(lux_meter_sensor) / sizeof(lux_meter_sensor[0]); i++)
+            {
+                if ((i2c == NULL) || (lux_meter_sensor[i].i2c == *i2c))
+                {
+                    usb_talk_publish_lux_meter_last(PREFIX_BASE, &lux_meter_sensor[i].i2c, &lux_meter_sensor[i].stats);
+                }
+            }
+            break;
+        }
+        case CONFIG_SENSOR_BAROMETER:
+        {
+            for (size_t i = 0; i < sizeof(barometer_sensor) / sizeof(barometer_sensor[0]); i++)
+            {
+                if ((i2c == NULL) || (barometer_sensor[i].i2c == *i2c))
+                {
+                    usb_talk_publish_barometer_last(PREFIX_BASE, &barometer_sensor[i].i2c, &barometer_sensor[i].pressure, &barometer_sensor[i].altitude);
+                }
+            }
+            break;
+        }
+        case CONFIG_SENSOR_CO2_METER:
+        {
+            usb_talk_publish_co2_concentation_last(PREFIX_BASE, &co2_stats);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
+
+// The same bounds as lcd_config_set and sensor_config_set put on what they store
+static bool _config_check(const config_t *config)
+{
+    if ((config->lcd_page_interval < CONFIG_INTERVAL_MIN) || (config->lcd_page_interval > CONFIG_INTERVAL_MAX))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < CONFIG_SENSOR_COUNT; i++)
+    {
+        const config_interval_t *interval = &config->sensor[i];
+
+        if ((interval->sample_interval < CONFIG_INTERVAL_MIN) || (interval->sample_interval > CONFIG_INTERVAL_MAX) ||
+            (interval->update_interval < interval->sample_interval) || (interval->update_interval > CONFIG_INTERVAL_MAX) ||
+            (interval->update_interval / interval->sample_interval > UINT16_MAX))
+        {
+            return false;
+        }
+
+        // The type indexes the enum table, NaN fails the float comparisons
+        if (((size_t) interval->filter.type >= sizeof(sensor_filter_enums) / sizeof(sensor_filter_enums[0]) - 1) ||
+            (interval->filter.oversample < 1) || (interval->filter.oversample > SENSOR_FILTER_LENGTH) ||
+            (interval->sample_interval / interval->filter.oversample < CONFIG_INTERVAL_MIN) ||
+            !(interval->filter.alpha > 0) || !(interval->filter.alpha <= 1) ||
+            !(interval->filter.limit >= 0) || !(interval->filter.limit <= 100000))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void _config_apply(void)
+{
+    config_interval_t *interval;
+
+    // The boot task applies the config once the tags and the CO2 module are up
+    if (!_boot_is_ready(BOOT_PHASE_MODULES))
+    {
+        return;
+    }
+
+    // Tags are read oversample times faster than the sample interval, the filter hands one value per sample interval on
+    interval = &config.sensor[CONFIG_SENSOR_THERMOMETER];
+    for (size_t i = 0; i < sizeof(temperature_tag) / sizeof(temperature_tag[0]); i++)
+    {
+        bc_tag_temperature_set_update_interval(&temperature_tag[i], interval->sample_interval / interval->filter.oversample);
+        _config_apply_filter(&temperature_sensor[i].filter, &interval->filter);
+        temperature_sensor[i].stats.window = interval->update_interval;
+    }
+
+    interval = &config.sensor[CONFIG_SENSOR_HYGROMETER];
+    for (size_t i = 0; i < sizeof(humidity_tag) / sizeof(humidity_tag[0]); i++)
+    {
+        bc_tag_humidity_set_update_interval(&humidity_tag[i], interval->sample_interval / interval->filter.oversample);
+        _config_apply_filter(&humidity_sensor[i].filter, &interval->filter);
+        humidity_sensor[i].stats.window = interval->update_interval;
+    }
+
+    interval = &config.sensor[CONFIG_SENSOR_LUX_METER];
+    for (size_t i = 0; i < sizeof(lux_meter) / sizeof(lux_meter[0]); i++)
+    {
+        bc_tag_lux_meter_set_update_interval(&lux_meter[i], interval->sample_interval / interval->filter.oversample);
+        _config_apply_filter(&lux_meter_sensor[i].filter, &interval->filter);
+        lux_meter_sensor[i].stats.window = interval->update_interval;
+    }
+
+    interval = &config.sensor[CONFIG_SENSOR_BAROMETER];
+    for (size_t i = 0; i < sizeof(barometer_tag) / sizeof(barometer_tag[0]); i++)
+    {
+        bc_tag_barometer_set_update_interval(&barometer_tag[i], interval->sample_interval / interval->filter.oversample);
+        _config_apply_filter(&barometer_sensor[i].pressure_filter, &interval->filter);
+        _config_apply_filter(&barometer_sensor[i].altitude_filter, &interval->filter);
+        barometer_sensor[i].pressure.window = interval->update_interval;
+        barometer_sensor[i].altitude.window = interval->update_interval;
+    }
+
+    interval = &config.sensor[CONFIG_SENSOR_CO2_METER];
+    bc_module_co2_set_update_interval(interval->sample_interval / interval->filter.oversample);
+    _config_apply_filter(&co2_filter, &interval->filter);
+    co2_stats.window = interval->update_interval;
+
+    lcd.next_page = 0;
+}
+
+static void _config_apply_filter(sensor_filter_t *filter, const sensor_filter_config_t *config)
+{
+    filter->config = config;
+
+    sensor_filter_reset(filter);
+}
+
+static void stats_cpu_get(usb_talk_payload_t *payload, void *param)
+{
+    (void) payload;
+    (void) param;
+
+    profilers.index = 0;
+
+    bc_scheduler_plan_now(profilers.task_id);
+}
+
+static void stats_cpu_reset(usb_talk_payload_t *payload, void *param)
+{
+    (void) payload;
+    (void) param;
+
+    profiler_reset();
+}
+
+static void _stats_cpu_task(void *param)
+{
+    (void) param;
+
+    profiler_t *profiler = profiler_get(profilers.index);
+
+    if (profiler == NULL)
+    {
+        return;
+    }
+
+    bc_tick_t period = profiler_get_period();
+
+    usb_talk_publish_profiler(PREFIX_BASE, profiler, &period);
+
+    profilers.index++;
+
+    bc_scheduler_plan_current_relative(5);
+}
+
+static void stats_usb_get(usb_talk_payload_t *payload, void *param)
+{
+    (void) payload;
+    (void) param;
+
+    usb_talk_publish_stats(PREFIX_BASE);
+}
+
+static void stats_usb_reset(usb_talk_payload_t *payload, void *param)
+{
+    (void) payload;
+    (void) param;
+
+    usb_talk_stats_reset();
+}
+
+static void stats_boot_get(usb_talk_payload_t *payload, void *param)
+{
+    (void) payload;
+    (void) param;
+
+    if (!_boot_is_ready(BOOT_PHASE_MODULES))
+    {
+        usb_talk_nack("not-ready");
+        return;
+    }
+
+    usb_talk_publish_boot(PREFIX_BASE, boot_phase_names, boot.phases, BOOT_PHASE_COUNT, &boot.ready_tick);
+}
+
+static void stats_ram_get(usb_talk_payload_t *payload, void *param)
+{
+    (void) payload;
+    (void) param;
+
+    ram_usage_t usage;
+
+    ram_get_usage(&usage);
+
+    usb_talk_publish_ram(PREFIX_BASE, &usage);
+
+    ram_stats.index = 0;
+
+    bc_scheduler_plan_relative(ram_stats.task_id, 5);
+}
+
+static void _stats_ram_task(void *param)
+{
+    (void) param;
+
+    ram_buffer_t *buffer = ram_buffer_get(ram_stats.index);
+
+    if (buffer == NULL)
+    {
+        return;
+    }
+
+    usb_talk_publish_ram_buffer(PREFIX_BASE, buffer);
+
+    ram_stats.index++;
+
+    bc_scheduler_plan_current_relative(5);
+}
+
+static void state_snapshot_get(usb_talk_payload_t *payload, void *param)
+{
+    (void) payload;
+    (void) param;
+
+    bool modules = _boot_is_ready(BOOT_PHASE_MODULES);
+    bc_module_relay_state_t relay_0_0_state = modules ? bc_module_relay_get_state(&relay_0_0) : BC_MODULE_RELAY_STATE_UNKNOWN;
+    bc_module_relay_state_t relay_0_1_state = modules ? bc_module_relay_get_state(&relay_0_1) : BC_MODULE_RELAY_STATE_UNKNOWN;
+    bc_tick_t now = bc_tick_get();
+
+    usb_talk_snapshot_begin(PREFIX_BASE);
+
+    usb_talk_snapshot_add("\"led\": %s", led_state ? "true" : "false");
+    usb_talk_snapshot_add("\"light\": %s", light ? "true" : "false");
+    usb_talk_snapshot_add("\"relay/-\": %s", bc_module_power_relay_get_state() ? "true" : "false");
+    usb_talk_snapshot_add("\"relay/0:0\": %s", relay_0_0_state == BC_MODULE_RELAY_STATE_UNKNOWN ? "null" :
+                          relay_0_0_state == BC_MODULE_RELAY_STATE_TRUE ? "true" : "false");
+    usb_talk_snapshot_add("\"relay/0:1\": %s", relay_0_1_state == BC_MODULE_RELAY_STATE_UNKNOWN ? "null" :
+                          relay_0_1_state == BC_MODULE_RELAY_STATE_TRUE ? "true" : "false");
+    usb_talk_snapshot_add("\"led-strip\": {\"mode\": \"%s\", \"count\": %d, \"brightness\": %d}",
+                          led_strip_buffer.type == BC_LED_STRIP_TYPE_RGB ? "rgb" : "rgbw", led_strip_count,
+                          (int) led_strip_lut_get_brightness());
+
+    for (size_t i = 0; i < sizeof(temperature_sensor) / sizeof(temperature_sensor[0]); i++)
+    {
+        usb_talk_snapshot_add_thermometer(&temperature_sensor[i].i2c, &temperature_sensor[i].stats);
+    }
+
+    for (size_t i = 0; i < sizeof(humidity_sensor) / sizeof(humidity_sensor[0]); i++)
+    {
+        usb_talk_snapshot_add_humidity_sensor(&humidity_sensor[i].i2c, &humidity_sensor[i].stats);
+    }
+
+    for (size_t i = 0; i < sizeof(lux_meter_sensor) / sizeof(lux_meter_sensor[0]); i++)
+    {
+        usb_talk_snapshot_add_lux_meter(&lux_meter_sensor[i].i2c, &lux_meter_sensor[i].stats);
+    }
+
+    for (size_t i = 0; i < sizeof(barometer_sensor) / sizeof(barometer_sensor[0]); i++)
+    {
+        usb_talk_snapshot_add_barometer(&barometer_sensor[i].i2c, &barometer_sensor[i].pressure, &barometer_sensor[i].altitude);
+    }
+
+    usb_talk_snapshot_add_co2_concentation(&co2_stats);
+
+    for (size_t i = 0; i < REMOTE_COUNT; i++)
+    {
+        if (remotes[i].address != 0)
+        {
+            usb_talk_snapshot_add("\"remote/%08" PRIx32 "\": %" PRIu32, remotes[i].address, (uint32_t) (now - remotes[i].tick));
         }
     }
 
-    bc_module_lcd_draw_string(x, y, text);
+    usb_talk_snapshot_end();
 }
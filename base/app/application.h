@@ -3,7 +3,199 @@
 
 #include <bc_common.h>
 #include <bcl.h>
+#include <sensor_stats.h>
+#include <sensor_filter.h>
+#include <radio_schema.h>
 
+// Legacy buffers from remotes before the schema: type, i2c, then min, max, mean as float and count per value
+#define RADIO_BUFFER_STATS_SIZE 14
 
+typedef struct
+{
+    uint8_t i2c;
+    sensor_filter_t filter;
+    sensor_stats_t stats;
+
+} sensor_t;
+
+typedef struct
+{
+    uint8_t i2c;
+    sensor_filter_t pressure_filter;
+    sensor_filter_t altitude_filter;
+    sensor_stats_t pressure;
+    sensor_stats_t altitude;
+
+} barometer_t;
+
+typedef enum
+{
+    CONFIG_SENSOR_THERMOMETER = 0,
+    CONFIG_SENSOR_HYGROMETER = 1,
+    CONFIG_SENSOR_LUX_METER = 2,
+    CONFIG_SENSOR_BAROMETER = 3,
+    CONFIG_SENSOR_CO2_METER = 4,
+    CONFIG_SENSOR_COUNT = 5
+
+} config_sensor_t;
+
+typedef struct
+{
+    uint32_t sample_interval;
+    uint32_t update_interval;
+    sensor_filter_config_t filter;
+
+} config_interval_t;
+
+typedef struct
+{
+    config_interval_t sensor[CONFIG_SENSOR_COUNT];
+    uint32_t lcd_page_interval;
+
+} config_t;
+
+typedef enum
+{
+    LED_STRIP_RECONFIG_IDLE = 0,
+    LED_STRIP_RECONFIG_BLANK = 1,
+    LED_STRIP_RECONFIG_WAIT = 2,
+    LED_STRIP_RECONFIG_SHOW = 3
+
+} led_strip_reconfig_state_t;
+
+typedef enum
+{
+    BOOT_PHASE_CORE = 0,
+    BOOT_PHASE_LIGHT = 1,
+    BOOT_PHASE_RADIO = 2,
+    BOOT_PHASE_LCD = 3,
+    BOOT_PHASE_TAGS = 4,
+    BOOT_PHASE_MODULES = 5,
+    BOOT_PHASE_COUNT = 6
+
+} boot_phase_t;
+
+typedef struct
+{
+    uint16_t offset;
+    uint16_t count;
+    uint16_t wait;
+    uint8_t brightness;
+    uint8_t effect;
+
+} led_strip_scene_segment_t;
+
+typedef struct
+{
+    uint16_t count;
+    uint8_t type;
+    uint8_t brightness;
+    float gamma[4];
+    bool light;
+    led_strip_scene_segment_t segment[4];
+
+} led_strip_scene_t;
+
+typedef struct
+{
+    int type;
+    int count;
+
+} led_strip_config_payload_t;
+
+typedef enum
+{
+    LED_STRIP_EFFECT_NONE = 0,
+    LED_STRIP_EFFECT_RAINBOW = 1,
+    LED_STRIP_EFFECT_PULSE = 2
+
+} led_strip_effect_t;
+
+typedef struct
+{
+    int id;
+    int offset;
+    int count;
+    int brightness;
+    led_strip_effect_t effect;
+    int wait;
+    uint8_t step;
+    bc_tick_t next;
+
+} led_strip_segment_t;
+
+typedef struct
+{
+    uint8_t level;
+    bool rainbow;
+    uint8_t wheel_step;
+    uint16_t wheel_rest;
+    uint16_t count;
+
+} led_strip_segment_frame_t;
+
+typedef struct
+{
+    uint16_t end;
+    uint8_t segment;
+    uint8_t wheel;
+    uint16_t rest;
+
+} led_strip_run_t;
+
+typedef struct
+{
+    uint32_t address;
+    bc_tick_t tick;
+
+} remote_t;
+
+typedef struct
+{
+    int offset;
+    int count;
+
+} led_strip_segment_config_payload_t;
+
+typedef struct
+{
+    int effect;
+    int wait;
+
+} led_strip_effect_payload_t;
+
+typedef struct
+{
+    int brightness;
+    float gamma;
+    float gamma_channel[4];
+
+} led_strip_brightness_payload_t;
+
+typedef struct
+{
+    int x;
+    int y;
+    int font;
+    char text[32];
+
+} lcd_text_payload_t;
+
+typedef struct
+{
+    int page_interval;
+
+} lcd_config_payload_t;
+
+typedef struct
+{
+    int sample_interval;
+    int update_interval;
+    int filter;
+    int oversample;
+    float alpha;
+    float limit;
+
+} sensor_config_payload_t;
 
 #endif
@@ -0,0 +1,11 @@
+#ifndef _B64_H
+#define _B64_H
+
+#include <bc_common.h>
+
+#define B64_INVALID 0xff
+
+uint8_t b64_get_value(char character);
+size_t b64_decode_quanta(const char *input, size_t count, uint8_t *output);
+
+#endif /* _B64_H */
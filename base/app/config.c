@@ -0,0 +1,67 @@
+#include <config.h>
+#include <bc_eeprom.h>
+
+#define CONFIG_SIGNATURE 0xbc0ec0f1
+
+typedef struct
+{
+    uint32_t signature;
+    uint16_t length;
+    uint16_t checksum;
+
+} config_header_t;
+
+static uint16_t _config_checksum(const void *config, size_t length);
+
+bool config_load(uint32_t address, void *config, size_t length)
+{
+    config_header_t header;
+
+    if (!bc_eeprom_read(address, &header, sizeof(header)))
+    {
+        return false;
+    }
+
+    if ((header.signature != CONFIG_SIGNATURE) || (header.length != length))
+    {
+        return false;
+    }
+
+    if (!bc_eeprom_read(address + sizeof(header), config, length))
+    {
+        return false;
+    }
+
+    return header.checksum == _config_checksum(config, length);
+}
+
+bool config_save(uint32_t address, const void *config, size_t length)
+{
+    config_header_t header = {
+            .signature = CONFIG_SIGNATURE,
+            .length = length,
+            .checksum = _config_checksum(config, length)
+    };
+
+    if (!bc_eeprom_write(address + sizeof(header), config, length))
+    {
+        return false;
+    }
+
+    return bc_eeprom_write(address, &header, sizeof(header));
+}
+
+static uint16_t _config_checksum(const void *config, size_t length)
+{
+    const uint8_t *p = (const uint8_t *) config;
+    uint16_t a = 0xff;
+    uint16_t b = 0xff;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        a = (a + p[i]) % 255;
+        b = (b + a) % 255;
+    }
+
+    return (b << 8) | a;
+}
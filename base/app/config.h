@@ -0,0 +1,9 @@
+#ifndef _CONFIG_H
+#define _CONFIG_H
+
+#include <bc_common.h>
+
+bool config_load(uint32_t address, void *config, size_t length);
+bool config_save(uint32_t address, const void *config, size_t length);
+
+#endif /* _CONFIG_H */
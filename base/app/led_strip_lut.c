@@ -0,0 +1,117 @@
+#include <led_strip_lut.h>
+
+// log2(255) in the Q15 of _led_strip_lut_log2, the level of a value is 2^(gamma * (log2(value) - log2(255)))
+#define LED_STRIP_LUT_LOG2_MAX 261958
+
+// log2(1 + i / 32) and 2^(-i / 32) in Q15, interpolated in between, off by at most one step of the output
+static const uint16_t _led_strip_lut_log2_table[33] =
+{
+    0, 1455, 2866, 4236, 5568, 6863, 8124, 9352, 10549, 11716, 12855, 13968, 15055, 16117, 17156, 18173,
+    19168, 20143, 21098, 22034, 22952, 23852, 24736, 25604, 26455, 27292, 28114, 28922, 29717, 30498, 31267, 32024,
+    32768
+};
+
+static const uint16_t _led_strip_lut_exp2_table[33] =
+{
+    32768, 32066, 31379, 30706, 30048, 29405, 28774, 28158, 27554, 26964, 26386, 25821, 25268, 24726, 24196, 23678,
+    23170, 22674, 22188, 21713, 21247, 20792, 20347, 19911, 19484, 19066, 18658, 18258, 17867, 17484, 17109, 16743,
+    16384
+};
+
+static struct
+{
+    uint8_t brightness;
+    float gamma[LED_STRIP_LUT_CHANNELS];
+    uint16_t exponent[LED_STRIP_LUT_CHANNELS];
+
+} _led_strip_lut;
+
+static uint8_t _led_strip_lut_get(int channel, uint8_t value);
+static uint32_t _led_strip_lut_log2(uint8_t value);
+
+void led_strip_lut_init(void)
+{
+    static const float gamma[LED_STRIP_LUT_CHANNELS] = { 1.f, 1.f, 1.f, 1.f };
+
+    led_strip_lut_set(255, gamma);
+}
+
+void led_strip_lut_set(uint8_t brightness, const float gamma[LED_STRIP_LUT_CHANNELS])
+{
+    _led_strip_lut.brightness = brightness;
+
+    // Nothing is tabulated, the gamma is kept as a Q10 exponent and every value is worked out when it is encoded
+    for (int channel = 0; channel < LED_STRIP_LUT_CHANNELS; channel++)
+    {
+        _led_strip_lut.gamma[channel] = gamma[channel];
+        _led_strip_lut.exponent[channel] = (uint16_t) (gamma[channel] * 1024.f + 0.5f);
+    }
+}
+
+uint8_t led_strip_lut_get_brightness(void)
+{
+    return _led_strip_lut.brightness;
+}
+
+void led_strip_lut_get_gamma(float gamma[LED_STRIP_LUT_CHANNELS])
+{
+    memcpy(gamma, _led_strip_lut.gamma, sizeof(_led_strip_lut.gamma));
+}
+
+void led_strip_lut_apply(uint8_t color[LED_STRIP_LUT_CHANNELS])
+{
+    for (int channel = 0; channel < LED_STRIP_LUT_CHANNELS; channel++)
+    {
+        color[channel] = _led_strip_lut_get(channel, color[channel]);
+    }
+}
+
+static uint8_t _led_strip_lut_get(int channel, uint8_t value)
+{
+    if (value == 0)
+    {
+        return 0;
+    }
+
+    uint32_t distance = LED_STRIP_LUT_LOG2_MAX - _led_strip_lut_log2(value);
+
+    // The interpolation runs a little low, right at the top it may come out just above log2(255)
+    if (distance > LED_STRIP_LUT_LOG2_MAX)
+    {
+        distance = 0;
+    }
+
+    uint32_t exponent = (distance * _led_strip_lut.exponent[channel]) >> 10;
+    uint32_t shift = exponent >> 15;
+
+    if (shift >= 16)
+    {
+        return 0;
+    }
+
+    uint32_t index = (exponent & 0x7fff) >> 10;
+    uint32_t rest = exponent & 0x3ff;
+    uint32_t level = _led_strip_lut_exp2_table[index] -
+                     (((_led_strip_lut_exp2_table[index] - _led_strip_lut_exp2_table[index + 1]) * rest) >> 10);
+
+    return (((level * _led_strip_lut.brightness) >> shift) + 0x4000) >> 15;
+}
+
+static uint32_t _led_strip_lut_log2(uint8_t value)
+{
+    uint32_t integer = 7;
+
+    while ((value & 0x80) == 0)
+    {
+        value <<= 1;
+        integer--;
+    }
+
+    // value is now the mantissa in 1.7 bits, its fraction picks the segment and the point within it
+    uint32_t fraction = (uint32_t) (value & 0x7f) << 8;
+    uint32_t index = fraction >> 10;
+    uint32_t rest = fraction & 0x3ff;
+
+    return (integer << 15) + _led_strip_lut_log2_table[index] +
+           (((_led_strip_lut_log2_table[index + 1] - _led_strip_lut_log2_table[index]) * rest) >> 10);
+}
@@ -0,0 +1,16 @@
+#ifndef _LED_STRIP_LUT_H
+#define _LED_STRIP_LUT_H
+
+#include <bc_common.h>
+
+#define LED_STRIP_LUT_CHANNELS 4
+
+void led_strip_lut_init(void);
+void led_strip_lut_set(uint8_t brightness, const float gamma[LED_STRIP_LUT_CHANNELS]);
+uint8_t led_strip_lut_get_brightness(void);
+void led_strip_lut_get_gamma(float gamma[LED_STRIP_LUT_CHANNELS]);
+
+// Cheap enough to run from the strip interrupt on every pixel as it is sent
+void led_strip_lut_apply(uint8_t color[LED_STRIP_LUT_CHANNELS]);
+
+#endif /* _LED_STRIP_LUT_H */
@@ -0,0 +1,145 @@
+#include <profiler.h>
+#include <stm32l0xx.h>
+
+typedef struct
+{
+    void (*task)(void *);
+    void *param;
+    profiler_t *profiler;
+
+} profiler_task_t;
+
+static struct
+{
+    profiler_t profilers[PROFILER_COUNT];
+    size_t length;
+    bc_tick_t reset_tick;
+
+    profiler_task_t tasks[PROFILER_TASK_COUNT];
+    size_t tasks_length;
+
+} _profiler;
+
+static void _profiler_task(void *param);
+
+void profiler_init(void)
+{
+    memset(&_profiler, 0, sizeof(_profiler));
+
+    // TIM6 is a free running 1 MHz counter, longer intervals are taken from the tick
+    RCC->APB1ENR |= RCC_APB1ENR_TIM6EN;
+
+    TIM6->PSC = (SystemCoreClock / 1000000) - 1;
+    TIM6->ARR = 0xffff;
+    TIM6->EGR = TIM_EGR_UG;
+    TIM6->CR1 |= TIM_CR1_CEN;
+
+    _profiler.reset_tick = bc_tick_get();
+}
+
+profiler_t *profiler_register(const char *name)
+{
+    if (_profiler.length >= PROFILER_COUNT)
+    {
+        return NULL;
+    }
+
+    profiler_t *self = &_profiler.profilers[_profiler.length++];
+
+    self->name = name;
+
+    return self;
+}
+
+bc_scheduler_task_id_t profiler_task_register(const char *name, void (*task)(void *), void *param, bc_tick_t tick)
+{
+    // Without a free slot the task still runs, it is just not measured
+    if (_profiler.tasks_length >= PROFILER_TASK_COUNT)
+    {
+        return bc_scheduler_register(task, param, tick);
+    }
+
+    size_t i = _profiler.tasks_length++;
+
+    _profiler.tasks[i].task = task;
+    _profiler.tasks[i].param = param;
+    _profiler.tasks[i].profiler = profiler_register(name);
+
+    return bc_scheduler_register(_profiler_task, &_profiler.tasks[i], tick);
+}
+
+void profiler_start(profiler_t *self)
+{
+    if (self == NULL)
+    {
+        return;
+    }
+
+    self->start_tick = bc_tick_get();
+    self->start_counter = TIM6->CNT;
+}
+
+void profiler_stop(profiler_t *self)
+{
+    if (self == NULL)
+    {
+        return;
+    }
+
+    uint16_t counter = TIM6->CNT;
+    bc_tick_t ticks = bc_tick_get() - self->start_tick;
+    uint32_t elapsed;
+
+    if (ticks < 60)
+    {
+        elapsed = (uint16_t) (counter - self->start_counter);
+    }
+    else
+    {
+        elapsed = ticks * 1000;
+    }
+
+    self->count++;
+    self->total += elapsed;
+
+    if (elapsed > self->max)
+    {
+        self->max = elapsed;
+    }
+}
+
+void profiler_reset(void)
+{
+    for (size_t i = 0; i < _profiler.length; i++)
+    {
+        _profiler.profilers[i].count = 0;
+        _profiler.profilers[i].total = 0;
+        _profiler.profilers[i].max = 0;
+    }
+
+    _profiler.reset_tick = bc_tick_get();
+}
+
+profiler_t *profiler_get(size_t index)
+{
+    if (index >= _profiler.length)
+    {
+        return NULL;
+    }
+
+    return &_profiler.profilers[index];
+}
+
+bc_tick_t profiler_get_period(void)
+{
+    return bc_tick_get() - _profiler.reset_tick;
+}
+
+static void _profiler_task(void *param)
+{
+    profiler_task_t *self = (profiler_task_t *) param;
+
+    profiler_start(self->profiler);
+    self->task(self->param);
+    profiler_stop(self->profiler);
+}
@@ -0,0 +1,34 @@
+#ifndef _PROFILER_H
+#define _PROFILER_H
+
+#include <bc_common.h>
+#include <bc_tick.h>
+#include <bc_scheduler.h>
+
+#define PROFILER_COUNT 88
+#define PROFILER_TASK_COUNT 8
+
+typedef struct
+{
+    const char *name;
+    uint32_t count;
+    uint64_t total;
+    uint32_t max;
+    bc_tick_t start_tick;
+    uint16_t start_counter;
+
+} profiler_t;
+
+void profiler_init(void);
+profiler_t *profiler_register(const char *name);
+
+// Registers a scheduler task measured as a whole under its name. Tasks of the SDK (tag drivers, radio, USB CDC)
+// and the application task it calls itself are out of reach, the handlers they call in here measure themselves.
+bc_scheduler_task_id_t profiler_task_register(const char *name, void (*task)(void *), void *param, bc_tick_t tick);
+void profiler_start(profiler_t *self);
+void profiler_stop(profiler_t *self);
+void profiler_reset(void);
+profiler_t *profiler_get(size_t index);
+bc_tick_t profiler_get_period(void);
+
+#endif /* _PROFILER_H */
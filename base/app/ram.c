@@ -0,0 +1,80 @@
+#include <ram.h>
+#include <stm32l0xx.h>
+
+#define RAM_PAINT 0xc5c5c5c5
+#define RAM_PAINT_MARGIN 64
+
+// Section bounds from the linker script, data is followed by bss and the stack grows down from the end of RAM towards it
+extern uint32_t _sdata;
+extern uint32_t _sbss;
+extern uint32_t _ebss;
+extern uint32_t _estack;
+
+static struct
+{
+    ram_buffer_t buffers[RAM_BUFFER_COUNT];
+    size_t length;
+
+} _ram;
+
+void ram_init(void)
+{
+    uint32_t *top = (uint32_t *) __get_MSP() - RAM_PAINT_MARGIN / sizeof(uint32_t);
+
+    memset(&_ram, 0, sizeof(_ram));
+
+    // Everything below the current frame is unused yet, the deepest word that lost the paint marks the peak
+    for (uint32_t *word = &_ebss; word < top; word++)
+    {
+        *word = RAM_PAINT;
+    }
+}
+
+ram_buffer_t *ram_buffer_register(const char *name, size_t size)
+{
+    if (_ram.length >= RAM_BUFFER_COUNT)
+    {
+        return NULL;
+    }
+
+    ram_buffer_t *self = &_ram.buffers[_ram.length++];
+
+    self->name = name;
+    self->size = size;
+
+    return self;
+}
+
+void ram_buffer_use(ram_buffer_t *self, size_t used)
+{
+    if ((self != NULL) && (used > self->peak))
+    {
+        self->peak = used;
+    }
+}
+
+ram_buffer_t *ram_buffer_get(size_t index)
+{
+    if (index >= _ram.length)
+    {
+        return NULL;
+    }
+
+    return &_ram.buffers[index];
+}
+
+void ram_get_usage(ram_usage_t *usage)
+{
+    uint32_t *word = &_ebss;
+
+    while ((word < &_estack) && (*word == RAM_PAINT))
+    {
+        word++;
+    }
+
+    usage->total = (uintptr_t) &_estack - (uintptr_t) &_sdata;
+    usage->data = (uintptr_t) &_sbss - (uintptr_t) &_sdata;
+    usage->bss = (uintptr_t) &_ebss - (uintptr_t) &_sbss;
+    usage->stack = (uintptr_t) &_estack - (uintptr_t) &_ebss;
+    usage->stack_peak = (uintptr_t) &_estack - (uintptr_t) word;
+}
@@ -0,0 +1,32 @@
+#ifndef _RAM_H
+#define _RAM_H
+
+#include <bc_common.h>
+
+#define RAM_BUFFER_COUNT 8
+
+typedef struct
+{
+    const char *name;
+    size_t size;
+    size_t peak;
+
+} ram_buffer_t;
+
+typedef struct
+{
+    size_t total;
+    size_t data;
+    size_t bss;
+    size_t stack;
+    size_t stack_peak;
+
+} ram_usage_t;
+
+void ram_init(void);
+ram_buffer_t *ram_buffer_register(const char *name, size_t size);
+void ram_buffer_use(ram_buffer_t *self, size_t used);
+ram_buffer_t *ram_buffer_get(size_t index);
+void ram_get_usage(ram_usage_t *usage);
+
+#endif /* _RAM_H */
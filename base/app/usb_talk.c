@@ -1,7 +1,7 @@
 #include <usb_talk.h>
 #include <bc_scheduler.h>
 #include <bc_usb_cdc.h>
-#include <base64.h>
+#include <b64.h>
 #include <application.h>
 
 #define USB_TALK_TOKEN_ARRAY         0
@@ -10,53 +10,319 @@
 #define USB_TALK_TOKEN_PAYLOAD_KEY   3
 #define USB_TALK_TOKEN_PAYLOAD_VALUE 4
 
-#define USB_TALK_SUBSCRIBES 16
+#define USB_TALK_SUBSCRIBES 72
+#define USB_TALK_TOKENS 32
+#define USB_TALK_DEPTH 8
+#define USB_TALK_SNAPSHOT_SIZE 768
+#define USB_TALK_ID_SIZE 24
+#define USB_TALK_TX_TELEMETRY_SIZE 320
+#define USB_TALK_TX_BULK_SIZE 192
+#define USB_TALK_TX_ENTRY_HEADER 2
+#define USB_TALK_TX_FIFO 1024
+#define USB_TALK_TX_LEVEL 256
+#define USB_TALK_TX_RATE 64
+
+typedef enum
+{
+    USB_TALK_RX_STATE_IDLE = 0,
+    USB_TALK_RX_STATE_MESSAGE = 1,
+    USB_TALK_RX_STATE_DATA = 2,
+    USB_TALK_RX_STATE_SKIP = 3,
+    USB_TALK_RX_STATE_BATCH = 4,
+    USB_TALK_RX_STATE_END = 5,
+    USB_TALK_RX_STATE_ERROR = 6
+
+} usb_talk_rx_state_t;
+
+typedef struct
+{
+    uint8_t *buffer;
+    size_t size;
+    size_t head;
+    size_t length;
+    ram_buffer_t *ram;
+
+} usb_talk_tx_queue_t;
 
 static struct
 {
-    char tx_buffer[128];
-    char rx_buffer[1024];
-    size_t rx_length;
-    bool rx_error;
+    const char *prefix;
+    char tx_buffer[256];
+
+    struct {
+        uint8_t telemetry[USB_TALK_TX_TELEMETRY_SIZE];
+        uint8_t bulk[USB_TALK_TX_BULK_SIZE];
+        // One queue per class below control, telemetry first, so a bulk line never holds up a sensor window
+        usb_talk_tx_queue_t queue[2];
+        size_t level;
+        bc_tick_t tick;
+
+    } tx;
+
+    struct {
+        usb_talk_rx_state_t state;
+        char buffer[1024];
+        size_t length;
+        size_t line_length;
+        jsmntok_t tokens[USB_TALK_TOKENS];
+        int token_count;
+        int parent[USB_TALK_DEPTH + 1];
+        int depth;
+        int root_depth;
+        int primitive;
+        bool string;
+        bool escape;
+        bool handled;
+        size_t subscribe;
+        bool batch;
+        int batch_count;
+        int batch_handled;
+        char id[USB_TALK_ID_SIZE];
+        size_t id_length;
+        bool answered;
+        const char *nack;
+
+        struct {
+            uint32_t bits;
+            uint8_t count;
+            uint8_t padding;
+            size_t offset;
+            uint8_t buffer[48];
+            size_t length;
+            bool active;
+            bool pending;
+            bool failed;
+
+        } data;
+
+    } rx;
+
+    struct {
+        usb_talk_frame_callback_t callback;
+        void *param;
+        bool active;
+        bc_tick_t timeout;
+        bc_tick_t tick;
+        uint8_t header[USB_TALK_FRAME_HEADER_SIZE];
+        size_t header_length;
+        bool skip;
+        usb_talk_frame_t frame;
+
+    } stream;
 
     struct {
         const char *topic;
         usb_talk_sub_callback_t callback;
+        usb_talk_sub_data_callback_t data_callback;
         void *param;
+        profiler_t *profiler;
 
     } subscribes[USB_TALK_SUBSCRIBES];
     size_t subscribes_length;
 
+    bc_tick_t first_command_tick;
+
+    struct {
+        ram_buffer_t *rx;
+        ram_buffer_t *tx;
+        ram_buffer_t *snapshot;
+
+    } ram;
+
+    struct {
+        char buffer[USB_TALK_SNAPSHOT_SIZE];
+        size_t length;
+        bool truncated;
+
+    } snapshot;
+
+    struct {
+        uint32_t rx_overflow;
+        uint32_t rx_parse_error;
+        uint32_t rx_token_overflow;
+        uint32_t rx_invalid;
+        uint32_t rx_unhandled;
+        uint32_t sub_overflow;
+        uint32_t tx_truncated;
+        uint32_t tx_error;
+        uint32_t tx_shed_telemetry;
+        uint32_t tx_shed_bulk;
+        size_t rx_length_max;
+        size_t tx_length_max;
+
+    } stats;
+
 } _usb_talk;
 
 static void _usb_talk_task(void *param);
+static bool _usb_talk_tx_write(const char *buffer, size_t length);
+static size_t _usb_talk_tx_level(void);
+static bool _usb_talk_tx_is_held(usb_talk_priority_t priority);
+static bool _usb_talk_tx_enqueue(usb_talk_tx_queue_t *queue, const char *buffer, size_t length);
+static bool _usb_talk_tx_drain(usb_talk_tx_queue_t *queue);
 static void _usb_talk_process_character(char character);
-static void _usb_talk_process_message(char *message, size_t length);
-static bool _usb_talk_token_get_int(const char *buffer, jsmntok_t *token, int *value);
-
-void usb_talk_init(void)
+static void _usb_talk_rx_line_end(void);
+static void _usb_talk_rx_begin(void);
+static bool _usb_talk_rx_store(char character);
+static bool _usb_talk_rx_token(jsmntype_t type, int start);
+static void _usb_talk_rx_primitive_end(void);
+static void _usb_talk_rx_open(char character);
+static void _usb_talk_rx_close(char character);
+static void _usb_talk_rx_string_end(void);
+static void _usb_talk_rx_topic(void);
+static bool _usb_talk_rx_dispatch(void);
+static bool _usb_talk_rx_id(jsmntok_t *token);
+static void _usb_talk_rx_answer(void);
+static const char *_usb_talk_tx_tag(const char *buffer, size_t *length);
+static void _usb_talk_rx_invalid(void);
+static void _usb_talk_rx_error(void);
+static void _usb_talk_data_begin(void);
+static void _usb_talk_data_character(char character);
+static size_t _usb_talk_data_quanta(const char *input, size_t length);
+static void _usb_talk_data_end(void);
+static bool _usb_talk_data_flush(void);
+static bool _usb_talk_data_event(usb_talk_data_event_t event);
+static size_t _usb_talk_stream_receive(const uint8_t *buffer, size_t length);
+static bool _usb_talk_stream_event(usb_talk_frame_event_t event);
+static void _usb_talk_stream_end(void);
+static bool _usb_talk_token_parse_int(const char *buffer, jsmntok_t *token, int *value);
+static bool _usb_talk_token_parse_float(const char *buffer, jsmntok_t *token, float *value);
+static int _usb_talk_token_skip(usb_talk_payload_t *payload, int index);
+static bool _usb_talk_topic_match(const char *buffer, jsmntok_t *token, const char *topic);
+static uint32_t _usb_talk_hash(const char *buffer, size_t length);
+static void _usb_talk_schema_prepare(usb_talk_schema_t *schema);
+static bool _usb_talk_field_decode(usb_talk_field_t *field, const char *buffer, jsmntok_t *token, void *output);
+static void _usb_talk_send_sensor_stats(int precision, sensor_stats_t *stats);
+static void _usb_talk_send_sensor_last(int precision, sensor_stats_t *stats);
+static void _usb_talk_snapshot_add_sensor(const char *name, int precision, sensor_stats_t *stats);
+static void _usb_talk_sensor_topic(const char *prefix, const char *name, const char *suffix);
+static const char *_usb_talk_thermometer_name(uint8_t *i2c);
+static const char *_usb_talk_humidity_sensor_name(uint8_t *i2c);
+static const char *_usb_talk_lux_meter_name(uint8_t *i2c);
+static const char *_usb_talk_barometer_name(uint8_t *i2c, const char *quantity);
+
+void usb_talk_init(const char *prefix)
 {
     memset(&_usb_talk, 0, sizeof(_usb_talk));
 
+    _usb_talk.prefix = prefix;
+    _usb_talk.first_command_tick = BC_TICK_INFINITY;
+
     bc_usb_cdc_init();
 
-    bc_scheduler_register(_usb_talk_task, NULL, 0);
+    _usb_talk.ram.rx = ram_buffer_register("usb-rx", sizeof(_usb_talk.rx.buffer));
+    _usb_talk.ram.tx = ram_buffer_register("usb-tx", sizeof(_usb_talk.tx_buffer));
+    _usb_talk.ram.snapshot = ram_buffer_register("usb-snapshot", sizeof(_usb_talk.snapshot.buffer));
+
+    _usb_talk.tx.queue[0].buffer = _usb_talk.tx.telemetry;
+    _usb_talk.tx.queue[0].size = sizeof(_usb_talk.tx.telemetry);
+    _usb_talk.tx.queue[0].ram = ram_buffer_register("usb-tx-telemetry", sizeof(_usb_talk.tx.telemetry));
+    _usb_talk.tx.queue[1].buffer = _usb_talk.tx.bulk;
+    _usb_talk.tx.queue[1].size = sizeof(_usb_talk.tx.bulk);
+    _usb_talk.tx.queue[1].ram = ram_buffer_register("usb-tx-bulk", sizeof(_usb_talk.tx.bulk));
+
+    profiler_task_register("usb-talk", _usb_talk_task, NULL, 0);
 }
 
 void usb_talk_sub(const char *topic, usb_talk_sub_callback_t callback, void *param)
 {
     if (_usb_talk.subscribes_length >= USB_TALK_SUBSCRIBES){
+        _usb_talk.stats.sub_overflow++;
         return;
     }
     _usb_talk.subscribes[_usb_talk.subscribes_length].topic = topic;
     _usb_talk.subscribes[_usb_talk.subscribes_length].callback = callback;
     _usb_talk.subscribes[_usb_talk.subscribes_length].param = param;
+    _usb_talk.subscribes[_usb_talk.subscribes_length].profiler = profiler_register(topic);
+    _usb_talk.subscribes_length++;
+}
+
+void usb_talk_sub_data(const char *topic, usb_talk_sub_data_callback_t callback, void *param)
+{
+    if (_usb_talk.subscribes_length >= USB_TALK_SUBSCRIBES){
+        _usb_talk.stats.sub_overflow++;
+        return;
+    }
+    _usb_talk.subscribes[_usb_talk.subscribes_length].topic = topic;
+    _usb_talk.subscribes[_usb_talk.subscribes_length].data_callback = callback;
+    _usb_talk.subscribes[_usb_talk.subscribes_length].param = param;
+    _usb_talk.subscribes[_usb_talk.subscribes_length].profiler = profiler_register(topic);
     _usb_talk.subscribes_length++;
 }
 
+void usb_talk_stream_start(usb_talk_frame_callback_t callback, void *param, bc_tick_t timeout)
+{
+    // Binary frames follow the line that started the stream, the switch happens at its end
+    _usb_talk.stream.callback = callback;
+    _usb_talk.stream.param = param;
+    _usb_talk.stream.timeout = timeout;
+}
+
 void usb_talk_send_string(const char *buffer)
 {
-    bc_usb_cdc_write(buffer, strlen(buffer));
+    usb_talk_send_string_priority(buffer, USB_TALK_PRIORITY_CONTROL);
+}
+
+void usb_talk_send_string_priority(const char *buffer, usb_talk_priority_t priority)
+{
+    size_t length = strlen(buffer);
+
+    if (buffer == _usb_talk.tx_buffer)
+    {
+        ram_buffer_use(_usb_talk.ram.tx, length + 1);
+    }
+    else if (buffer == _usb_talk.snapshot.buffer)
+    {
+        ram_buffer_use(_usb_talk.ram.snapshot, length + 1);
+    }
+
+    // Formatted lines cut by snprintf miss the terminating newline, never send them half
+    if ((length == 0) || (buffer[length - 1] != '\n'))
+    {
+        _usb_talk.stats.tx_truncated++;
+        return;
+    }
+
+    if ((_usb_talk.rx.id_length != 0) && (priority == USB_TALK_PRIORITY_CONTROL))
+    {
+        buffer = _usb_talk_tx_tag(buffer, &length);
+    }
+
+    if (length > _usb_talk.stats.tx_length_max)
+    {
+        _usb_talk.stats.tx_length_max = length;
+    }
+
+    // Control goes out at once, the rest only while little is waiting in the CDC ahead of a possible reply
+    if ((priority == USB_TALK_PRIORITY_CONTROL) ||
+        (!_usb_talk_tx_is_held(priority) && (_usb_talk_tx_level() + length <= USB_TALK_TX_LEVEL)))
+    {
+        _usb_talk_tx_write(buffer, length);
+
+        return;
+    }
+
+    if (!_usb_talk_tx_enqueue(&_usb_talk.tx.queue[priority - USB_TALK_PRIORITY_TELEMETRY], buffer, length))
+    {
+        if (priority == USB_TALK_PRIORITY_TELEMETRY)
+        {
+            _usb_talk.stats.tx_shed_telemetry++;
+        }
+        else
+        {
+            _usb_talk.stats.tx_shed_bulk++;
+        }
+    }
+}
+
+void usb_talk_nack(const char *error)
+{
+    _usb_talk.rx.nack = error;
+}
+
+void usb_talk_stats_reset(void)
+{
+    memset(&_usb_talk.stats, 0, sizeof(_usb_talk.stats));
 }
 
 void usb_talk_publish_led(const char *prefix, bool *state)
@@ -77,79 +343,169 @@ void usb_talk_publish_push_button(const char *prefix, uint16_t *event_count)
     usb_talk_send_string((const char *) _usb_talk.tx_buffer);
 }
 
-void usb_talk_publish_thermometer(const char *prefix, uint8_t *i2c, float *temperature)
+void usb_talk_publish_thermometer(const char *prefix, uint8_t *i2c, sensor_stats_t *temperature)
 {
+    _usb_talk_sensor_topic(prefix, _usb_talk_thermometer_name(i2c), "\", ");
 
-    uint8_t number = (*i2c & ~0x80) == BC_TAG_TEMPERATURE_I2C_ADDRESS_DEFAULT ? 0 : 1;
+    _usb_talk_send_sensor_stats(2, temperature);
+}
 
-    snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer),
-                "[\"%s/thermometer/%d:%d/temperature\", %0.2f]\n",
-                prefix, ((*i2c & 0x80) >> 7), number, *temperature);
+void usb_talk_publish_humidity_sensor(const char *prefix, uint8_t *i2c, sensor_stats_t *relative_humidity)
+{
+    _usb_talk_sensor_topic(prefix, _usb_talk_humidity_sensor_name(i2c), "\", ");
 
-    usb_talk_send_string((const char *) _usb_talk.tx_buffer);
+    _usb_talk_send_sensor_stats(1, relative_humidity);
 }
 
-void usb_talk_publish_humidity_sensor(const char *prefix, uint8_t *i2c, float *relative_humidity)
+void usb_talk_publish_lux_meter(const char *prefix, uint8_t *i2c, sensor_stats_t *illuminance)
 {
+    _usb_talk_sensor_topic(prefix, _usb_talk_lux_meter_name(i2c), "\", ");
 
-    uint8_t number;
+    _usb_talk_send_sensor_stats(1, illuminance);
+}
 
-    switch((*i2c & ~0x80))
-    {
-        case 0x5f:
-            number = 0;
-            break;
-        case 0x40:
-            number = 2;
-            break;
-        case 0x41:
-            number = 3;
-            break;
-        default:
-            number = 0;
-    }
+void usb_talk_publish_barometer(const char *prefix, uint8_t *i2c, sensor_stats_t *pressure, sensor_stats_t *altitude)
+{
+    _usb_talk_sensor_topic(prefix, _usb_talk_barometer_name(i2c, "pressure"), "\", ");
+
+    _usb_talk_send_sensor_stats(2, pressure);
+
+    _usb_talk_sensor_topic(prefix, _usb_talk_barometer_name(i2c, "altitude"), "\", ");
+
+    _usb_talk_send_sensor_stats(2, altitude);
+}
 
+void usb_talk_publish_co2_concentation(const char *prefix, sensor_stats_t *concentration)
+{
     snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer),
-                "[\"%s/hygrometer/%d:%d/relative-humidity\", %0.1f]\n",
-                prefix, ((*i2c & 0x80) >> 7), number, *relative_humidity);
+                "[\"%s/co2-meter/-/concentration\", ",
+                prefix);
 
-    usb_talk_send_string((const char *) _usb_talk.tx_buffer);
+    _usb_talk_send_sensor_stats(0, concentration);
 }
 
-void usb_talk_publish_lux_meter(const char *prefix, uint8_t *i2c, float *illuminance)
+void usb_talk_publish_thermometer_last(const char *prefix, uint8_t *i2c, sensor_stats_t *temperature)
 {
+    _usb_talk_sensor_topic(prefix, _usb_talk_thermometer_name(i2c), "/last\", ");
 
-    uint8_t number = (*i2c & ~0x80) == BC_TAG_LUX_METER_I2C_ADDRESS_DEFAULT ? 0 : 1;
+    _usb_talk_send_sensor_last(2, temperature);
+}
 
-    snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer),
-                "[\"%s/lux-meter/%d:%d/illuminance\", %0.1f]\n",
-                prefix, ((*i2c & 0x80) >> 7), number, *illuminance);
+void usb_talk_publish_humidity_sensor_last(const char *prefix, uint8_t *i2c, sensor_stats_t *relative_humidity)
+{
+    _usb_talk_sensor_topic(prefix, _usb_talk_humidity_sensor_name(i2c), "/last\", ");
 
-    usb_talk_send_string((const char *) _usb_talk.tx_buffer);
+    _usb_talk_send_sensor_last(1, relative_humidity);
 }
 
-void usb_talk_publish_barometer(const char *prefix, uint8_t *i2c, float *pressure, float *altitude)
+void usb_talk_publish_lux_meter_last(const char *prefix, uint8_t *i2c, sensor_stats_t *illuminance)
 {
-    snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer),
-                "[\"%s/barometer/%d:0/pressure\", %0.2f]\n",
-                prefix, ((*i2c & 0x80) >> 7), *pressure);
+    _usb_talk_sensor_topic(prefix, _usb_talk_lux_meter_name(i2c), "/last\", ");
 
-    usb_talk_send_string((const char *) _usb_talk.tx_buffer);
+    _usb_talk_send_sensor_last(1, illuminance);
+}
 
-    snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer),
-                "[\"%s/barometer/%d:0/altitude\", %0.2f]\n",
-                prefix, ((*i2c & 0x80) >> 7), *altitude);
+void usb_talk_publish_barometer_last(const char *prefix, uint8_t *i2c, sensor_stats_t *pressure, sensor_stats_t *altitude)
+{
+    _usb_talk_sensor_topic(prefix, _usb_talk_barometer_name(i2c, "pressure"), "/last\", ");
 
-    usb_talk_send_string((const char *) _usb_talk.tx_buffer);
+    _usb_talk_send_sensor_last(2, pressure);
+
+    _usb_talk_sensor_topic(prefix, _usb_talk_barometer_name(i2c, "altitude"), "/last\", ");
+
+    _usb_talk_send_sensor_last(2, altitude);
 }
 
-void usb_talk_publish_co2_concentation(const char *prefix, float *concentration)
+void usb_talk_publish_co2_concentation_last(const char *prefix, sensor_stats_t *concentration)
 {
     snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer),
-                "[\"%s/co2-meter/-/concentration\", %.0f]\n",
-                prefix, *concentration);
+                "[\"%s/co2-meter/-/concentration/last\", ",
+                prefix);
 
-    usb_talk_send_string((const char *) _usb_talk.tx_buffer);
+    _usb_talk_send_sensor_last(0, concentration);
+}
+
+void usb_talk_snapshot_begin(const char *prefix)
+{
+    _usb_talk.snapshot.length = snprintf(_usb_talk.snapshot.buffer, sizeof(_usb_talk.snapshot.buffer),
+                                         "[\"%s/state/-/snapshot\", {", prefix);
+    _usb_talk.snapshot.truncated = false;
+}
+
+void usb_talk_snapshot_add(const char *format, ...)
+{
+    // Room for the separator before, the closing tail and a request id after the member
+    size_t reserve = sizeof(", \"truncated\": true}]\n") + 2 + USB_TALK_ID_SIZE;
+    size_t length = _usb_talk.snapshot.length;
+    va_list vl;
+
+    if (length + 2 + reserve >= sizeof(_usb_talk.snapshot.buffer))
+    {
+        _usb_talk.snapshot.truncated = true;
+        return;
+    }
+
+    if (_usb_talk.snapshot.buffer[length - 1] != '{')
+    {
+        _usb_talk.snapshot.buffer[length++] = ',';
+        _usb_talk.snapshot.buffer[length++] = ' ';
+    }
+
+    va_start(vl, format);
+    int written = vsnprintf(_usb_talk.snapshot.buffer + length, sizeof(_usb_talk.snapshot.buffer) - length, format, vl);
+    va_end(vl);
+
+    // A member that does not fit is left out whole, the document stays valid
+    if ((written < 0) || (length + written + reserve >= sizeof(_usb_talk.snapshot.buffer)))
+    {
+        _usb_talk.snapshot.buffer[_usb_talk.snapshot.length] = '\0';
+        _usb_talk.snapshot.truncated = true;
+        return;
+    }
+
+    _usb_talk.snapshot.length = length + written;
+}
+
+void usb_talk_snapshot_add_thermometer(uint8_t *i2c, sensor_stats_t *temperature)
+{
+    _usb_talk_snapshot_add_sensor(_usb_talk_thermometer_name(i2c), 2, temperature);
+}
+
+void usb_talk_snapshot_add_humidity_sensor(uint8_t *i2c, sensor_stats_t *relative_humidity)
+{
+    _usb_talk_snapshot_add_sensor(_usb_talk_humidity_sensor_name(i2c), 1, relative_humidity);
+}
+
+void usb_talk_snapshot_add_lux_meter(uint8_t *i2c, sensor_stats_t *illuminance)
+{
+    _usb_talk_snapshot_add_sensor(_usb_talk_lux_meter_name(i2c), 1, illuminance);
+}
+
+void usb_talk_snapshot_add_barometer(uint8_t *i2c, sensor_stats_t *pressure, sensor_stats_t *altitude)
+{
+    _usb_talk_snapshot_add_sensor(_usb_talk_barometer_name(i2c, "pressure"), 2, pressure);
+    _usb_talk_snapshot_add_sensor(_usb_talk_barometer_name(i2c, "altitude"), 2, altitude);
+}
+
+void usb_talk_snapshot_add_co2_concentation(sensor_stats_t *concentration)
+{
+    _usb_talk_snapshot_add_sensor("co2-meter/-/concentration", 0, concentration);
+}
+
+void usb_talk_snapshot_end(void)
+{
+    size_t length = _usb_talk.snapshot.length;
+
+    if (_usb_talk.snapshot.truncated)
+    {
+        // When not even the first member fit the flag is the only one and takes no separator
+        length += snprintf(_usb_talk.snapshot.buffer + length, sizeof(_usb_talk.snapshot.buffer) - length,
+                           "%s\"truncated\": true", _usb_talk.snapshot.buffer[length - 1] == '{' ? "" : ", ");
+    }
+
+    snprintf(_usb_talk.snapshot.buffer + length, sizeof(_usb_talk.snapshot.buffer) - length, "}]\n");
+
+    usb_talk_send_string((const char *) _usb_talk.snapshot.buffer);
 }
 
 void usb_talk_publish_light(const char *prefix, bool *state)
@@ -197,6 +553,42 @@ void usb_talk_publish_led_strip_config(const char *prefix, const char *mode, int
     usb_talk_send_string((const char *) _usb_talk.tx_buffer);
 }
 
+void usb_talk_publish_led_strip_brightness(const char *prefix, int *brightness, float *gamma)
+{
+    snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer),
+             "[\"%s/led-strip/-/brightness\", {\"brightness\": %d, \"gamma-red\": %.2f, \"gamma-green\": %.2f, \"gamma-blue\": %.2f, \"gamma-white\": %.2f}]\n",
+             prefix, *brightness, gamma[0], gamma[1], gamma[2], gamma[3]);
+
+    usb_talk_send_string((const char *) _usb_talk.tx_buffer);
+}
+
+void usb_talk_publish_led_strip_segment(const char *prefix, int *id, int *offset, int *count, int *brightness, const char *effect, int *wait)
+{
+    snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer),
+             "[\"%s/led-strip/%d/config\", {\"offset\": %d, \"count\": %d, \"brightness\": %d, \"effect\": \"%s\", \"wait\": %d}]\n",
+             prefix, *id, *offset, *count, *brightness, effect, *wait);
+
+    usb_talk_send_string((const char *) _usb_talk.tx_buffer);
+}
+
+void usb_talk_publish_led_strip_segment_framebuffer(const char *prefix, int *id)
+{
+    snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer),
+             "[\"%s/led-strip/%d/framebuffer/set/ok\", null]\n",
+             prefix, *id);
+
+    usb_talk_send_string((const char *) _usb_talk.tx_buffer);
+}
+
+void usb_talk_publish_led_strip_stream(const char *prefix, float *fps, uint32_t *received, uint32_t *shown, uint32_t *late, uint32_t *dropped)
+{
+    snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer),
+             "[\"%s/led-strip/-/stream\", {\"fps\": %.1f, \"received\": %" PRIu32 ", \"shown\": %" PRIu32 ", \"late\": %" PRIu32 ", \"dropped\": %" PRIu32 "}]\n",
+             prefix, *fps, *received, *shown, *late, *dropped);
+
+    usb_talk_send_string_priority((const char *) _usb_talk.tx_buffer, USB_TALK_PRIORITY_TELEMETRY);
+}
+
 void usb_talk_publish_encoder(const char *prefix, int *increment)
 {
     snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer),
@@ -206,96 +598,1245 @@ void usb_talk_publish_encoder(const char *prefix, int *increment)
     usb_talk_send_string((const char *) _usb_talk.tx_buffer);
 }
 
-static void _usb_talk_task(void *param)
+void usb_talk_publish_sensor_config(const char *prefix, const char *sensor, uint32_t *sample_interval, uint32_t *update_interval,
+                                    const char *filter, uint32_t *oversample, float *alpha, float *limit)
 {
-    (void) param;
+    snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer),
+             "[\"%s/%s/-/config\", {\"sample-interval\": %" PRIu32 ", \"update-interval\": %" PRIu32 ", "
+             "\"filter\": \"%s\", \"oversample\": %" PRIu32 ", \"alpha\": %.2f, \"limit\": %.1f}]\n",
+             prefix, sensor, *sample_interval, *update_interval, filter, *oversample, *alpha, *limit);
 
-    while (true)
-    {
-        static uint8_t buffer[16];
+    usb_talk_send_string((const char *) _usb_talk.tx_buffer);
+}
 
-        size_t length = bc_usb_cdc_read(buffer, sizeof(buffer));
+void usb_talk_publish_lcd_config(const char *prefix, uint32_t *page_interval)
+{
+    snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer),
+             "[\"%s/lcd/-/config\", {\"page-interval\": %" PRIu32 "}]\n",
+             prefix, *page_interval);
 
-        if (length == 0)
-        {
-            break;
-        }
+    usb_talk_send_string((const char *) _usb_talk.tx_buffer);
+}
 
-        for (size_t i = 0; i < length; i++)
-        {
-            _usb_talk_process_character((char) buffer[i]);
-        }
-    }
+void usb_talk_publish_profiler(const char *prefix, profiler_t *profiler, bc_tick_t *period)
+{
+    snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer),
+             "[\"%s/stats/-/cpu\", {\"name\": \"%s\", \"count\": %" PRIu32 ", \"total-ms\": %" PRIu32 ", \"max-us\": %" PRIu32 ", \"period-ms\": %" PRIu32 "}]\n",
+             prefix, profiler->name, profiler->count, (uint32_t) (profiler->total / 1000), profiler->max, (uint32_t) *period);
 
-    bc_scheduler_plan_current_now();
+    usb_talk_send_string_priority((const char *) _usb_talk.tx_buffer, USB_TALK_PRIORITY_BULK);
 }
 
-static void _usb_talk_process_character(char character)
+void usb_talk_publish_stats(const char *prefix)
 {
-    if (character == '\n')
-    {
-        if (!_usb_talk.rx_error && _usb_talk.rx_length > 0)
-        {
-            _usb_talk_process_message(_usb_talk.rx_buffer, _usb_talk.rx_length);
-        }
+    snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer),
+             "[\"%s/stats/-/usb-rx\", {\"overflow\": %" PRIu32 ", \"parse-error\": %" PRIu32 ", \"token-overflow\": %" PRIu32
+             ", \"invalid\": %" PRIu32 ", \"unhandled\": %" PRIu32 ", \"sub-overflow\": %" PRIu32 ", \"length-max\": %u}]\n",
+             prefix, _usb_talk.stats.rx_overflow, _usb_talk.stats.rx_parse_error, _usb_talk.stats.rx_token_overflow,
+             _usb_talk.stats.rx_invalid, _usb_talk.stats.rx_unhandled, _usb_talk.stats.sub_overflow,
+             (unsigned int) _usb_talk.stats.rx_length_max);
 
-        _usb_talk.rx_length = 0;
-        _usb_talk.rx_error = false;
+    usb_talk_send_string((const char *) _usb_talk.tx_buffer);
 
-        return;
-    }
+    snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer),
+             "[\"%s/stats/-/usb-tx\", {\"truncated\": %" PRIu32 ", \"error\": %" PRIu32 ", \"shed-telemetry\": %" PRIu32
+             ", \"shed-bulk\": %" PRIu32 ", \"length-max\": %u}]\n",
+             prefix, _usb_talk.stats.tx_truncated, _usb_talk.stats.tx_error, _usb_talk.stats.tx_shed_telemetry,
+             _usb_talk.stats.tx_shed_bulk, (unsigned int) _usb_talk.stats.tx_length_max);
+
+    usb_talk_send_string((const char *) _usb_talk.tx_buffer);
+}
+
+void usb_talk_publish_ram(const char *prefix, ram_usage_t *usage)
+{
+    snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer),
+             "[\"%s/stats/-/ram\", {\"total\": %u, \"data\": %u, \"bss\": %u, \"stack\": %u, \"stack-peak\": %u, \"free\": %u}]\n",
+             prefix, (unsigned int) usage->total, (unsigned int) usage->data, (unsigned int) usage->bss,
+             (unsigned int) usage->stack, (unsigned int) usage->stack_peak, (unsigned int) (usage->stack - usage->stack_peak));
+
+    usb_talk_send_string((const char *) _usb_talk.tx_buffer);
+}
+
+void usb_talk_publish_ram_buffer(const char *prefix, ram_buffer_t *buffer)
+{
+    snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer),
+             "[\"%s/stats/-/ram-buffer\", {\"name\": \"%s\", \"size\": %u, \"peak\": %u}]\n",
+             prefix, buffer->name, (unsigned int) buffer->size, (unsigned int) buffer->peak);
+
+    usb_talk_send_string_priority((const char *) _usb_talk.tx_buffer, USB_TALK_PRIORITY_BULK);
+}
+
+void usb_talk_publish_boot(const char *prefix, const char **names, profiler_t *phases, size_t count, bc_tick_t *ready)
+{
+    size_t length = snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer), "[\"%s/stats/-/boot\", {", prefix);
 
-    if (_usb_talk.rx_length == sizeof(_usb_talk.rx_buffer))
+    for (size_t i = 0; (i < count) && (length < sizeof(_usb_talk.tx_buffer)); i++)
     {
-        _usb_talk.rx_error = true;
+        length += snprintf(_usb_talk.tx_buffer + length, sizeof(_usb_talk.tx_buffer) - length,
+                           "\"%s-us\": %" PRIu32 ", ", names[i], (uint32_t) phases[i].total);
     }
-    else
+
+    if (length < sizeof(_usb_talk.tx_buffer))
     {
-        if (!_usb_talk.rx_error)
+        if (_usb_talk.first_command_tick == BC_TICK_INFINITY)
+        {
+            snprintf(_usb_talk.tx_buffer + length, sizeof(_usb_talk.tx_buffer) - length,
+                     "\"ready-ms\": %" PRIu32 ", \"first-command-ms\": null}]\n", (uint32_t) *ready);
+        }
+        else
         {
-            _usb_talk.rx_buffer[_usb_talk.rx_length++] = character;
+            snprintf(_usb_talk.tx_buffer + length, sizeof(_usb_talk.tx_buffer) - length,
+                     "\"ready-ms\": %" PRIu32 ", \"first-command-ms\": %" PRIu32 "}]\n", (uint32_t) *ready,
+                     (uint32_t) _usb_talk.first_command_tick);
         }
     }
+
+    usb_talk_send_string((const char *) _usb_talk.tx_buffer);
 }
 
-static void _usb_talk_process_message(char *message, size_t length)
+static void _usb_talk_send_sensor_stats(int precision, sensor_stats_t *stats)
 {
-    static jsmn_parser parser;
-    static jsmntok_t tokens[16];
+    size_t length = strlen(_usb_talk.tx_buffer);
+
+    snprintf(_usb_talk.tx_buffer + length, sizeof(_usb_talk.tx_buffer) - length,
+                "{\"min\": %.*f, \"max\": %.*f, \"mean\": %.*f, \"count\": %" PRIu16 "}]\n",
+                precision, stats->min, precision, stats->max,
+                precision, sensor_stats_get_mean(stats), stats->count);
 
-    jsmn_init(&parser);
+    usb_talk_send_string_priority((const char *) _usb_talk.tx_buffer, USB_TALK_PRIORITY_TELEMETRY);
+}
 
-    int token_count = jsmn_parse(&parser, (const char *) message, length, tokens, sizeof(tokens));
+static void _usb_talk_send_sensor_last(int precision, sensor_stats_t *stats)
+{
+    size_t length = strlen(_usb_talk.tx_buffer);
+    float value;
+    bc_tick_t age;
 
-    if (token_count < 3)
+    if (!sensor_stats_get_last(stats, &value, &age))
     {
         return;
     }
 
-    if (tokens[USB_TALK_TOKEN_ARRAY].type != JSMN_ARRAY || tokens[USB_TALK_TOKEN_ARRAY].size != 2)
-    {
-        return;
-    }
+    snprintf(_usb_talk.tx_buffer + length, sizeof(_usb_talk.tx_buffer) - length,
+                "{\"value\": %.*f, \"age-ms\": %" PRIu32 "}]\n",
+                precision, value, (uint32_t) age);
 
-    if (tokens[USB_TALK_TOKEN_TOPIC].type != JSMN_STRING || tokens[USB_TALK_TOKEN_TOPIC].size != 0)
-    {
-        return;
-    }
+    usb_talk_send_string((const char *) _usb_talk.tx_buffer);
+}
 
-    for (size_t i = 0; i < _usb_talk.subscribes_length; i++)
+static void _usb_talk_snapshot_add_sensor(const char *name, int precision, sensor_stats_t *stats)
+{
+    float value;
+    bc_tick_t age;
+
+    if (sensor_stats_get_last(stats, &value, &age))
     {
-        if (usb_talk_is_string_token_equal(message, &tokens[USB_TALK_TOKEN_TOPIC], _usb_talk.subscribes[i].topic))
-        {
-            usb_talk_payload_t payload = {
-                    message,
-                    token_count - USB_TALK_TOKEN_PAYLOAD,
-                    tokens + USB_TALK_TOKEN_PAYLOAD
-            };
-            _usb_talk.subscribes[i].callback(&payload, _usb_talk.subscribes[i].param);
-        }
+        usb_talk_snapshot_add("\"%s\": %.*f", name, precision, value);
     }
 }
 
+static void _usb_talk_sensor_topic(const char *prefix, const char *name, const char *suffix)
+{
+    snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer), "[\"%s/%s%s", prefix, name, suffix);
+}
+
+static const char *_usb_talk_thermometer_name(uint8_t *i2c)
+{
+    static char name[32];
+    uint8_t number = (*i2c & ~0x80) == BC_TAG_TEMPERATURE_I2C_ADDRESS_DEFAULT ? 0 : 1;
+
+    snprintf(name, sizeof(name), "thermometer/%d:%d/temperature", ((*i2c & 0x80) >> 7), number);
+
+    return name;
+}
+
+static const char *_usb_talk_humidity_sensor_name(uint8_t *i2c)
+{
+    static char name[40];
+    uint8_t number;
+
+    switch((*i2c & ~0x80))
+    {
+        case 0x5f:
+            number = 0;
+            break;
+        case 0x40:
+            number = 2;
+            break;
+        case 0x41:
+            number = 3;
+            break;
+        default:
+            number = 0;
+    }
+
+    snprintf(name, sizeof(name), "hygrometer/%d:%d/relative-humidity", ((*i2c & 0x80) >> 7), number);
+
+    return name;
+}
+
+static const char *_usb_talk_lux_meter_name(uint8_t *i2c)
+{
+    static char name[32];
+    uint8_t number = (*i2c & ~0x80) == BC_TAG_LUX_METER_I2C_ADDRESS_DEFAULT ? 0 : 1;
+
+    snprintf(name, sizeof(name), "lux-meter/%d:%d/illuminance", ((*i2c & 0x80) >> 7), number);
+
+    return name;
+}
+
+static const char *_usb_talk_barometer_name(uint8_t *i2c, const char *quantity)
+{
+    static char name[32];
+
+    snprintf(name, sizeof(name), "barometer/%d:0/%s", ((*i2c & 0x80) >> 7), quantity);
+
+    return name;
+}
+
+static void _usb_talk_task(void *param)
+{
+    (void) param;
+
+    while (true)
+    {
+        static char buffer[64];
+
+        size_t length = bc_usb_cdc_read(buffer, sizeof(buffer));
+
+        if (length == 0)
+        {
+            if (_usb_talk.stream.active && (bc_tick_get() - _usb_talk.stream.tick > _usb_talk.stream.timeout))
+            {
+                _usb_talk_stream_end();
+            }
+
+            break;
+        }
+
+        for (size_t i = 0; i < length;)
+        {
+            if (_usb_talk.stream.active)
+            {
+                i += _usb_talk_stream_receive((const uint8_t *) &buffer[i], length - i);
+
+                continue;
+            }
+
+            size_t used = _usb_talk_data_quanta(&buffer[i], length - i);
+
+            if (used == 0)
+            {
+                _usb_talk_process_character(buffer[i]);
+
+                used = 1;
+            }
+
+            i += used;
+        }
+    }
+
+    // Bulk goes only once all telemetry is out
+    if (_usb_talk_tx_drain(&_usb_talk.tx.queue[0]))
+    {
+        _usb_talk_tx_drain(&_usb_talk.tx.queue[1]);
+    }
+
+    bc_scheduler_plan_current_now();
+}
+
+static bool _usb_talk_tx_write(const char *buffer, size_t length)
+{
+    _usb_talk_tx_level();
+
+    if (!bc_usb_cdc_write(buffer, length))
+    {
+        // The host is not draining, assume the CDC is full until the estimate runs down again
+        _usb_talk.stats.tx_error++;
+        _usb_talk.tx.level = USB_TALK_TX_FIFO;
+
+        return false;
+    }
+
+    _usb_talk.tx.level += length;
+
+    return true;
+}
+
+// Estimated bytes still in the CDC transmit FIFO, the host takes at least USB_TALK_TX_RATE bytes per tick
+static size_t _usb_talk_tx_level(void)
+{
+    bc_tick_t now = bc_tick_get();
+    size_t drained = (size_t) (now - _usb_talk.tx.tick) * USB_TALK_TX_RATE;
+
+    _usb_talk.tx.level = drained < _usb_talk.tx.level ? _usb_talk.tx.level - drained : 0;
+    _usb_talk.tx.tick = now;
+
+    return _usb_talk.tx.level;
+}
+
+// A line waits behind anything queued of its own class or a higher one
+static bool _usb_talk_tx_is_held(usb_talk_priority_t priority)
+{
+    for (int i = USB_TALK_PRIORITY_TELEMETRY; i <= (int) priority; i++)
+    {
+        if (_usb_talk.tx.queue[i - USB_TALK_PRIORITY_TELEMETRY].length != 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool _usb_talk_tx_enqueue(usb_talk_tx_queue_t *queue, const char *buffer, size_t length)
+{
+    size_t tail = queue->head + queue->length;
+    uint8_t header[USB_TALK_TX_ENTRY_HEADER] = { length & 0xff, length >> 8 };
+
+    // Bulk has the smaller queue, so it is the first to go when the host stops reading
+    if ((length >= sizeof(_usb_talk.tx_buffer)) || (queue->length + USB_TALK_TX_ENTRY_HEADER + length > queue->size))
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < USB_TALK_TX_ENTRY_HEADER + length; i++)
+    {
+        queue->buffer[(tail + i) % queue->size] = i < USB_TALK_TX_ENTRY_HEADER ? header[i] : buffer[i - USB_TALK_TX_ENTRY_HEADER];
+    }
+
+    queue->length += USB_TALK_TX_ENTRY_HEADER + length;
+
+    ram_buffer_use(queue->ram, queue->length);
+
+    return true;
+}
+
+// Returns true once the queue is empty
+static bool _usb_talk_tx_drain(usb_talk_tx_queue_t *queue)
+{
+    while (queue->length != 0)
+    {
+        size_t length = queue->buffer[queue->head] | (queue->buffer[(queue->head + 1) % queue->size] << 8);
+
+        if (_usb_talk_tx_level() + length > USB_TALK_TX_LEVEL)
+        {
+            return false;
+        }
+
+        // Entries may wrap around the end of the queue, the line buffer is free between publishes
+        for (size_t i = 0; i < length; i++)
+        {
+            _usb_talk.tx_buffer[i] = queue->buffer[(queue->head + USB_TALK_TX_ENTRY_HEADER + i) % queue->size];
+        }
+
+        if (!_usb_talk_tx_write(_usb_talk.tx_buffer, length))
+        {
+            return false;
+        }
+
+        queue->head = (queue->head + USB_TALK_TX_ENTRY_HEADER + length) % queue->size;
+        queue->length -= USB_TALK_TX_ENTRY_HEADER + length;
+    }
+
+    return true;
+}
+
+static void _usb_talk_process_character(char character)
+{
+    if (character == '\n')
+    {
+        _usb_talk_rx_line_end();
+
+        return;
+    }
+
+    _usb_talk.rx.line_length++;
+
+    if ((_usb_talk.rx.state == USB_TALK_RX_STATE_END) || (_usb_talk.rx.state == USB_TALK_RX_STATE_ERROR))
+    {
+        return;
+    }
+
+    if (_usb_talk.rx.string)
+    {
+        if (_usb_talk.rx.escape)
+        {
+            _usb_talk.rx.escape = false;
+        }
+        else if (character == '\\')
+        {
+            _usb_talk.rx.escape = true;
+        }
+        else if (character == '"')
+        {
+            _usb_talk.rx.string = false;
+
+            _usb_talk_rx_string_end();
+
+            return;
+        }
+
+        if (_usb_talk.rx.state == USB_TALK_RX_STATE_MESSAGE)
+        {
+            _usb_talk_rx_store(character);
+        }
+        else if (_usb_talk.rx.state == USB_TALK_RX_STATE_DATA)
+        {
+            _usb_talk_data_character(character);
+        }
+
+        return;
+    }
+
+    switch (character)
+    {
+        case '[':
+        case '{':
+        {
+            _usb_talk_rx_open(character);
+            break;
+        }
+        case ']':
+        case '}':
+        {
+            _usb_talk_rx_close(character);
+            break;
+        }
+        case '"':
+        {
+            if (_usb_talk.rx.depth == 0 || _usb_talk.rx.state == USB_TALK_RX_STATE_BATCH)
+            {
+                _usb_talk_rx_error();
+                break;
+            }
+
+            if (_usb_talk.rx.state == USB_TALK_RX_STATE_MESSAGE)
+            {
+                _usb_talk_rx_primitive_end();
+
+                if (_usb_talk_rx_token(JSMN_STRING, _usb_talk.rx.length + 1))
+                {
+                    _usb_talk_rx_store(character);
+                }
+            }
+            else if (_usb_talk.rx.state == USB_TALK_RX_STATE_DATA)
+            {
+                if (_usb_talk.rx.depth != _usb_talk.rx.root_depth)
+                {
+                    _usb_talk.stats.rx_invalid++;
+                    _usb_talk.rx.state = USB_TALK_RX_STATE_SKIP;
+                }
+                else
+                {
+                    _usb_talk_data_begin();
+                }
+            }
+
+            _usb_talk.rx.string = true;
+
+            break;
+        }
+        case ' ':
+        case '\t':
+        case '\r':
+        case ',':
+        case ':':
+        {
+            if (_usb_talk.rx.state == USB_TALK_RX_STATE_MESSAGE)
+            {
+                _usb_talk_rx_primitive_end();
+                _usb_talk_rx_store(character);
+            }
+            break;
+        }
+        default:
+        {
+            if (_usb_talk.rx.depth == 0 || _usb_talk.rx.state == USB_TALK_RX_STATE_BATCH)
+            {
+                _usb_talk_rx_error();
+                break;
+            }
+
+            if (_usb_talk.rx.state == USB_TALK_RX_STATE_MESSAGE)
+            {
+                if (_usb_talk.rx.primitive < 0)
+                {
+                    if (!_usb_talk_rx_token(JSMN_PRIMITIVE, _usb_talk.rx.length))
+                    {
+                        break;
+                    }
+
+                    _usb_talk.rx.primitive = _usb_talk.rx.token_count - 1;
+                }
+
+                _usb_talk_rx_store(character);
+            }
+            else if (_usb_talk.rx.state == USB_TALK_RX_STATE_DATA)
+            {
+                _usb_talk.stats.rx_invalid++;
+                _usb_talk.rx.state = USB_TALK_RX_STATE_SKIP;
+            }
+            break;
+        }
+    }
+}
+
+static void _usb_talk_rx_line_end(void)
+{
+    if (_usb_talk.rx.line_length > _usb_talk.stats.rx_length_max)
+    {
+        _usb_talk.stats.rx_length_max = _usb_talk.rx.line_length;
+    }
+
+    ram_buffer_use(_usb_talk.ram.rx, _usb_talk.rx.length);
+
+    if (((_usb_talk.rx.state == USB_TALK_RX_STATE_DATA) && _usb_talk.rx.string) || _usb_talk.rx.data.pending)
+    {
+        _usb_talk_data_event(USB_TALK_DATA_EVENT_ERROR);
+    }
+
+    if ((_usb_talk.rx.state != USB_TALK_RX_STATE_ERROR) && (_usb_talk.rx.depth > 0))
+    {
+        _usb_talk.stats.rx_parse_error++;
+    }
+
+    _usb_talk.rx.state = USB_TALK_RX_STATE_IDLE;
+    _usb_talk.rx.line_length = 0;
+    _usb_talk.rx.depth = 0;
+    _usb_talk.rx.string = false;
+    _usb_talk.rx.escape = false;
+    _usb_talk.rx.batch = false;
+
+    if ((_usb_talk.stream.callback != NULL) && !_usb_talk.stream.active)
+    {
+        _usb_talk.stream.active = true;
+        _usb_talk.stream.tick = bc_tick_get();
+        _usb_talk.stream.header_length = 0;
+    }
+}
+
+static void _usb_talk_rx_begin(void)
+{
+    _usb_talk.rx.state = USB_TALK_RX_STATE_MESSAGE;
+    _usb_talk.rx.length = 0;
+    _usb_talk.rx.token_count = 0;
+    _usb_talk.rx.primitive = -1;
+    _usb_talk.rx.handled = false;
+    _usb_talk.rx.id_length = 0;
+    _usb_talk.rx.answered = false;
+    _usb_talk.rx.nack = NULL;
+    _usb_talk.rx.data.active = false;
+    _usb_talk.rx.data.pending = false;
+    _usb_talk.rx.data.failed = false;
+
+    _usb_talk_rx_token(JSMN_ARRAY, 0);
+    _usb_talk_rx_store('[');
+
+    _usb_talk.rx.depth++;
+    _usb_talk.rx.parent[_usb_talk.rx.depth] = 0;
+    _usb_talk.rx.root_depth = _usb_talk.rx.depth;
+}
+
+static bool _usb_talk_rx_store(char character)
+{
+    if (_usb_talk.rx.length == sizeof(_usb_talk.rx.buffer))
+    {
+        _usb_talk.stats.rx_overflow++;
+        _usb_talk.rx.state = USB_TALK_RX_STATE_SKIP;
+
+        return false;
+    }
+
+    _usb_talk.rx.buffer[_usb_talk.rx.length++] = character;
+
+    return true;
+}
+
+static bool _usb_talk_rx_token(jsmntype_t type, int start)
+{
+    if (_usb_talk.rx.token_count == USB_TALK_TOKENS)
+    {
+        _usb_talk.stats.rx_token_overflow++;
+        _usb_talk.rx.state = USB_TALK_RX_STATE_SKIP;
+
+        return false;
+    }
+
+    // Message is ["topic", payload], anything else is dropped right after its first element
+    if ((_usb_talk.rx.token_count == USB_TALK_TOKEN_TOPIC) && (type != JSMN_STRING))
+    {
+        _usb_talk.stats.rx_invalid++;
+        _usb_talk.rx.state = USB_TALK_RX_STATE_SKIP;
+
+        return false;
+    }
+
+    jsmntok_t *token = &_usb_talk.rx.tokens[_usb_talk.rx.token_count];
+
+    token->type = type;
+    token->start = start;
+    token->end = -1;
+    token->size = 0;
+
+    if (_usb_talk.rx.token_count > 0)
+    {
+        _usb_talk.rx.tokens[_usb_talk.rx.parent[_usb_talk.rx.depth]].size++;
+    }
+
+    _usb_talk.rx.token_count++;
+
+    return true;
+}
+
+static void _usb_talk_rx_primitive_end(void)
+{
+    if (_usb_talk.rx.primitive >= 0)
+    {
+        _usb_talk.rx.tokens[_usb_talk.rx.primitive].end = _usb_talk.rx.length;
+        _usb_talk.rx.primitive = -1;
+    }
+}
+
+static void _usb_talk_rx_open(char character)
+{
+    if (_usb_talk.rx.depth == USB_TALK_DEPTH)
+    {
+        _usb_talk_rx_error();
+        return;
+    }
+
+    if (_usb_talk.rx.state == USB_TALK_RX_STATE_IDLE)
+    {
+        if (character != '[')
+        {
+            _usb_talk_rx_error();
+            return;
+        }
+
+        _usb_talk_rx_begin();
+
+        return;
+    }
+
+    if (_usb_talk.rx.state == USB_TALK_RX_STATE_BATCH)
+    {
+        if (character != '[')
+        {
+            _usb_talk_rx_error();
+            return;
+        }
+
+        _usb_talk_rx_begin();
+
+        return;
+    }
+
+    if (_usb_talk.rx.state == USB_TALK_RX_STATE_MESSAGE)
+    {
+        // Array as the first element of the line makes it a batch [["topic", payload], ...]
+        if (!_usb_talk.rx.batch && (_usb_talk.rx.token_count == 1) && (character == '['))
+        {
+            _usb_talk.rx.batch = true;
+            _usb_talk.rx.batch_count = 0;
+            _usb_talk.rx.batch_handled = 0;
+
+            _usb_talk_rx_begin();
+
+            return;
+        }
+
+        _usb_talk_rx_primitive_end();
+
+        if (_usb_talk_rx_token(character == '[' ? JSMN_ARRAY : JSMN_OBJECT, _usb_talk.rx.length))
+        {
+            if (_usb_talk_rx_store(character))
+            {
+                _usb_talk.rx.parent[_usb_talk.rx.depth + 1] = _usb_talk.rx.token_count - 1;
+            }
+        }
+    }
+    else if (_usb_talk.rx.state == USB_TALK_RX_STATE_DATA)
+    {
+        _usb_talk.stats.rx_invalid++;
+        _usb_talk.rx.state = USB_TALK_RX_STATE_SKIP;
+    }
+
+    _usb_talk.rx.depth++;
+}
+
+static void _usb_talk_rx_close(char character)
+{
+    if ((_usb_talk.rx.depth == 0) || (_usb_talk.rx.state == USB_TALK_RX_STATE_IDLE))
+    {
+        _usb_talk_rx_error();
+        return;
+    }
+
+    if (_usb_talk.rx.state == USB_TALK_RX_STATE_MESSAGE)
+    {
+        _usb_talk_rx_primitive_end();
+
+        jsmntok_t *token = &_usb_talk.rx.tokens[_usb_talk.rx.parent[_usb_talk.rx.depth]];
+
+        if (token->type != (character == ']' ? JSMN_ARRAY : JSMN_OBJECT))
+        {
+            _usb_talk_rx_error();
+            return;
+        }
+
+        if (_usb_talk_rx_store(character))
+        {
+            token->end = _usb_talk.rx.length;
+
+            if (token->type == JSMN_OBJECT)
+            {
+                token->size /= 2;
+            }
+        }
+    }
+
+    _usb_talk.rx.depth--;
+
+    if (_usb_talk.rx.state == USB_TALK_RX_STATE_BATCH)
+    {
+        snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer),
+                 "[\"%s/batch/-/ok\", {\"count\": %d, \"handled\": %d}]\n",
+                 _usb_talk.prefix, _usb_talk.rx.batch_count, _usb_talk.rx.batch_handled);
+
+        usb_talk_send_string((const char *) _usb_talk.tx_buffer);
+
+        _usb_talk.rx.state = USB_TALK_RX_STATE_END;
+
+        return;
+    }
+
+    if (_usb_talk.rx.depth != _usb_talk.rx.root_depth - 1)
+    {
+        return;
+    }
+
+    if (_usb_talk.rx.state == USB_TALK_RX_STATE_MESSAGE)
+    {
+        _usb_talk.rx.handled = _usb_talk_rx_dispatch();
+    }
+    else if (_usb_talk.rx.state == USB_TALK_RX_STATE_DATA)
+    {
+        _usb_talk.stats.rx_invalid++;
+    }
+
+    if (_usb_talk.rx.batch)
+    {
+        _usb_talk.rx.batch_count++;
+
+        if (_usb_talk.rx.handled)
+        {
+            _usb_talk.rx.batch_handled++;
+        }
+
+        _usb_talk.rx.state = USB_TALK_RX_STATE_BATCH;
+    }
+    else
+    {
+        _usb_talk.rx.state = USB_TALK_RX_STATE_END;
+    }
+}
+
+static void _usb_talk_rx_string_end(void)
+{
+    if (_usb_talk.rx.state == USB_TALK_RX_STATE_DATA)
+    {
+        _usb_talk_data_end();
+
+        // The data never enters the buffer, an empty payload token keeps the id the third member
+        _usb_talk.rx.state = USB_TALK_RX_STATE_MESSAGE;
+
+        if (_usb_talk_rx_token(JSMN_STRING, _usb_talk.rx.length))
+        {
+            _usb_talk.rx.tokens[_usb_talk.rx.token_count - 1].end = _usb_talk.rx.length;
+        }
+
+        return;
+    }
+
+    if (_usb_talk.rx.state != USB_TALK_RX_STATE_MESSAGE)
+    {
+        return;
+    }
+
+    jsmntok_t *token = &_usb_talk.rx.tokens[_usb_talk.rx.token_count - 1];
+
+    token->end = _usb_talk.rx.length;
+
+    if (!_usb_talk_rx_store('"'))
+    {
+        return;
+    }
+
+    if (_usb_talk.rx.token_count - 1 == USB_TALK_TOKEN_TOPIC)
+    {
+        _usb_talk_rx_topic();
+    }
+}
+
+static void _usb_talk_rx_topic(void)
+{
+    for (size_t i = 0; i < _usb_talk.subscribes_length; i++)
+    {
+        if (_usb_talk_topic_match(_usb_talk.rx.buffer, &_usb_talk.rx.tokens[USB_TALK_TOKEN_TOPIC], _usb_talk.subscribes[i].topic))
+        {
+            if (_usb_talk.subscribes[i].data_callback != NULL)
+            {
+                _usb_talk.rx.subscribe = i;
+                _usb_talk.rx.state = USB_TALK_RX_STATE_DATA;
+                _usb_talk.rx.data.active = true;
+            }
+
+            return;
+        }
+    }
+
+    // Nobody listens, the payload is not buffered at all
+    _usb_talk.stats.rx_unhandled++;
+    _usb_talk.rx.state = USB_TALK_RX_STATE_SKIP;
+}
+
+static bool _usb_talk_rx_dispatch(void)
+{
+    jsmntok_t *tokens = _usb_talk.rx.tokens;
+    usb_talk_payload_t payload = {
+            _usb_talk.rx.buffer,
+            _usb_talk.rx.token_count - USB_TALK_TOKEN_PAYLOAD,
+            tokens + USB_TALK_TOKEN_PAYLOAD,
+            &tokens[USB_TALK_TOKEN_TOPIC]
+    };
+
+    // An optional third member is the request id, the payload ends where it starts
+    if (tokens[USB_TALK_TOKEN_ARRAY].size == 3)
+    {
+        int index = _usb_talk_token_skip(&payload, 0);
+
+        if ((index >= payload.token_count) || !_usb_talk_rx_id(&payload.tokens[index]))
+        {
+            _usb_talk_rx_invalid();
+            return false;
+        }
+
+        payload.token_count = index;
+    }
+    else if (tokens[USB_TALK_TOKEN_ARRAY].size != 2)
+    {
+        _usb_talk_rx_invalid();
+        return false;
+    }
+
+    bool handled = false;
+
+    // Data went to its callback chunk by chunk, only the end waits for the id so the answer can carry it
+    if (_usb_talk.rx.data.active)
+    {
+        if (_usb_talk.rx.data.pending)
+        {
+            handled = _usb_talk_data_event(USB_TALK_DATA_EVENT_DONE);
+        }
+
+        if (!handled && (_usb_talk.rx.nack == NULL))
+        {
+            _usb_talk.rx.nack = "payload";
+        }
+    }
+
+    for (size_t i = 0; !_usb_talk.rx.data.active && (i < _usb_talk.subscribes_length); i++)
+    {
+        if (_usb_talk.subscribes[i].callback == NULL)
+        {
+            continue;
+        }
+
+        if (_usb_talk_topic_match(_usb_talk.rx.buffer, &tokens[USB_TALK_TOKEN_TOPIC], _usb_talk.subscribes[i].topic))
+        {
+            profiler_start(_usb_talk.subscribes[i].profiler);
+            _usb_talk.subscribes[i].callback(&payload, _usb_talk.subscribes[i].param);
+            profiler_stop(_usb_talk.subscribes[i].profiler);
+
+            if (_usb_talk.first_command_tick == BC_TICK_INFINITY)
+            {
+                _usb_talk.first_command_tick = bc_tick_get();
+            }
+
+            handled = true;
+        }
+    }
+
+    if (_usb_talk.rx.id_length != 0)
+    {
+        _usb_talk_rx_answer();
+
+        _usb_talk.rx.id_length = 0;
+    }
+
+    return handled;
+}
+
+static bool _usb_talk_rx_id(jsmntok_t *token)
+{
+    int start = token->start;
+    int end = token->end;
+
+    // Strings keep their quotes, numbers must be plain integers, the id is echoed verbatim
+    if (token->type == JSMN_STRING)
+    {
+        start--;
+        end++;
+    }
+    else if (token->type == JSMN_PRIMITIVE)
+    {
+        for (int i = start + (_usb_talk.rx.buffer[start] == '-' ? 1 : 0); i < end; i++)
+        {
+            if ((_usb_talk.rx.buffer[i] < '0') || (_usb_talk.rx.buffer[i] > '9'))
+            {
+                return false;
+            }
+        }
+    }
+    else
+    {
+        return false;
+    }
+
+    if (start >= end)
+    {
+        return false;
+    }
+
+    if ((size_t) (end - start) > sizeof(_usb_talk.rx.id))
+    {
+        return false;
+    }
+
+    memcpy(_usb_talk.rx.id, &_usb_talk.rx.buffer[start], end - start);
+    _usb_talk.rx.id_length = end - start;
+
+    return true;
+}
+
+static void _usb_talk_rx_answer(void)
+{
+    // A handler that said nothing gets a plain acknowledgement, the id is added on the way out
+    if (_usb_talk.rx.nack != NULL)
+    {
+        snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer),
+                 "[\"%s/request/-/nack\", {\"error\": \"%s\"}]\n", _usb_talk.prefix, _usb_talk.rx.nack);
+    }
+    else if (!_usb_talk.rx.answered)
+    {
+        snprintf(_usb_talk.tx_buffer, sizeof(_usb_talk.tx_buffer), "[\"%s/request/-/ok\", null]\n", _usb_talk.prefix);
+    }
+    else
+    {
+        return;
+    }
+
+    usb_talk_send_string((const char *) _usb_talk.tx_buffer);
+}
+
+static const char *_usb_talk_tx_tag(const char *buffer, size_t *length)
+{
+    bool snapshot = buffer == _usb_talk.snapshot.buffer;
+    char *line = snapshot ? _usb_talk.snapshot.buffer : _usb_talk.tx_buffer;
+    size_t size = snapshot ? sizeof(_usb_talk.snapshot.buffer) : sizeof(_usb_talk.tx_buffer);
+    size_t end = *length - 2;
+
+    // The id goes in as the third member, constant lines are copied to the line buffer first
+    if ((*length < 2) || (buffer[end] != ']') || (end + 2 + _usb_talk.rx.id_length + 3 > size))
+    {
+        return buffer;
+    }
+
+    if (line != buffer)
+    {
+        memcpy(line, buffer, end);
+    }
+
+    line[end++] = ',';
+    line[end++] = ' ';
+    memcpy(&line[end], _usb_talk.rx.id, _usb_talk.rx.id_length);
+    end += _usb_talk.rx.id_length;
+    strcpy(&line[end], "]\n");
+
+    *length = end + 2;
+    _usb_talk.rx.answered = true;
+
+    ram_buffer_use(snapshot ? _usb_talk.ram.snapshot : _usb_talk.ram.tx, *length + 1);
+
+    return line;
+}
+
+static void _usb_talk_rx_invalid(void)
+{
+    if (_usb_talk.rx.data.pending)
+    {
+        _usb_talk_data_event(USB_TALK_DATA_EVENT_ERROR);
+    }
+
+    _usb_talk.stats.rx_invalid++;
+}
+
+static void _usb_talk_rx_error(void)
+{
+    if (((_usb_talk.rx.state == USB_TALK_RX_STATE_DATA) && _usb_talk.rx.string) || _usb_talk.rx.data.pending)
+    {
+        _usb_talk_data_event(USB_TALK_DATA_EVENT_ERROR);
+    }
+
+    _usb_talk.stats.rx_parse_error++;
+    _usb_talk.rx.state = USB_TALK_RX_STATE_ERROR;
+}
+
+static void _usb_talk_data_begin(void)
+{
+    _usb_talk.rx.data.bits = 0;
+    _usb_talk.rx.data.count = 0;
+    _usb_talk.rx.data.padding = 0;
+    _usb_talk.rx.data.offset = 0;
+    _usb_talk.rx.data.length = 0;
+}
+
+static void _usb_talk_data_character(char character)
+{
+    // After a failure the rest of the string is only passed over, the id behind it still gets its nack
+    if (_usb_talk.rx.data.failed)
+    {
+        return;
+    }
+
+    uint32_t value = b64_get_value(character);
+
+    if (character == '=' && _usb_talk.rx.data.count >= 2)
+    {
+        value = 0;
+        _usb_talk.rx.data.padding++;
+    }
+
+    if ((value == B64_INVALID) || ((_usb_talk.rx.data.padding != 0) && (character != '=')))
+    {
+        _usb_talk.stats.rx_invalid++;
+        _usb_talk_data_event(USB_TALK_DATA_EVENT_ERROR);
+        _usb_talk.rx.data.failed = true;
+
+        return;
+    }
+
+    _usb_talk.rx.data.bits = (_usb_talk.rx.data.bits << 6) | value;
+
+    if (++_usb_talk.rx.data.count < 4)
+    {
+        return;
+    }
+
+    uint8_t *buffer = _usb_talk.rx.data.buffer + _usb_talk.rx.data.length;
+
+    buffer[0] = _usb_talk.rx.data.bits >> 16;
+    buffer[1] = _usb_talk.rx.data.bits >> 8;
+    buffer[2] = _usb_talk.rx.data.bits;
+
+    _usb_talk.rx.data.length += 3 - _usb_talk.rx.data.padding;
+    _usb_talk.rx.data.bits = 0;
+    _usb_talk.rx.data.count = 0;
+
+    if (_usb_talk.rx.data.length + 3 > sizeof(_usb_talk.rx.data.buffer))
+    {
+        _usb_talk_data_flush();
+    }
+}
+
+static size_t _usb_talk_data_quanta(const char *input, size_t length)
+{
+    // Whole quanta inside a data string skip the tokenizer, anything else goes character by character
+    if ((_usb_talk.rx.state != USB_TALK_RX_STATE_DATA) || !_usb_talk.rx.string || _usb_talk.rx.escape ||
+        _usb_talk.rx.data.failed || (_usb_talk.rx.data.count != 0) || (_usb_talk.rx.data.padding != 0))
+    {
+        return 0;
+    }
+
+    size_t count = length / 4;
+    size_t room = (sizeof(_usb_talk.rx.data.buffer) - _usb_talk.rx.data.length) / 3;
+
+    if (count > room)
+    {
+        count = room;
+    }
+
+    count = b64_decode_quanta(input, count, _usb_talk.rx.data.buffer + _usb_talk.rx.data.length);
+
+    _usb_talk.rx.data.length += count * 3;
+    _usb_talk.rx.line_length += count * 4;
+
+    if (_usb_talk.rx.data.length + 3 > sizeof(_usb_talk.rx.data.buffer))
+    {
+        _usb_talk_data_flush();
+    }
+
+    return count * 4;
+}
+
+static void _usb_talk_data_end(void)
+{
+    if (_usb_talk.rx.data.failed)
+    {
+        return;
+    }
+
+    if (_usb_talk.rx.data.count != 0)
+    {
+        _usb_talk.stats.rx_invalid++;
+        _usb_talk_data_event(USB_TALK_DATA_EVENT_ERROR);
+        _usb_talk.rx.data.failed = true;
+
+        return;
+    }
+
+    _usb_talk.rx.data.pending = _usb_talk_data_flush();
+}
+
+static bool _usb_talk_data_flush(void)
+{
+    if (_usb_talk.rx.data.length == 0)
+    {
+        return true;
+    }
+
+    if (!_usb_talk_data_event(USB_TALK_DATA_EVENT_CHUNK))
+    {
+        _usb_talk.stats.rx_invalid++;
+        _usb_talk.rx.data.failed = true;
+
+        return false;
+    }
+
+    _usb_talk.rx.data.offset += _usb_talk.rx.data.length;
+    _usb_talk.rx.data.length = 0;
+
+    return true;
+}
+
+static bool _usb_talk_data_event(usb_talk_data_event_t event)
+{
+    usb_talk_data_t data = {
+            event,
+            _usb_talk.rx.data.offset,
+            event == USB_TALK_DATA_EVENT_CHUNK ? _usb_talk.rx.data.buffer : NULL,
+            event == USB_TALK_DATA_EVENT_CHUNK ? _usb_talk.rx.data.length : 0
+    };
+
+    size_t i = _usb_talk.rx.subscribe;
+
+    if (event != USB_TALK_DATA_EVENT_CHUNK)
+    {
+        _usb_talk.rx.data.pending = false;
+    }
+
+    profiler_start(_usb_talk.subscribes[i].profiler);
+    bool result = _usb_talk.subscribes[i].data_callback(&data, _usb_talk.subscribes[i].param);
+    profiler_stop(_usb_talk.subscribes[i].profiler);
+
+    return result;
+}
+
+static size_t _usb_talk_stream_receive(const uint8_t *buffer, size_t length)
+{
+    usb_talk_frame_t *frame = &_usb_talk.stream.frame;
+
+    _usb_talk.stream.tick = bc_tick_get();
+
+    if (_usb_talk.stream.header_length < USB_TALK_FRAME_HEADER_SIZE)
+    {
+        uint8_t byte = buffer[0];
+
+        // Out of sync, drop bytes until the magic shows up again
+        if (((_usb_talk.stream.header_length == 0) && (byte != USB_TALK_FRAME_MAGIC_0)) ||
+            ((_usb_talk.stream.header_length == 1) && (byte != USB_TALK_FRAME_MAGIC_1)))
+        {
+            _usb_talk.stats.rx_invalid++;
+            _usb_talk.stream.header_length = byte == USB_TALK_FRAME_MAGIC_0 ? 1 : 0;
+
+            return 1;
+        }
+
+        _usb_talk.stream.header[_usb_talk.stream.header_length++] = byte;
+
+        if (_usb_talk.stream.header_length < USB_TALK_FRAME_HEADER_SIZE)
+        {
+            return 1;
+        }
+
+        frame->sequence = _usb_talk.stream.header[2] | (_usb_talk.stream.header[3] << 8);
+        frame->length = _usb_talk.stream.header[4] | (_usb_talk.stream.header[5] << 8);
+        frame->offset = 0;
+
+        if (frame->length == 0)
+        {
+            _usb_talk_stream_end();
+
+            return 1;
+        }
+
+        _usb_talk.stream.skip = !_usb_talk_stream_event(USB_TALK_FRAME_EVENT_BEGIN);
+
+        return 1;
+    }
+
+    size_t chunk = frame->length - frame->offset;
+
+    if (chunk > length)
+    {
+        chunk = length;
+    }
+
+    if (!_usb_talk.stream.skip)
+    {
+        frame->buffer = buffer;
+        frame->buffer_length = chunk;
+
+        _usb_talk.stream.skip = !_usb_talk_stream_event(USB_TALK_FRAME_EVENT_CHUNK);
+    }
+
+    frame->offset += chunk;
+
+    if (frame->offset == frame->length)
+    {
+        if (!_usb_talk.stream.skip)
+        {
+            _usb_talk_stream_event(USB_TALK_FRAME_EVENT_DONE);
+        }
+
+        _usb_talk.stream.header_length = 0;
+    }
+
+    return chunk;
+}
+
+static bool _usb_talk_stream_event(usb_talk_frame_event_t event)
+{
+    _usb_talk.stream.frame.event = event;
+
+    if (event != USB_TALK_FRAME_EVENT_CHUNK)
+    {
+        _usb_talk.stream.frame.buffer = NULL;
+        _usb_talk.stream.frame.buffer_length = 0;
+    }
+
+    return _usb_talk.stream.callback(&_usb_talk.stream.frame, _usb_talk.stream.param);
+}
+
+static void _usb_talk_stream_end(void)
+{
+    _usb_talk_stream_event(USB_TALK_FRAME_EVENT_END);
+
+    _usb_talk.stream.active = false;
+    _usb_talk.stream.callback = NULL;
+}
+
 bool usb_talk_payload_get_bool(usb_talk_payload_t *payload, bool *value)
 {
     if (usb_talk_is_string_token_equal(payload->buffer, &payload->tokens[0], "true"))
@@ -311,287 +1852,478 @@ bool usb_talk_payload_get_bool(usb_talk_payload_t *payload, bool *value)
     return false;
 }
 
-bool usb_talk_payload_get_key_bool(usb_talk_payload_t *payload, const char *key, bool *value)
+bool usb_talk_payload_get_channel(usb_talk_payload_t *payload, uint8_t *bus, uint8_t *number)
 {
-    if (payload->tokens[0].type != JSMN_OBJECT)
-    {
-        return false;
-    }
+    const char *c = payload->buffer + payload->topic->start;
+    const char *end = payload->buffer + payload->topic->end;
+    int level = 0;
 
-    for (int i = 1; i + 1 < payload->token_count; i += 2)
+    // Topics are prefix/kind/channel/..., a channel is the bus and the number on it like 0:1
+    while ((c < end) && (level < 2))
     {
-        if (usb_talk_is_string_token_equal(payload->buffer, &payload->tokens[i], key))
+        if (*c++ == '/')
         {
-            if (usb_talk_is_string_token_equal(payload->buffer, &payload->tokens[i + 1], "true"))
-            {
-                *value = true;
-                return true;
-            }
-            else if (usb_talk_is_string_token_equal(payload->buffer, &payload->tokens[i + 1], "false"))
-            {
-                *value = false;
-                return true;
-            }
-            else
-            {
-                return false;
-            }
+            level++;
         }
     }
-    return false;
-}
 
-bool usb_talk_payload_get_data(usb_talk_payload_t *payload, uint8_t *buffer, size_t *length)
-{
-    if (payload->tokens[0].type != JSMN_STRING)
+    if ((end - c < 3) || (c[0] < '0') || (c[0] > '9') || (c[1] != ':') || (c[2] < '0') || (c[2] > '9') ||
+        ((end - c > 3) && (c[3] != '/')))
     {
         return false;
     }
 
-    uint32_t input_length = payload->tokens[0].end - payload->tokens[0].start;
-
-    size_t data_length = base64_calculate_decode_length(&payload->buffer[payload->tokens[0].start], input_length);
+    *bus = c[0] - '0';
+    *number = c[2] - '0';
 
-    if (data_length > *length)
-    {
-        return false;
-    }
-
-    return base64_decode(&payload->buffer[payload->tokens[0].start], input_length, buffer, (uint32_t *)length);
+    return true;
 }
 
-bool usb_talk_payload_get_key_data(usb_talk_payload_t *payload, const char *key, uint8_t *buffer, size_t *length)
+bool usb_talk_payload_decode(usb_talk_payload_t *payload, usb_talk_schema_t *schema, void *output, uint32_t *found)
 {
-    if (payload->tokens[0].type != JSMN_OBJECT)
+    uint32_t mask = 0;
+
+    if ((payload->token_count < 1) || (payload->tokens[0].type != JSMN_OBJECT))
     {
         return false;
     }
 
-    for (int i = 1; i + 1 < payload->token_count; i += 2)
+    _usb_talk_schema_prepare(schema);
+
+    for (int i = 1; i + 1 < payload->token_count; i = _usb_talk_token_skip(payload, i + 1))
     {
-        if (usb_talk_is_string_token_equal(payload->buffer, &payload->tokens[i], key))
+        jsmntok_t *key = &payload->tokens[i];
+        size_t length = (size_t) (key->end - key->start);
+        uint32_t hash = _usb_talk_hash(&payload->buffer[key->start], length);
+
+        for (size_t j = 0; j < schema->length; j++)
         {
-            if (payload->tokens[i + 1].type != JSMN_STRING)
+            usb_talk_field_t *field = &schema->fields[j];
+
+            if ((field->hash != hash) || !usb_talk_is_string_token_equal(payload->buffer, key, field->key))
             {
-                return false;
+                continue;
             }
 
-            uint32_t input_length = payload->tokens[i + 1].end - payload->tokens[i + 1].start;
-
-            size_t data_length = base64_calculate_decode_length(&payload->buffer[payload->tokens[i + 1].start], input_length);
-
-            if (data_length > *length)
+            if (!_usb_talk_field_decode(field, payload->buffer, &payload->tokens[i + 1], output))
             {
                 return false;
             }
 
-            return base64_decode(&payload->buffer[payload->tokens[i + 1].start], input_length, buffer, (uint32_t *)length);
+            mask |= 1UL << j;
+
+            break;
         }
     }
-    return false;
+
+    for (size_t j = 0; j < schema->length; j++)
+    {
+        if (schema->fields[j].required && ((mask & (1UL << j)) == 0))
+        {
+            return false;
+        }
+    }
+
+    if (found != NULL)
+    {
+        *found = mask;
+    }
+
+    return true;
 }
 
-bool usb_talk_payload_get_enum(usb_talk_payload_t *payload, int *value, ...)
+bool usb_talk_is_string_token_equal(const char *buffer, jsmntok_t *token, const char *string)
 {
-    char temp[11];
-    char *str;
-    int j = 0;
+    size_t token_length;
 
-    jsmntok_t *token = &payload->tokens[0];
+    token_length = (size_t) (token->end - token->start);
 
-    if (token->type != JSMN_STRING)
+    if (strlen(string) != token_length)
     {
         return false;
     }
 
-    size_t length = token->end - token->start;
-
-    if (length > (sizeof(temp) - 1))
+    if (strncmp(string, &buffer[token->start], token_length) != 0)
     {
         return false;
     }
 
-    memset(temp, 0x00, sizeof(temp));
+    return true;
+}
 
-    strncpy(temp, payload->buffer + token->start, length);
+static bool _usb_talk_token_parse_int(const char *buffer, jsmntok_t *token, int *value)
+{
+    const char *c = buffer + token->start;
+    const char *end = buffer + token->end;
+    bool negative = false;
+    int64_t result = 0;
+    int exponent = 0;
+    int digits = 0;
+
+    if ((c < end) && (*c == '-'))
+    {
+        negative = true;
+        c++;
+    }
 
-    va_list vl;
-    va_start(vl, value);
-    str = va_arg(vl, char*);
-    while (str != NULL)
+    for (; (c < end) && (*c >= '0') && (*c <= '9'); c++, digits++)
     {
-        if (strcmp(str, temp) == 0)
+        if (result < INT32_MAX)
         {
-            *value = j;
-            return true;
+            result = result * 10 + (*c - '0');
         }
-        str = va_arg(vl, char*);
-        j++;
     }
-    va_end(vl);
 
-    return false;
-}
-
-bool usb_talk_payload_get_key_enum(usb_talk_payload_t *payload, const char *key, int *value, ...)
-{
-    char temp[11];
-    char *str;
-    int j = 0;
+    if ((c < end) && (*c == '.'))
+    {
+        // Fraction only matters when an exponent shifts it into the integer part
+        for (c++; (c < end) && (*c >= '0') && (*c <= '9'); c++, digits++)
+        {
+            if (result < INT32_MAX)
+            {
+                result = result * 10 + (*c - '0');
+                exponent--;
+            }
+        }
+    }
 
-    if (payload->tokens[0].type != JSMN_OBJECT)
+    if (digits == 0)
     {
         return false;
     }
 
-    for (int i = 1; i + 1 < payload->token_count; i += 2)
+    if ((c < end) && ((*c == 'e') || (*c == 'E')))
     {
-        if (usb_talk_is_string_token_equal(payload->buffer, &payload->tokens[i], key))
-        {
+        bool exponent_negative = false;
+        int e = 0;
+
+        c++;
 
-            jsmntok_t *token = &payload->tokens[i + 1];
-            size_t length = token->end - token->start;
+        if ((c < end) && ((*c == '-') || (*c == '+')))
+        {
+            exponent_negative = *c++ == '-';
+        }
 
-            if (length > (sizeof(temp) - 1))
+        for (; (c < end) && (*c >= '0') && (*c <= '9'); c++)
+        {
+            if (e < 100)
             {
-                return false;
+                e = e * 10 + (*c - '0');
             }
+        }
 
-            memset(temp, 0x00, sizeof(temp));
+        exponent += exponent_negative ? -e : e;
+    }
 
-            strncpy(temp, payload->buffer + token->start, length);
+    if (c != end)
+    {
+        return false;
+    }
 
-            va_list vl;
-            va_start(vl, value);
-            str = va_arg(vl, char*);
-            while (str != NULL)
-            {
-                if (strcmp(str, temp) == 0)
-                {
-                    *value = j;
-                    return true;
-                }
-                str = va_arg(vl, char*);
-                j++;
-            }
-            va_end(vl);
+    for (; (exponent > 0) && (result != 0); exponent--)
+    {
+        result *= 10;
 
+        if (result > INT32_MAX)
+        {
             return false;
         }
     }
-    return false;
-}
 
-bool usb_talk_payload_get_int(usb_talk_payload_t *payload, int *value)
-{
-    return _usb_talk_token_get_int(payload->buffer, &payload->tokens[0], value);
+    for (; (exponent < 0) && (result != 0); exponent++)
+    {
+        result /= 10;
+    }
+
+    if (result > INT32_MAX)
+    {
+        return false;
+    }
+
+    *value = negative ? (int) -result : (int) result;
+
+    return true;
 }
 
-bool usb_talk_payload_get_key_int(usb_talk_payload_t *payload, const char *key, int *value)
+static bool _usb_talk_token_parse_float(const char *buffer, jsmntok_t *token, float *value)
 {
-    for (int i = 1; i + 1 < payload->token_count; i += 2)
+    const char *c = buffer + token->start;
+    const char *end = buffer + token->end;
+    bool negative = false;
+    uint32_t mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+
+    if ((c < end) && (*c == '-'))
     {
-        if (usb_talk_is_string_token_equal(payload->buffer, &payload->tokens[i], key))
+        negative = true;
+        c++;
+    }
+
+    // Digits beyond what the mantissa holds only move the exponent, a float keeps fewer anyway
+    for (; (c < end) && (*c >= '0') && (*c <= '9'); c++, digits++)
+    {
+        if (mantissa < 100000000UL)
+        {
+            mantissa = mantissa * 10 + (*c - '0');
+        }
+        else
         {
-            return _usb_talk_token_get_int(payload->buffer, &payload->tokens[i + 1], value);
+            exponent++;
         }
     }
-    return false;
-}
 
-bool usb_talk_payload_get_string(usb_talk_payload_t *payload, char *buffer, size_t *length)
-{
-    if (payload->tokens[0].type != JSMN_STRING)
+    if ((c < end) && (*c == '.'))
+    {
+        for (c++; (c < end) && (*c >= '0') && (*c <= '9'); c++, digits++)
+        {
+            if (mantissa < 100000000UL)
+            {
+                mantissa = mantissa * 10 + (*c - '0');
+                exponent--;
+            }
+        }
+    }
+
+    if (digits == 0)
+    {
+        return false;
+    }
+
+    if ((c < end) && ((*c == 'e') || (*c == 'E')))
+    {
+        bool exponent_negative = false;
+        int e = 0;
+
+        c++;
+
+        if ((c < end) && ((*c == '-') || (*c == '+')))
+        {
+            exponent_negative = *c++ == '-';
+        }
+
+        if ((c == end) || (*c < '0') || (*c > '9'))
+        {
+            return false;
+        }
+
+        for (; (c < end) && (*c >= '0') && (*c <= '9'); c++)
+        {
+            if (e < 100)
+            {
+                e = e * 10 + (*c - '0');
+            }
+        }
+
+        exponent += exponent_negative ? -e : e;
+    }
+
+    if (c != end)
     {
         return false;
     }
-    uint32_t token_length = payload->tokens[0].end - payload->tokens[0].start;
-    if (token_length > *length)
+
+    if ((exponent > 38) && (mantissa != 0))
     {
         return false;
     }
-    strncpy(buffer, &payload->buffer[payload->tokens[0].start], token_length);
-    *length = token_length;
+
+    // One division at the end keeps the rounding of small fractions like 0.3 to a single step
+    float scale = 1.f;
+
+    for (int i = exponent < 0 ? -exponent : exponent; (i > 0) && (scale < 1e38f); i--)
+    {
+        scale *= 10.f;
+    }
+
+    float result = exponent < 0 ? (float) mantissa / scale : (float) mantissa * scale;
+
+    *value = negative ? -result : result;
+
     return true;
 }
 
-bool usb_talk_payload_get_key_string(usb_talk_payload_t *payload, const char *key, char *buffer, size_t *length)
+static bool _usb_talk_topic_match(const char *buffer, jsmntok_t *token, const char *topic)
 {
-    for (int i = 1; i + 1 < payload->token_count; i += 2)
+    const char *c = buffer + token->start;
+    const char *end = buffer + token->end;
+
+    // A + stands for one channel level, the - of the topics for all channels is left to their own subscriptions
+    for (; *topic != '\0'; topic++)
     {
-        if (usb_talk_is_string_token_equal(payload->buffer, &payload->tokens[i], key))
+        if (*topic == '+')
         {
-            if (payload->tokens[i + 1].type != JSMN_STRING)
+            const char *level = c;
+
+            while ((c < end) && (*c != '/'))
             {
-                return false;
+                c++;
             }
-            uint32_t token_length = payload->tokens[i + 1].end - payload->tokens[i + 1].start;
-            if (token_length > *length)
+
+            if ((c == level) || ((c - level == 1) && (*level == '-')))
             {
                 return false;
             }
-            strncpy(buffer, &payload->buffer[payload->tokens[i + 1].start], token_length);
-            *length = token_length;
-            return true;
+
+            continue;
+        }
+
+        if ((c == end) || (*c != *topic))
+        {
+            return false;
         }
+
+        c++;
     }
-    return false;
+
+    return c == end;
 }
 
-bool usb_talk_is_string_token_equal(const char *buffer, jsmntok_t *token, const char *string)
+static int _usb_talk_token_skip(usb_talk_payload_t *payload, int index)
 {
-    size_t token_length;
-
-    token_length = (size_t) (token->end - token->start);
+    int next = index + 1;
 
-    if (strlen(string) != token_length)
+    while ((next < payload->token_count) && (payload->tokens[next].start < payload->tokens[index].end))
     {
-        return false;
+        next++;
     }
 
-    if (strncmp(string, &buffer[token->start], token_length) != 0)
+    return next;
+}
+
+static uint32_t _usb_talk_hash(const char *buffer, size_t length)
+{
+    uint32_t hash = 2166136261UL;
+
+    for (size_t i = 0; i < length; i++)
     {
-        return false;
+        hash ^= (uint8_t) buffer[i];
+        hash *= 16777619UL;
     }
 
-    return true;
+    return hash;
 }
 
-static bool _usb_talk_token_get_int(const char *buffer, jsmntok_t *token, int *value)
+static void _usb_talk_schema_prepare(usb_talk_schema_t *schema)
 {
-    if (token->type != JSMN_PRIMITIVE)
+    if (schema->ready)
     {
-        return false;
+        return;
     }
 
-    size_t length = (size_t) (token->end - token->start);
+    for (size_t i = 0; i < schema->length; i++)
+    {
+        usb_talk_field_t *field = &schema->fields[i];
 
-    char str[10 + 1];
+        field->hash = _usb_talk_hash(field->key, strlen(field->key));
 
-    if (length > sizeof(str))
-    {
-        return false;
+        for (usb_talk_enum_t *item = field->enums; (item != NULL) && (item->name != NULL); item++)
+        {
+            item->hash = _usb_talk_hash(item->name, strlen(item->name));
+        }
     }
 
-    memset(str, 0, sizeof(str));
+    schema->ready = true;
+}
 
-    strncpy(str, buffer + token->start, length);
+static bool _usb_talk_field_decode(usb_talk_field_t *field, const char *buffer, jsmntok_t *token, void *output)
+{
+    void *target = (uint8_t *) output + field->offset;
+    size_t length = (size_t) (token->end - token->start);
 
-    if (strncmp(str, "null", sizeof(str)) == 0)
+    switch (field->type)
     {
-        return USB_TALK_INT_VALUE_NULL;
-    }
+        case USB_TALK_FIELD_TYPE_INT:
+        {
+            int value;
 
-    if (strchr(str, 'e'))
-    {
-        *value = (int) strtof(str, NULL);
-    }
-    else
-    {
-        *value = (int) strtol(str, NULL, 10);
-    }
+            if ((token->type != JSMN_PRIMITIVE) || !_usb_talk_token_parse_int(buffer, token, &value))
+            {
+                return false;
+            }
 
-    return true;
+            if ((value < field->min) || (value > field->max))
+            {
+                return false;
+            }
+
+            *(int *) target = value;
+
+            return true;
+        }
+        case USB_TALK_FIELD_TYPE_FLOAT:
+        {
+            float value;
+
+            if ((token->type != JSMN_PRIMITIVE) || !_usb_talk_token_parse_float(buffer, token, &value))
+            {
+                return false;
+            }
+
+            if ((value < field->min) || (value > field->max))
+            {
+                return false;
+            }
+
+            *(float *) target = value;
+
+            return true;
+        }
+        case USB_TALK_FIELD_TYPE_BOOL:
+        {
+            if (usb_talk_is_string_token_equal(buffer, token, "true"))
+            {
+                *(bool *) target = true;
+            }
+            else if (usb_talk_is_string_token_equal(buffer, token, "false"))
+            {
+                *(bool *) target = false;
+            }
+            else
+            {
+                return false;
+            }
+
+            return true;
+        }
+        case USB_TALK_FIELD_TYPE_STRING:
+        {
+            if ((token->type != JSMN_STRING) || (length >= field->size))
+            {
+                return false;
+            }
+
+            memcpy(target, &buffer[token->start], length);
+            ((char *) target)[length] = '\0';
+
+            return true;
+        }
+        case USB_TALK_FIELD_TYPE_ENUM:
+        {
+            if (token->type != JSMN_STRING)
+            {
+                return false;
+            }
+
+            uint32_t hash = _usb_talk_hash(&buffer[token->start], length);
+
+            for (int i = 0; field->enums[i].name != NULL; i++)
+            {
+                if ((field->enums[i].hash == hash) && usb_talk_is_string_token_equal(buffer, token, field->enums[i].name))
+                {
+                    *(int *) target = i;
+
+                    return true;
+                }
+            }
+
+            return false;
+        }
+        default:
+        {
+            return false;
+        }
+    }
 }
 
 
@@ -4,45 +4,173 @@
 #include <bc_common.h>
 #include <jsmn.h>
 #include <bc_module_relay.h>
+#include <sensor_stats.h>
+#include <profiler.h>
+#include <ram.h>
 
-#define USB_TALK_INT_VALUE_NULL INT32_MIN
+#define USB_TALK_FRAME_MAGIC_0 0xa5
+#define USB_TALK_FRAME_MAGIC_1 0x5a
+#define USB_TALK_FRAME_HEADER_SIZE 6
+
+#define USB_TALK_FIELD_INT(_type, _member, _key, _min, _max, _required) \
+    { .key = _key, .type = USB_TALK_FIELD_TYPE_INT, .offset = offsetof(_type, _member), .min = _min, .max = _max, .required = _required }
+#define USB_TALK_FIELD_FLOAT(_type, _member, _key, _min, _max, _required) \
+    { .key = _key, .type = USB_TALK_FIELD_TYPE_FLOAT, .offset = offsetof(_type, _member), .min = _min, .max = _max, .required = _required }
+#define USB_TALK_FIELD_BOOL(_type, _member, _key, _required) \
+    { .key = _key, .type = USB_TALK_FIELD_TYPE_BOOL, .offset = offsetof(_type, _member), .required = _required }
+#define USB_TALK_FIELD_STRING(_type, _member, _key, _required) \
+    { .key = _key, .type = USB_TALK_FIELD_TYPE_STRING, .offset = offsetof(_type, _member), .size = sizeof(((_type *) 0)->_member), .required = _required }
+#define USB_TALK_FIELD_ENUM(_type, _member, _key, _enums, _required) \
+    { .key = _key, .type = USB_TALK_FIELD_TYPE_ENUM, .offset = offsetof(_type, _member), .enums = _enums, .required = _required }
+
+#define USB_TALK_SCHEMA(_fields) { .fields = _fields, .length = sizeof(_fields) / sizeof(_fields[0]) }
+
+typedef enum
+{
+    USB_TALK_PRIORITY_CONTROL = 0,
+    USB_TALK_PRIORITY_TELEMETRY = 1,
+    USB_TALK_PRIORITY_BULK = 2
+
+} usb_talk_priority_t;
 
 typedef struct
 {
     const char *buffer;
     int token_count;
     jsmntok_t *tokens;
+    jsmntok_t *topic;
 
 } usb_talk_payload_t;
 
+typedef enum
+{
+    USB_TALK_DATA_EVENT_CHUNK = 0,
+    USB_TALK_DATA_EVENT_DONE = 1,
+    USB_TALK_DATA_EVENT_ERROR = 2
+
+} usb_talk_data_event_t;
+
+typedef struct
+{
+    usb_talk_data_event_t event;
+    size_t offset;
+    const uint8_t *buffer;
+    size_t length;
+
+} usb_talk_data_t;
+
+typedef enum
+{
+    USB_TALK_FRAME_EVENT_BEGIN = 0,
+    USB_TALK_FRAME_EVENT_CHUNK = 1,
+    USB_TALK_FRAME_EVENT_DONE = 2,
+    USB_TALK_FRAME_EVENT_END = 3
+
+} usb_talk_frame_event_t;
+
+typedef struct
+{
+    usb_talk_frame_event_t event;
+    uint16_t sequence;
+    size_t length;
+    size_t offset;
+    const uint8_t *buffer;
+    size_t buffer_length;
+
+} usb_talk_frame_t;
+
+typedef enum
+{
+    USB_TALK_FIELD_TYPE_INT = 0,
+    USB_TALK_FIELD_TYPE_BOOL = 1,
+    USB_TALK_FIELD_TYPE_STRING = 2,
+    USB_TALK_FIELD_TYPE_ENUM = 3,
+    USB_TALK_FIELD_TYPE_FLOAT = 4
+
+} usb_talk_field_type_t;
+
+typedef struct
+{
+    const char *name;
+    uint32_t hash;
+
+} usb_talk_enum_t;
+
+typedef struct
+{
+    const char *key;
+    usb_talk_field_type_t type;
+    size_t offset;
+    size_t size;
+    int min;
+    int max;
+    usb_talk_enum_t *enums;
+    bool required;
+    uint32_t hash;
+
+} usb_talk_field_t;
+
+typedef struct
+{
+    usb_talk_field_t *fields;
+    size_t length;
+    bool ready;
+
+} usb_talk_schema_t;
+
 typedef void (*usb_talk_sub_callback_t)(usb_talk_payload_t *payload, void *param);
+typedef bool (*usb_talk_sub_data_callback_t)(usb_talk_data_t *data, void *param);
+typedef bool (*usb_talk_frame_callback_t)(usb_talk_frame_t *frame, void *param);
 
-void usb_talk_init(void);
+void usb_talk_init(const char *prefix);
 void usb_talk_sub(const char *topic, usb_talk_sub_callback_t callback, void *param);
+void usb_talk_sub_data(const char *topic, usb_talk_sub_data_callback_t callback, void *param);
+void usb_talk_stream_start(usb_talk_frame_callback_t callback, void *param, bc_tick_t timeout);
 void usb_talk_send_string(const char *buffer);
+void usb_talk_send_string_priority(const char *buffer, usb_talk_priority_t priority);
+void usb_talk_nack(const char *error);
+void usb_talk_stats_reset(void);
 void usb_talk_publish_led(const char *prefix, bool *state);
 void usb_talk_publish_push_button(const char *prefix, uint16_t *event_count);
-void usb_talk_publish_thermometer(const char *prefix, uint8_t *i2c, float *temperature);
-void usb_talk_publish_humidity_sensor(const char *prefix, uint8_t *i2c, float *relative_humidity);
-void usb_talk_publish_lux_meter(const char *prefix, uint8_t *i2c, float *illuminance);
-void usb_talk_publish_barometer(const char *prefix, uint8_t *i2c, float *pascal, float *altitude);
-void usb_talk_publish_co2_concentation(const char *prefix, float *concentration);
+void usb_talk_publish_thermometer(const char *prefix, uint8_t *i2c, sensor_stats_t *temperature);
+void usb_talk_publish_humidity_sensor(const char *prefix, uint8_t *i2c, sensor_stats_t *relative_humidity);
+void usb_talk_publish_lux_meter(const char *prefix, uint8_t *i2c, sensor_stats_t *illuminance);
+void usb_talk_publish_barometer(const char *prefix, uint8_t *i2c, sensor_stats_t *pascal, sensor_stats_t *altitude);
+void usb_talk_publish_co2_concentation(const char *prefix, sensor_stats_t *concentration);
+void usb_talk_publish_thermometer_last(const char *prefix, uint8_t *i2c, sensor_stats_t *temperature);
+void usb_talk_publish_humidity_sensor_last(const char *prefix, uint8_t *i2c, sensor_stats_t *relative_humidity);
+void usb_talk_publish_lux_meter_last(const char *prefix, uint8_t *i2c, sensor_stats_t *illuminance);
+void usb_talk_publish_barometer_last(const char *prefix, uint8_t *i2c, sensor_stats_t *pressure, sensor_stats_t *altitude);
+void usb_talk_publish_co2_concentation_last(const char *prefix, sensor_stats_t *concentration);
+void usb_talk_snapshot_begin(const char *prefix);
+void usb_talk_snapshot_add(const char *format, ...);
+void usb_talk_snapshot_add_thermometer(uint8_t *i2c, sensor_stats_t *temperature);
+void usb_talk_snapshot_add_humidity_sensor(uint8_t *i2c, sensor_stats_t *relative_humidity);
+void usb_talk_snapshot_add_lux_meter(uint8_t *i2c, sensor_stats_t *illuminance);
+void usb_talk_snapshot_add_barometer(uint8_t *i2c, sensor_stats_t *pressure, sensor_stats_t *altitude);
+void usb_talk_snapshot_add_co2_concentation(sensor_stats_t *concentration);
+void usb_talk_snapshot_end(void);
 void usb_talk_publish_light(const char *prefix, bool *state);
 void usb_talk_publish_relay(const char *prefix, bool *state);
 void usb_talk_publish_module_relay(const char *prefix, uint8_t *number, bc_module_relay_state_t *state);
 void usb_talk_publish_led_strip_config(const char *prefix, const char *mode, int *count);
+void usb_talk_publish_led_strip_brightness(const char *prefix, int *brightness, float *gamma);
+void usb_talk_publish_led_strip_segment(const char *prefix, int *id, int *offset, int *count, int *brightness, const char *effect, int *wait);
+void usb_talk_publish_led_strip_segment_framebuffer(const char *prefix, int *id);
+void usb_talk_publish_led_strip_stream(const char *prefix, float *fps, uint32_t *received, uint32_t *shown, uint32_t *late, uint32_t *dropped);
 void usb_talk_publish_encoder(const char *prefix, int *increment);
+void usb_talk_publish_sensor_config(const char *prefix, const char *sensor, uint32_t *sample_interval, uint32_t *update_interval,
+                                    const char *filter, uint32_t *oversample, float *alpha, float *limit);
+void usb_talk_publish_lcd_config(const char *prefix, uint32_t *page_interval);
+void usb_talk_publish_profiler(const char *prefix, profiler_t *profiler, bc_tick_t *period);
+void usb_talk_publish_stats(const char *prefix);
+void usb_talk_publish_ram(const char *prefix, ram_usage_t *usage);
+void usb_talk_publish_ram_buffer(const char *prefix, ram_buffer_t *buffer);
+void usb_talk_publish_boot(const char *prefix, const char **names, profiler_t *phases, size_t count, bc_tick_t *ready);
 
 bool usb_talk_payload_get_bool(usb_talk_payload_t *payload, bool *value);
-bool usb_talk_payload_get_key_bool(usb_talk_payload_t *payload, const char *key, bool *value);
-bool usb_talk_payload_get_data(usb_talk_payload_t *payload, uint8_t *buffer, size_t *length);
-bool usb_talk_payload_get_key_data(usb_talk_payload_t *payload, const char *key, uint8_t *buffer, size_t *length);
-bool usb_talk_payload_get_enum(usb_talk_payload_t *payload, int *value, ...);
-bool usb_talk_payload_get_key_enum(usb_talk_payload_t *payload, const char *key, int *value, ...);
-bool usb_talk_payload_get_int(usb_talk_payload_t *payload, int *value);
-bool usb_talk_payload_get_key_int(usb_talk_payload_t *payload, const char *key, int *value);
-bool usb_talk_payload_get_string(usb_talk_payload_t *payload, char *buffer, size_t *length);
-bool usb_talk_payload_get_key_string(usb_talk_payload_t *payload, const char *key, char *buffer, size_t *length);
+bool usb_talk_payload_get_channel(usb_talk_payload_t *payload, uint8_t *bus, uint8_t *number);
+bool usb_talk_payload_decode(usb_talk_payload_t *payload, usb_talk_schema_t *schema, void *output, uint32_t *found);
 
 bool usb_talk_is_string_token_equal(const char *buffer, jsmntok_t *token, const char *string);
 
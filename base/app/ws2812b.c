@@ -0,0 +1,279 @@
+#include <ws2812b.h>
+#include <profiler.h>
+#include <bc_dma.h>
+#include <stm32l0xx.h>
+
+#define WS2812B_BIT_FREQUENCY 800000
+#define WS2812B_RESET_HALVES 2
+
+static struct
+{
+    const bc_led_strip_buffer_t *buffer;
+    void (*pixel_handler)(int position, uint8_t color[4]);
+    uint32_t pulses[WS2812B_HALF_BYTES * 2 * 2];
+    uint32_t nibbles[16];
+    const uint8_t *source;
+    int stride;
+    int count;
+    int pixel;
+    int index;
+    uint8_t wire[4];
+    int reset_halves;
+    bool blank;
+    volatile bool ready;
+    profiler_t *profiler;
+
+} _ws2812b;
+
+static bool _ws2812b_init(const bc_led_strip_buffer_t *buffer);
+static void _ws2812b_set_pixel(int position, uint32_t color);
+static void _ws2812b_set_pixel_rgbw(int position, uint8_t red, uint8_t green, uint8_t blue, uint8_t white);
+static bool _ws2812b_write(void);
+static bool _ws2812b_is_ready(void);
+static void _ws2812b_fill(uint32_t *half);
+static void _ws2812b_load(void);
+static void _ws2812b_stop(void);
+static void _ws2812b_dma_event_handler(bc_dma_channel_t channel, bc_dma_event_t event, void *event_param);
+
+static const bc_led_strip_driver_t _ws2812b_driver =
+{
+    .init = _ws2812b_init,
+    .set_pixel = _ws2812b_set_pixel,
+    .set_pixel_rgbw = _ws2812b_set_pixel_rgbw,
+    .write = _ws2812b_write,
+    .is_ready = _ws2812b_is_ready
+};
+
+const bc_led_strip_driver_t *ws2812b_get_driver(void)
+{
+    return &_ws2812b_driver;
+}
+
+void ws2812b_set_blank(bool blank)
+{
+    _ws2812b.blank = blank;
+}
+
+void ws2812b_set_pixel_handler(void (*handler)(int position, uint8_t color[4]))
+{
+    _ws2812b.pixel_handler = handler;
+}
+
+// Data goes out on PA1 as PWM of TIM2 channel 2, DMA1 channel 2 loads the compare value on every update
+// from two halves of a small buffer, each half is encoded from the pixel bytes while the other one is sent
+static bool _ws2812b_init(const bc_led_strip_buffer_t *buffer)
+{
+    uint32_t period = SystemCoreClock / WS2812B_BIT_FREQUENCY;
+    uint8_t pulse_0 = period / 3;
+    uint8_t pulse_1 = period * 2 / 3;
+
+    memset(&_ws2812b, 0, sizeof(_ws2812b));
+
+    _ws2812b.buffer = buffer;
+    _ws2812b.ready = true;
+    // A half is sent in WS2812B_HALF_BYTES * 10 us, a fill taking longer than that shows up as its max
+    _ws2812b.profiler = profiler_register("led-strip-fill");
+
+    // One word holds the compare values of four bits, the first bit sent in the lowest byte
+    for (int nibble = 0; nibble < 16; nibble++)
+    {
+        for (int bit = 0; bit < 4; bit++)
+        {
+            _ws2812b.nibbles[nibble] |= (uint32_t) ((nibble << bit) & 0x08 ? pulse_1 : pulse_0) << (bit * 8);
+        }
+    }
+
+    RCC->IOPENR |= RCC_IOPENR_GPIOAEN;
+    RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;
+
+    // PA1 alternate function 2 is TIM2_CH2
+    GPIOA->AFR[0] = (GPIOA->AFR[0] & ~(0xfUL << 4)) | (2UL << 4);
+    GPIOA->OSPEEDR |= 3UL << 2;
+    GPIOA->MODER = (GPIOA->MODER & ~(3UL << 2)) | (2UL << 2);
+
+    TIM2->CR1 = TIM_CR1_ARPE;
+    TIM2->PSC = 0;
+    TIM2->ARR = period - 1;
+    TIM2->CCR2 = 0;
+    TIM2->CCMR1 = TIM_CCMR1_OC2M_2 | TIM_CCMR1_OC2M_1 | TIM_CCMR1_OC2PE;
+    TIM2->CCER = TIM_CCER_CC2E;
+    TIM2->EGR = TIM_EGR_UG;
+    TIM2->DIER = TIM_DIER_UDE;
+
+    // The channel interrupt is shared with channel 3 and belongs to the SDK, which passes the halves on as events
+    bc_dma_init();
+    bc_dma_set_event_handler(BC_DMA_CHANNEL_2, _ws2812b_dma_event_handler, NULL);
+
+    return true;
+}
+
+static void _ws2812b_set_pixel(int position, uint32_t color)
+{
+    _ws2812b_set_pixel_rgbw(position, color >> 24, color >> 16, color >> 8, color);
+}
+
+static void _ws2812b_set_pixel_rgbw(int position, uint8_t red, uint8_t green, uint8_t blue, uint8_t white)
+{
+    if ((position < 0) || (position >= _ws2812b.buffer->count))
+    {
+        return;
+    }
+
+    uint8_t *pixel = (uint8_t *) _ws2812b.buffer->buffer + position * _ws2812b.buffer->type;
+
+    pixel[0] = red;
+    pixel[1] = green;
+    pixel[2] = blue;
+
+    if (_ws2812b.buffer->type == BC_LED_STRIP_TYPE_RGBW)
+    {
+        pixel[3] = white;
+    }
+}
+
+static bool _ws2812b_write(void)
+{
+    if (!_ws2812b.ready)
+    {
+        return false;
+    }
+
+    bc_dma_channel_config_t config =
+    {
+        .request = BC_DMA_REQUEST_8,
+        .direction = BC_DMA_DIRECTION_TO_PERIPHERAL,
+        .data_size_memory = BC_DMA_SIZE_1,
+        .data_size_peripheral = BC_DMA_SIZE_2,
+        .length = sizeof(_ws2812b.pulses),
+        .mode = BC_DMA_MODE_CIRCULAR,
+        .address_memory = _ws2812b.pulses,
+        .address_peripheral = (void *) &TIM2->CCR2,
+        .priority = BC_DMA_PRIORITY_VERY_HIGH
+    };
+
+    _ws2812b.ready = false;
+    _ws2812b.source = _ws2812b.blank ? NULL : (const uint8_t *) _ws2812b.buffer->buffer;
+    _ws2812b.stride = _ws2812b.buffer->type;
+    _ws2812b.count = _ws2812b.buffer->count;
+    _ws2812b.pixel = 0;
+    _ws2812b.index = 0;
+    _ws2812b.reset_halves = 0;
+
+    _ws2812b_fill(&_ws2812b.pulses[0]);
+    _ws2812b_fill(&_ws2812b.pulses[WS2812B_HALF_BYTES * 2]);
+
+    // Request 8 of channel 2 is the TIM2 update
+    bc_dma_channel_config(BC_DMA_CHANNEL_2, &config);
+    bc_dma_channel_run(BC_DMA_CHANNEL_2);
+
+    TIM2->CNT = 0;
+    TIM2->CR1 |= TIM_CR1_CEN;
+
+    return true;
+}
+
+static bool _ws2812b_is_ready(void)
+{
+    return _ws2812b.ready;
+}
+
+static void _ws2812b_fill(uint32_t *half)
+{
+    if (_ws2812b.pixel >= _ws2812b.count)
+    {
+        // Compare value 0 keeps the line low, which latches the frame in the strip
+        memset(half, 0, WS2812B_HALF_BYTES * 8);
+
+        _ws2812b.reset_halves++;
+
+        return;
+    }
+
+    for (int i = 0; i < WS2812B_HALF_BYTES; i++)
+    {
+        if (_ws2812b.pixel < _ws2812b.count)
+        {
+            // A pixel may start in one half and end in the next, its wire bytes wait in between
+            if (_ws2812b.index == 0)
+            {
+                _ws2812b_load();
+            }
+
+            uint8_t value = _ws2812b.wire[_ws2812b.index];
+
+            half[i * 2] = _ws2812b.nibbles[value >> 4];
+            half[i * 2 + 1] = _ws2812b.nibbles[value & 0x0f];
+
+            if (++_ws2812b.index == _ws2812b.stride)
+            {
+                _ws2812b.index = 0;
+                _ws2812b.pixel++;
+            }
+        }
+        else
+        {
+            half[i * 2] = 0;
+            half[i * 2 + 1] = 0;
+        }
+    }
+}
+
+// The pixel is read from the buffer as it goes out, the handler applies what is not stored, in the order of the wire
+static void _ws2812b_load(void)
+{
+    if (_ws2812b.source == NULL)
+    {
+        memset(_ws2812b.wire, 0, sizeof(_ws2812b.wire));
+
+        return;
+    }
+
+    const uint8_t *pixel = _ws2812b.source + _ws2812b.pixel * _ws2812b.stride;
+    uint8_t color[4] = { pixel[0], pixel[1], pixel[2], _ws2812b.stride == 4 ? pixel[3] : 0 };
+
+    if (_ws2812b.pixel_handler != NULL)
+    {
+        _ws2812b.pixel_handler(_ws2812b.pixel, color);
+    }
+
+    _ws2812b.wire[0] = color[1];
+    _ws2812b.wire[1] = color[0];
+    _ws2812b.wire[2] = color[2];
+    _ws2812b.wire[3] = color[3];
+}
+
+static void _ws2812b_stop(void)
+{
+    TIM2->CR1 &= ~TIM_CR1_CEN;
+    bc_dma_channel_stop(BC_DMA_CHANNEL_2);
+
+    _ws2812b.ready = true;
+}
+
+static void _ws2812b_dma_event_handler(bc_dma_channel_t channel, bc_dma_event_t event, void *event_param)
+{
+    (void) channel;
+    (void) event_param;
+
+    if (event == BC_DMA_EVENT_ERROR)
+    {
+        // Nothing sensible goes out after a transfer error, the next write starts over
+        _ws2812b_stop();
+
+        return;
+    }
+
+    // The half just sent is free, once the whole reset time has gone out the transfer stops
+    if (_ws2812b.reset_halves > WS2812B_RESET_HALVES)
+    {
+        _ws2812b_stop();
+
+        return;
+    }
+
+    profiler_start(_ws2812b.profiler);
+
+    _ws2812b_fill(event == BC_DMA_EVENT_HALF_DONE ? &_ws2812b.pulses[0] : &_ws2812b.pulses[WS2812B_HALF_BYTES * 2]);
+
+    profiler_stop(_ws2812b.profiler);
+}
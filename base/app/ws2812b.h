@@ -0,0 +1,16 @@
+#ifndef _WS2812B_H
+#define _WS2812B_H
+
+#include <bc_common.h>
+#include <bc_led_strip.h>
+
+// Pixel bytes encoded per DMA half-buffer, each byte takes 8 timer periods of 1.25 us
+#define WS2812B_HALF_BYTES 16
+
+const bc_led_strip_driver_t *ws2812b_get_driver(void);
+void ws2812b_set_blank(bool blank);
+
+// The handler is called from the DMA interrupt for every pixel as it is encoded, with the color as it is in the buffer
+void ws2812b_set_pixel_handler(void (*handler)(int position, uint8_t color[4]));
+
+#endif /* _WS2812B_H */
@@ -0,0 +1,179 @@
+#include <radio_schema.h>
+
+#define RADIO_SCHEMA_HEADER 2
+#define RADIO_SCHEMA_QUANTITY_SIZE 7
+
+typedef struct
+{
+    bool is_signed;
+    float scale;
+    float offset;
+
+} radio_schema_field_t;
+
+// Every quantity goes as count, min, max and mean in 16 bit, raw = (value - offset) * scale, sized to the tag ranges:
+// up to 131 klx for the 83 klx of the lux meter, 20 to 151 kPa and +-16 km for the 20 to 110 kPa of the barometer
+static const struct
+{
+    uint8_t quantities;
+    radio_schema_field_t field[RADIO_SCHEMA_QUANTITIES];
+
+} _radio_schema_table[RADIO_BUFFER_COUNT] =
+{
+    [RADIO_BUFFER_ENCODER] = { 0, { { true, 1.f, 0.f } } },
+    [RADIO_BUFFER_THERMOMETER] = { 1, { { true, 100.f, 0.f } } },
+    [RADIO_BUFFER_HUMIDITY] = { 1, { { false, 10.f, 0.f } } },
+    [RADIO_BUFFER_LUX_METER] = { 1, { { false, 0.5f, 0.f } } },
+    [RADIO_BUFFER_BAROMETER] = { 2, { { false, 0.5f, 20000.f }, { true, 2.f, 0.f } } },
+    [RADIO_BUFFER_CO2] = { 1, { { false, 1.f, 0.f } } }
+};
+
+static size_t _radio_schema_length(radio_buffer_type_t type);
+static uint8_t *_radio_schema_put(uint8_t *buffer, const radio_schema_field_t *field, float value);
+static float _radio_schema_get(const uint8_t *buffer, const radio_schema_field_t *field);
+
+void radio_schema_begin(radio_schema_t *self)
+{
+    self->buffer[0] = RADIO_SCHEMA_VERSION;
+    self->length = 1;
+}
+
+bool radio_schema_add_int(radio_schema_t *self, radio_buffer_type_t type, int value)
+{
+    uint8_t *buffer = &self->buffer[self->length];
+
+    if ((type >= RADIO_BUFFER_COUNT) || (_radio_schema_table[type].quantities != 0) ||
+        (self->length + RADIO_SCHEMA_HEADER + _radio_schema_length(type) > sizeof(self->buffer)))
+    {
+        return false;
+    }
+
+    *buffer++ = type;
+    *buffer++ = _radio_schema_length(type);
+    _radio_schema_put(buffer, &_radio_schema_table[type].field[0], value);
+
+    self->length += RADIO_SCHEMA_HEADER + _radio_schema_length(type);
+
+    return true;
+}
+
+bool radio_schema_add_stats(radio_schema_t *self, radio_buffer_type_t type, uint8_t i2c, sensor_stats_t *first, sensor_stats_t *second)
+{
+    sensor_stats_t *stats[RADIO_SCHEMA_QUANTITIES] = { first, second };
+    uint8_t *buffer = &self->buffer[self->length];
+
+    if ((type >= RADIO_BUFFER_COUNT) || (_radio_schema_table[type].quantities == 0) ||
+        (self->length + RADIO_SCHEMA_HEADER + _radio_schema_length(type) > sizeof(self->buffer)))
+    {
+        return false;
+    }
+
+    *buffer++ = type;
+    *buffer++ = _radio_schema_length(type);
+    *buffer++ = i2c;
+
+    for (size_t i = 0; i < _radio_schema_table[type].quantities; i++)
+    {
+        const radio_schema_field_t *field = &_radio_schema_table[type].field[i];
+
+        if (stats[i] == NULL)
+        {
+            return false;
+        }
+
+        // A window longer than 255 samples still reports its mean right, only the count saturates
+        *buffer++ = stats[i]->count > UINT8_MAX ? UINT8_MAX : stats[i]->count;
+        buffer = _radio_schema_put(buffer, field, stats[i]->min);
+        buffer = _radio_schema_put(buffer, field, stats[i]->max);
+        buffer = _radio_schema_put(buffer, field, sensor_stats_get_mean(stats[i]));
+    }
+
+    self->length += RADIO_SCHEMA_HEADER + _radio_schema_length(type);
+
+    return true;
+}
+
+bool radio_schema_next(const uint8_t *buffer, size_t length, size_t *offset, radio_schema_record_t *record)
+{
+    while (*offset + RADIO_SCHEMA_HEADER <= length)
+    {
+        const uint8_t *value = &buffer[*offset + RADIO_SCHEMA_HEADER];
+        radio_buffer_type_t type = buffer[*offset];
+        size_t record_length = buffer[*offset + 1];
+
+        if (*offset + RADIO_SCHEMA_HEADER + record_length > length)
+        {
+            return false;
+        }
+
+        *offset += RADIO_SCHEMA_HEADER + record_length;
+
+        // Records of unknown types or of another length are from a newer remote, skip them and read on
+        if ((type >= RADIO_BUFFER_COUNT) || (record_length != _radio_schema_length(type)))
+        {
+            continue;
+        }
+
+        memset(record, 0, sizeof(*record));
+
+        record->type = type;
+
+        if (_radio_schema_table[type].quantities == 0)
+        {
+            record->value = (int) _radio_schema_get(value, &_radio_schema_table[type].field[0]);
+
+            return true;
+        }
+
+        record->i2c = *value++;
+
+        for (size_t i = 0; i < _radio_schema_table[type].quantities; i++)
+        {
+            const radio_schema_field_t *field = &_radio_schema_table[type].field[i];
+            sensor_stats_t *stats = &record->stats[i];
+
+            stats->count = value[0];
+            stats->min = _radio_schema_get(&value[1], field);
+            stats->max = _radio_schema_get(&value[3], field);
+            stats->sum = _radio_schema_get(&value[5], field) * stats->count;
+
+            value += RADIO_SCHEMA_QUANTITY_SIZE;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+static size_t _radio_schema_length(radio_buffer_type_t type)
+{
+    uint8_t quantities = _radio_schema_table[type].quantities;
+
+    return quantities == 0 ? 2 : 1 + quantities * RADIO_SCHEMA_QUANTITY_SIZE;
+}
+
+static uint8_t *_radio_schema_put(uint8_t *buffer, const radio_schema_field_t *field, float value)
+{
+    float raw = roundf((value - field->offset) * field->scale);
+    float min = field->is_signed ? INT16_MIN : 0;
+    float max = field->is_signed ? INT16_MAX : UINT16_MAX;
+    uint16_t word;
+
+    // Out of range values stick to the limit instead of wrapping around
+    raw = isnan(raw) ? 0 : raw < min ? min : raw > max ? max : raw;
+    word = field->is_signed ? (uint16_t) (int16_t) raw : (uint16_t) raw;
+
+    buffer[0] = word & 0xff;
+    buffer[1] = word >> 8;
+
+    return buffer + 2;
+}
+
+static float _radio_schema_get(const uint8_t *buffer, const radio_schema_field_t *field)
+{
+    uint16_t word = buffer[0] | (buffer[1] << 8);
+    float raw = field->is_signed ? (float) (int16_t) word : (float) word;
+
+    return raw / field->scale + field->offset;
+}
@@ -0,0 +1,45 @@
+#ifndef _RADIO_SCHEMA_H
+#define _RADIO_SCHEMA_H
+
+#include <bc_common.h>
+#include <sensor_stats.h>
+
+// High bit set marks the TLV schema, a legacy buffer starts with its type below 0x80
+#define RADIO_SCHEMA_VERSION 0x81
+#define RADIO_SCHEMA_SIZE 48
+#define RADIO_SCHEMA_QUANTITIES 2
+
+typedef enum
+{
+    RADIO_BUFFER_ENCODER = 0x00,
+    RADIO_BUFFER_THERMOMETER = 0x01,
+    RADIO_BUFFER_HUMIDITY = 0x02,
+    RADIO_BUFFER_LUX_METER = 0x03,
+    RADIO_BUFFER_BAROMETER = 0x04,
+    RADIO_BUFFER_CO2 = 0x05,
+    RADIO_BUFFER_COUNT = 0x06
+
+} radio_buffer_type_t;
+
+typedef struct
+{
+    uint8_t buffer[RADIO_SCHEMA_SIZE];
+    size_t length;
+
+} radio_schema_t;
+
+typedef struct
+{
+    radio_buffer_type_t type;
+    uint8_t i2c;
+    int value;
+    sensor_stats_t stats[RADIO_SCHEMA_QUANTITIES];
+
+} radio_schema_record_t;
+
+void radio_schema_begin(radio_schema_t *self);
+bool radio_schema_add_int(radio_schema_t *self, radio_buffer_type_t type, int value);
+bool radio_schema_add_stats(radio_schema_t *self, radio_buffer_type_t type, uint8_t i2c, sensor_stats_t *first, sensor_stats_t *second);
+bool radio_schema_next(const uint8_t *buffer, size_t length, size_t *offset, radio_schema_record_t *record);
+
+#endif /* _RADIO_SCHEMA_H */
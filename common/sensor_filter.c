@@ -0,0 +1,100 @@
+#include <sensor_filter.h>
+
+static float _sensor_filter_median(sensor_filter_t *self, size_t count);
+
+void sensor_filter_reset(sensor_filter_t *self)
+{
+    self->length = 0;
+    self->index = 0;
+    self->count = 0;
+    self->accepted = 0;
+    self->sum = 0;
+}
+
+bool sensor_filter_add(sensor_filter_t *self, float value, float *output)
+{
+    const sensor_filter_config_t *config = self->config;
+    size_t oversample = config->oversample < 1 ? 1 : config->oversample > SENSOR_FILTER_LENGTH ? SENSOR_FILTER_LENGTH : config->oversample;
+    bool accept = true;
+
+    // A sample too far from the median of the recent ones is dropped, it still enters the history so a real step wins after a few samples
+    if ((config->type == SENSOR_FILTER_OUTLIER) && (self->length >= 3) && (fabsf(value - _sensor_filter_median(self, self->length)) > config->limit))
+    {
+        self->rejected++;
+        accept = false;
+    }
+
+    self->history[self->index] = value;
+    self->index = (self->index + 1) % SENSOR_FILTER_LENGTH;
+
+    if (self->length < SENSOR_FILTER_LENGTH)
+    {
+        self->length++;
+    }
+
+    if (accept)
+    {
+        self->ema = self->length == 1 ? value : self->ema + config->alpha * (value - self->ema);
+        self->sum += value;
+        self->accepted++;
+    }
+
+    if (++self->count < oversample)
+    {
+        return false;
+    }
+
+    self->count = 0;
+
+    if (self->accepted == 0)
+    {
+        return false;
+    }
+
+    switch (config->type)
+    {
+        case SENSOR_FILTER_MEDIAN:
+        {
+            *output = _sensor_filter_median(self, oversample < self->length ? oversample : self->length);
+            break;
+        }
+        case SENSOR_FILTER_EMA:
+        {
+            *output = self->ema;
+            break;
+        }
+        case SENSOR_FILTER_MEAN:
+        case SENSOR_FILTER_OUTLIER:
+        default:
+        {
+            *output = self->sum / self->accepted;
+            break;
+        }
+    }
+
+    self->sum = 0;
+    self->accepted = 0;
+
+    return true;
+}
+
+static float _sensor_filter_median(sensor_filter_t *self, size_t count)
+{
+    float sorted[SENSOR_FILTER_LENGTH];
+
+    // The newest count samples, insertion sorted, the history is at most a handful of values
+    for (size_t i = 0; i < count; i++)
+    {
+        float value = self->history[(self->index + SENSOR_FILTER_LENGTH - 1 - i) % SENSOR_FILTER_LENGTH];
+        size_t j = i;
+
+        for (; (j > 0) && (sorted[j - 1] > value); j--)
+        {
+            sorted[j] = sorted[j - 1];
+        }
+
+        sorted[j] = value;
+    }
+
+    return (count % 2) != 0 ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) / 2;
+}
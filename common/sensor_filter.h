@@ -0,0 +1,43 @@
+#ifndef _SENSOR_FILTER_H
+#define _SENSOR_FILTER_H
+
+#include <bc_common.h>
+
+#define SENSOR_FILTER_LENGTH 5
+
+typedef enum
+{
+    SENSOR_FILTER_MEAN = 0,
+    SENSOR_FILTER_MEDIAN = 1,
+    SENSOR_FILTER_EMA = 2,
+    SENSOR_FILTER_OUTLIER = 3
+
+} sensor_filter_type_t;
+
+typedef struct
+{
+    sensor_filter_type_t type;
+    uint32_t oversample;
+    float alpha;
+    float limit;
+
+} sensor_filter_config_t;
+
+typedef struct
+{
+    const sensor_filter_config_t *config;
+    float history[SENSOR_FILTER_LENGTH];
+    uint8_t length;
+    uint8_t index;
+    uint8_t count;
+    uint8_t accepted;
+    float sum;
+    float ema;
+    uint32_t rejected;
+
+} sensor_filter_t;
+
+void sensor_filter_reset(sensor_filter_t *self);
+bool sensor_filter_add(sensor_filter_t *self, float value, float *output);
+
+#endif /* _SENSOR_FILTER_H */
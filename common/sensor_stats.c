@@ -0,0 +1,67 @@
+#include <sensor_stats.h>
+
+void sensor_stats_reset(sensor_stats_t *self)
+{
+    self->min = 0;
+    self->max = 0;
+    self->sum = 0;
+    self->count = 0;
+}
+
+bool sensor_stats_add(sensor_stats_t *self, float value)
+{
+    bc_tick_t now = bc_tick_get();
+
+    if (self->count == 0)
+    {
+        self->min = value;
+        self->max = value;
+        self->window_end = now + self->window;
+    }
+    else
+    {
+        if (value < self->min)
+        {
+            self->min = value;
+        }
+
+        if (value > self->max)
+        {
+            self->max = value;
+        }
+    }
+
+    self->sum += value;
+    self->count++;
+
+    // The last value outlives the window so it can be served without waiting for the next sample
+    self->last = value;
+    self->last_tick = now;
+    self->last_valid = true;
+
+    // A window too long for the count is closed early instead of wrapping it
+    return (now >= self->window_end) || (self->count == UINT16_MAX);
+}
+
+float sensor_stats_get_mean(sensor_stats_t *self)
+{
+    if (self->count == 0)
+    {
+        return NAN;
+    }
+
+    return self->sum / self->count;
+}
+
+bool sensor_stats_get_last(sensor_stats_t *self, float *value, bc_tick_t *age)
+{
+    if (!self->last_valid)
+    {
+        return false;
+    }
+
+    *value = self->last;
+    *age = bc_tick_get() - self->last_tick;
+
+    return true;
+}
@@ -0,0 +1,26 @@
+#ifndef _SENSOR_STATS_H
+#define _SENSOR_STATS_H
+
+#include <bc_common.h>
+#include <bc_tick.h>
+
+typedef struct
+{
+    float min;
+    float max;
+    float sum;
+    uint16_t count;
+    bc_tick_t window;
+    bc_tick_t window_end;
+    float last;
+    bc_tick_t last_tick;
+    bool last_valid;
+
+} sensor_stats_t;
+
+void sensor_stats_reset(sensor_stats_t *self);
+bool sensor_stats_add(sensor_stats_t *self, float value);
+float sensor_stats_get_mean(sensor_stats_t *self);
+bool sensor_stats_get_last(sensor_stats_t *self, float *value, bc_tick_t *age);
+
+#endif /* _SENSOR_STATS_H */
@@ -1,125 +1,148 @@
 #include <application.h>
+#define SAMPLE_INTERVAL 60000
 #define UPDATE_INTERVAL 300000
+#define FILTER_ALPHA 0.3f
 
 bc_led_t led;
 
+// Lux and humidity are noisy, they are read three times per sample interval and the median goes on
+static const sensor_filter_config_t temperature_filter = { SENSOR_FILTER_MEAN, 1, FILTER_ALPHA, 2 };
+static const sensor_filter_config_t humidity_filter = { SENSOR_FILTER_MEDIAN, 3, FILTER_ALPHA, 5 };
+static const sensor_filter_config_t lux_meter_filter = { SENSOR_FILTER_MEDIAN, 3, FILTER_ALPHA, 100 };
+static const sensor_filter_config_t barometer_filter = { SENSOR_FILTER_MEAN, 1, FILTER_ALPHA, 100 };
+static const sensor_filter_config_t co2_filter = { SENSOR_FILTER_MEAN, 1, FILTER_ALPHA, 200 };
+
+static struct
+{
+    radio_schema_t schema;
+    bc_scheduler_task_id_t task_id;
+
+} radio_pending;
+
+static void _radio_pub_stats(radio_buffer_type_t type, uint8_t i2c, sensor_stats_t *stats, sensor_stats_t *stats2);
+static void _radio_flush_task(void *param);
+
 void application_init(void)
 {
     bc_led_init(&led, BC_GPIO_LED, false, false);
 
     bc_radio_init();
 
+    radio_schema_begin(&radio_pending.schema);
+    radio_pending.task_id = bc_scheduler_register(_radio_flush_task, NULL, BC_TICK_INFINITY);
+
     static bc_button_t button;
     bc_button_init(&button, BC_GPIO_BUTTON, BC_GPIO_PULL_DOWN, false);
     bc_button_set_event_handler(&button, button_event_handler, NULL);
 
     static bc_tag_temperature_t temperature_tag_0_48;
     bc_tag_temperature_init(&temperature_tag_0_48, BC_I2C_I2C0, BC_TAG_TEMPERATURE_I2C_ADDRESS_DEFAULT);
-    bc_tag_temperature_set_update_interval(&temperature_tag_0_48, UPDATE_INTERVAL);
-    static uint8_t temperature_tag_0_48_i2c = (BC_I2C_I2C0 << 7) | BC_TAG_TEMPERATURE_I2C_ADDRESS_DEFAULT;
-    bc_tag_temperature_set_event_handler(&temperature_tag_0_48, temperature_tag_event_handler, &temperature_tag_0_48_i2c);
+    bc_tag_temperature_set_update_interval(&temperature_tag_0_48, SAMPLE_INTERVAL / temperature_filter.oversample);
+    static sensor_t temperature_tag_0_48_sensor = { .i2c = (BC_I2C_I2C0 << 7) | BC_TAG_TEMPERATURE_I2C_ADDRESS_DEFAULT, .filter.config = &temperature_filter, .stats.window = UPDATE_INTERVAL };
+    bc_tag_temperature_set_event_handler(&temperature_tag_0_48, temperature_tag_event_handler, &temperature_tag_0_48_sensor);
 
     static bc_tag_temperature_t temperature_tag_0_49;
     bc_tag_temperature_init(&temperature_tag_0_49, BC_I2C_I2C0, BC_TAG_TEMPERATURE_I2C_ADDRESS_ALTERNATE);
-    bc_tag_temperature_set_update_interval(&temperature_tag_0_49, UPDATE_INTERVAL);
-    static uint8_t temperature_tag_0_49_i2c = (BC_I2C_I2C0 << 7) | BC_TAG_TEMPERATURE_I2C_ADDRESS_ALTERNATE;
-    bc_tag_temperature_set_event_handler(&temperature_tag_0_49, temperature_tag_event_handler, &temperature_tag_0_49_i2c);
+    bc_tag_temperature_set_update_interval(&temperature_tag_0_49, SAMPLE_INTERVAL / temperature_filter.oversample);
+    static sensor_t temperature_tag_0_49_sensor = { .i2c = (BC_I2C_I2C0 << 7) | BC_TAG_TEMPERATURE_I2C_ADDRESS_ALTERNATE, .filter.config = &temperature_filter, .stats.window = UPDATE_INTERVAL };
+    bc_tag_temperature_set_event_handler(&temperature_tag_0_49, temperature_tag_event_handler, &temperature_tag_0_49_sensor);
 
     static bc_tag_temperature_t temperature_tag_1_48;
     bc_tag_temperature_init(&temperature_tag_1_48, BC_I2C_I2C1, BC_TAG_TEMPERATURE_I2C_ADDRESS_DEFAULT);
-    bc_tag_temperature_set_update_interval(&temperature_tag_1_48, UPDATE_INTERVAL);
-    static uint8_t temperature_tag_1_48_i2c = (BC_I2C_I2C1 << 7) | BC_TAG_TEMPERATURE_I2C_ADDRESS_DEFAULT;
-    bc_tag_temperature_set_event_handler(&temperature_tag_1_48, temperature_tag_event_handler,&temperature_tag_1_48_i2c);
+    bc_tag_temperature_set_update_interval(&temperature_tag_1_48, SAMPLE_INTERVAL / temperature_filter.oversample);
+    static sensor_t temperature_tag_1_48_sensor = { .i2c = (BC_I2C_I2C1 << 7) | BC_TAG_TEMPERATURE_I2C_ADDRESS_DEFAULT, .filter.config = &temperature_filter, .stats.window = UPDATE_INTERVAL };
+    bc_tag_temperature_set_event_handler(&temperature_tag_1_48, temperature_tag_event_handler,&temperature_tag_1_48_sensor);
 
     static bc_tag_temperature_t temperature_tag_1_49;
     bc_tag_temperature_init(&temperature_tag_1_49, BC_I2C_I2C1, BC_TAG_TEMPERATURE_I2C_ADDRESS_ALTERNATE);
-    bc_tag_temperature_set_update_interval(&temperature_tag_1_49, UPDATE_INTERVAL);
-    static uint8_t temperature_tag_1_49_i2c = (BC_I2C_I2C1 << 7) | BC_TAG_TEMPERATURE_I2C_ADDRESS_ALTERNATE;
-    bc_tag_temperature_set_event_handler(&temperature_tag_1_49, temperature_tag_event_handler,&temperature_tag_1_49_i2c);
+    bc_tag_temperature_set_update_interval(&temperature_tag_1_49, SAMPLE_INTERVAL / temperature_filter.oversample);
+    static sensor_t temperature_tag_1_49_sensor = { .i2c = (BC_I2C_I2C1 << 7) | BC_TAG_TEMPERATURE_I2C_ADDRESS_ALTERNATE, .filter.config = &temperature_filter, .stats.window = UPDATE_INTERVAL };
+    bc_tag_temperature_set_event_handler(&temperature_tag_1_49, temperature_tag_event_handler,&temperature_tag_1_49_sensor);
 
     //----------------------------
 
     static bc_tag_humidity_t humidity_tag_r2_0_40;
     bc_tag_humidity_init(&humidity_tag_r2_0_40, BC_TAG_HUMIDITY_REVISION_R2, BC_I2C_I2C0, BC_TAG_HUMIDITY_I2C_ADDRESS_DEFAULT);
-    bc_tag_humidity_set_update_interval(&humidity_tag_r2_0_40, UPDATE_INTERVAL);
-    static uint8_t humidity_tag_r2_0_40_i2c = (BC_I2C_I2C0 << 7) | 0x40;
-    bc_tag_humidity_set_event_handler(&humidity_tag_r2_0_40, humidity_tag_event_handler, &humidity_tag_r2_0_40_i2c);
+    bc_tag_humidity_set_update_interval(&humidity_tag_r2_0_40, SAMPLE_INTERVAL / humidity_filter.oversample);
+    static sensor_t humidity_tag_r2_0_40_sensor = { .i2c = (BC_I2C_I2C0 << 7) | 0x40, .filter.config = &humidity_filter, .stats.window = UPDATE_INTERVAL };
+    bc_tag_humidity_set_event_handler(&humidity_tag_r2_0_40, humidity_tag_event_handler, &humidity_tag_r2_0_40_sensor);
 
     static bc_tag_humidity_t humidity_tag_r2_0_41;
     bc_tag_humidity_init(&humidity_tag_r2_0_41, BC_TAG_HUMIDITY_REVISION_R2, BC_I2C_I2C0, BC_TAG_HUMIDITY_I2C_ADDRESS_ALTERNATE);
-    bc_tag_humidity_set_update_interval(&humidity_tag_r2_0_41, UPDATE_INTERVAL);
-    static uint8_t humidity_tag_r2_0_41_i2c = (BC_I2C_I2C0 << 7) | 0x41;
-    bc_tag_humidity_set_event_handler(&humidity_tag_r2_0_41, humidity_tag_event_handler, &humidity_tag_r2_0_41_i2c);
+    bc_tag_humidity_set_update_interval(&humidity_tag_r2_0_41, SAMPLE_INTERVAL / humidity_filter.oversample);
+    static sensor_t humidity_tag_r2_0_41_sensor = { .i2c = (BC_I2C_I2C0 << 7) | 0x41, .filter.config = &humidity_filter, .stats.window = UPDATE_INTERVAL };
+    bc_tag_humidity_set_event_handler(&humidity_tag_r2_0_41, humidity_tag_event_handler, &humidity_tag_r2_0_41_sensor);
 
     static bc_tag_humidity_t humidity_tag_r1_0_5f;
     bc_tag_humidity_init(&humidity_tag_r1_0_5f, BC_TAG_HUMIDITY_REVISION_R1, BC_I2C_I2C0, BC_TAG_HUMIDITY_I2C_ADDRESS_DEFAULT);
-    bc_tag_humidity_set_update_interval(&humidity_tag_r1_0_5f, UPDATE_INTERVAL);
-    static uint8_t humidity_tag_r1_0_5f_i2c = (BC_I2C_I2C0 << 7) | 0x5f;
-    bc_tag_humidity_set_event_handler(&humidity_tag_r1_0_5f, humidity_tag_event_handler, &humidity_tag_r1_0_5f_i2c);
+    bc_tag_humidity_set_update_interval(&humidity_tag_r1_0_5f, SAMPLE_INTERVAL / humidity_filter.oversample);
+    static sensor_t humidity_tag_r1_0_5f_sensor = { .i2c = (BC_I2C_I2C0 << 7) | 0x5f, .filter.config = &humidity_filter, .stats.window = UPDATE_INTERVAL };
+    bc_tag_humidity_set_event_handler(&humidity_tag_r1_0_5f, humidity_tag_event_handler, &humidity_tag_r1_0_5f_sensor);
 
     static bc_tag_humidity_t humidity_tag_r2_1_40;
     bc_tag_humidity_init(&humidity_tag_r2_1_40, BC_TAG_HUMIDITY_REVISION_R2, BC_I2C_I2C1, BC_TAG_HUMIDITY_I2C_ADDRESS_DEFAULT);
-    bc_tag_humidity_set_update_interval(&humidity_tag_r2_1_40, UPDATE_INTERVAL);
-    static uint8_t humidity_tag_r2_1_40_i2c = (BC_I2C_I2C1 << 7) | 0x40;
-    bc_tag_humidity_set_event_handler(&humidity_tag_r2_1_40, humidity_tag_event_handler, &humidity_tag_r2_1_40_i2c);
+    bc_tag_humidity_set_update_interval(&humidity_tag_r2_1_40, SAMPLE_INTERVAL / humidity_filter.oversample);
+    static sensor_t humidity_tag_r2_1_40_sensor = { .i2c = (BC_I2C_I2C1 << 7) | 0x40, .filter.config = &humidity_filter, .stats.window = UPDATE_INTERVAL };
+    bc_tag_humidity_set_event_handler(&humidity_tag_r2_1_40, humidity_tag_event_handler, &humidity_tag_r2_1_40_sensor);
 
     static bc_tag_humidity_t humidity_tag_r2_1_41;
     bc_tag_humidity_init(&humidity_tag_r2_1_41, BC_TAG_HUMIDITY_REVISION_R2, BC_I2C_I2C1, BC_TAG_HUMIDITY_I2C_ADDRESS_ALTERNATE);
-    bc_tag_humidity_set_update_interval(&humidity_tag_r2_1_41, UPDATE_INTERVAL);
-    static uint8_t humidity_tag_r2_1_41_i2c = (BC_I2C_I2C1 << 7) | 0x41;
-    bc_tag_humidity_set_event_handler(&humidity_tag_r2_1_41, humidity_tag_event_handler, &humidity_tag_r2_1_41_i2c);
+    bc_tag_humidity_set_update_interval(&humidity_tag_r2_1_41, SAMPLE_INTERVAL / humidity_filter.oversample);
+    static sensor_t humidity_tag_r2_1_41_sensor = { .i2c = (BC_I2C_I2C1 << 7) | 0x41, .filter.config = &humidity_filter, .stats.window = UPDATE_INTERVAL };
+    bc_tag_humidity_set_event_handler(&humidity_tag_r2_1_41, humidity_tag_event_handler, &humidity_tag_r2_1_41_sensor);
 
     static bc_tag_humidity_t humidity_tag_r1_1_5f;
     bc_tag_humidity_init(&humidity_tag_r1_1_5f, BC_TAG_HUMIDITY_REVISION_R1, BC_I2C_I2C1, BC_TAG_HUMIDITY_I2C_ADDRESS_DEFAULT);
-    bc_tag_humidity_set_update_interval(&humidity_tag_r1_1_5f, UPDATE_INTERVAL);
-    static uint8_t humidity_tag_r1_1_5f_i2c = (BC_I2C_I2C1 << 7) | 0x5f;
-    bc_tag_humidity_set_event_handler(&humidity_tag_r1_1_5f, humidity_tag_event_handler, &humidity_tag_r1_1_5f_i2c);
+    bc_tag_humidity_set_update_interval(&humidity_tag_r1_1_5f, SAMPLE_INTERVAL / humidity_filter.oversample);
+    static sensor_t humidity_tag_r1_1_5f_sensor = { .i2c = (BC_I2C_I2C1 << 7) | 0x5f, .filter.config = &humidity_filter, .stats.window = UPDATE_INTERVAL };
+    bc_tag_humidity_set_event_handler(&humidity_tag_r1_1_5f, humidity_tag_event_handler, &humidity_tag_r1_1_5f_sensor);
 
     //----------------------------
 
     static bc_tag_lux_meter_t lux_meter_0_44;
     bc_tag_lux_meter_init(&lux_meter_0_44, BC_I2C_I2C0, BC_TAG_LUX_METER_I2C_ADDRESS_DEFAULT);
-    bc_tag_lux_meter_set_update_interval(&lux_meter_0_44, UPDATE_INTERVAL);
-    static uint8_t lux_meter_0_44_i2c = (BC_I2C_I2C0 << 7) | BC_TAG_LUX_METER_I2C_ADDRESS_DEFAULT;
-    bc_tag_lux_meter_set_event_handler(&lux_meter_0_44, lux_meter_event_handler, &lux_meter_0_44_i2c);
+    bc_tag_lux_meter_set_update_interval(&lux_meter_0_44, SAMPLE_INTERVAL / lux_meter_filter.oversample);
+    static sensor_t lux_meter_0_44_sensor = { .i2c = (BC_I2C_I2C0 << 7) | BC_TAG_LUX_METER_I2C_ADDRESS_DEFAULT, .filter.config = &lux_meter_filter, .stats.window = UPDATE_INTERVAL };
+    bc_tag_lux_meter_set_event_handler(&lux_meter_0_44, lux_meter_event_handler, &lux_meter_0_44_sensor);
 
     static bc_tag_lux_meter_t lux_meter_0_45;
     bc_tag_lux_meter_init(&lux_meter_0_45, BC_I2C_I2C0, BC_TAG_LUX_METER_I2C_ADDRESS_ALTERNATE);
-    bc_tag_lux_meter_set_update_interval(&lux_meter_0_45, UPDATE_INTERVAL);
-    static uint8_t lux_meter_0_45_i2c = (BC_I2C_I2C0 << 7) | BC_TAG_LUX_METER_I2C_ADDRESS_ALTERNATE;
-    bc_tag_lux_meter_set_event_handler(&lux_meter_0_45, lux_meter_event_handler, &lux_meter_0_45_i2c);
+    bc_tag_lux_meter_set_update_interval(&lux_meter_0_45, SAMPLE_INTERVAL / lux_meter_filter.oversample);
+    static sensor_t lux_meter_0_45_sensor = { .i2c = (BC_I2C_I2C0 << 7) | BC_TAG_LUX_METER_I2C_ADDRESS_ALTERNATE, .filter.config = &lux_meter_filter, .stats.window = UPDATE_INTERVAL };
+    bc_tag_lux_meter_set_event_handler(&lux_meter_0_45, lux_meter_event_handler, &lux_meter_0_45_sensor);
 
     static bc_tag_lux_meter_t lux_meter_1_44;
     bc_tag_lux_meter_init(&lux_meter_1_44, BC_I2C_I2C1, BC_TAG_LUX_METER_I2C_ADDRESS_DEFAULT);
-    bc_tag_lux_meter_set_update_interval(&lux_meter_1_44, UPDATE_INTERVAL);
-    static uint8_t lux_meter_1_44_i2c = (BC_I2C_I2C1 << 7) | BC_TAG_LUX_METER_I2C_ADDRESS_DEFAULT;
-    bc_tag_lux_meter_set_event_handler(&lux_meter_1_44, lux_meter_event_handler, &lux_meter_1_44_i2c);
+    bc_tag_lux_meter_set_update_interval(&lux_meter_1_44, SAMPLE_INTERVAL / lux_meter_filter.oversample);
+    static sensor_t lux_meter_1_44_sensor = { .i2c = (BC_I2C_I2C1 << 7) | BC_TAG_LUX_METER_I2C_ADDRESS_DEFAULT, .filter.config = &lux_meter_filter, .stats.window = UPDATE_INTERVAL };
+    bc_tag_lux_meter_set_event_handler(&lux_meter_1_44, lux_meter_event_handler, &lux_meter_1_44_sensor);
 
     static bc_tag_lux_meter_t lux_meter_1_45;
     bc_tag_lux_meter_init(&lux_meter_1_45, BC_I2C_I2C1, BC_TAG_LUX_METER_I2C_ADDRESS_ALTERNATE);
-    bc_tag_lux_meter_set_update_interval(&lux_meter_1_45, UPDATE_INTERVAL);
-    static uint8_t lux_meter_1_45_i2c = (BC_I2C_I2C1 << 7) | BC_TAG_LUX_METER_I2C_ADDRESS_ALTERNATE;
-    bc_tag_lux_meter_set_event_handler(&lux_meter_1_45, lux_meter_event_handler, &lux_meter_1_45_i2c);
+    bc_tag_lux_meter_set_update_interval(&lux_meter_1_45, SAMPLE_INTERVAL / lux_meter_filter.oversample);
+    static sensor_t lux_meter_1_45_sensor = { .i2c = (BC_I2C_I2C1 << 7) | BC_TAG_LUX_METER_I2C_ADDRESS_ALTERNATE, .filter.config = &lux_meter_filter, .stats.window = UPDATE_INTERVAL };
+    bc_tag_lux_meter_set_event_handler(&lux_meter_1_45, lux_meter_event_handler, &lux_meter_1_45_sensor);
 
     //----------------------------
 
     static bc_tag_barometer_t barometer_tag_0;
     bc_tag_barometer_init(&barometer_tag_0, BC_I2C_I2C0);
-    bc_tag_barometer_set_update_interval(&barometer_tag_0, UPDATE_INTERVAL);
-    static uint8_t barometer_tag_0_i2c = (BC_I2C_I2C0 << 7) | 0x60;
-    bc_tag_barometer_set_event_handler(&barometer_tag_0, barometer_tag_event_handler, &barometer_tag_0_i2c);
+    bc_tag_barometer_set_update_interval(&barometer_tag_0, SAMPLE_INTERVAL / barometer_filter.oversample);
+    static barometer_t barometer_tag_0_sensor = { .i2c = (BC_I2C_I2C0 << 7) | 0x60, .pressure_filter.config = &barometer_filter, .altitude_filter.config = &barometer_filter, .pressure.window = UPDATE_INTERVAL, .altitude.window = UPDATE_INTERVAL };
+    bc_tag_barometer_set_event_handler(&barometer_tag_0, barometer_tag_event_handler, &barometer_tag_0_sensor);
 
     static bc_tag_barometer_t barometer_tag_1;
     bc_tag_barometer_init(&barometer_tag_1, BC_I2C_I2C1);
-    bc_tag_barometer_set_update_interval(&barometer_tag_1, UPDATE_INTERVAL);
-    static uint8_t barometer_tag_1_i2c = (BC_I2C_I2C1 << 7) | 0x60;
-    bc_tag_barometer_set_event_handler(&barometer_tag_1, barometer_tag_event_handler, &barometer_tag_1_i2c);
+    bc_tag_barometer_set_update_interval(&barometer_tag_1, SAMPLE_INTERVAL / barometer_filter.oversample);
+    static barometer_t barometer_tag_1_sensor = { .i2c = (BC_I2C_I2C1 << 7) | 0x60, .pressure_filter.config = &barometer_filter, .altitude_filter.config = &barometer_filter, .pressure.window = UPDATE_INTERVAL, .altitude.window = UPDATE_INTERVAL };
+    bc_tag_barometer_set_event_handler(&barometer_tag_1, barometer_tag_event_handler, &barometer_tag_1_sensor);
 
     //----------------------------
 
     bc_module_co2_init();
-    bc_module_co2_set_update_interval(UPDATE_INTERVAL);
-    bc_module_co2_set_event_handler(co2_event_handler, NULL);
+    bc_module_co2_set_update_interval(SAMPLE_INTERVAL / co2_filter.oversample);
+    static sensor_t co2_sensor = { .filter.config = &co2_filter, .stats.window = UPDATE_INTERVAL };
+    bc_module_co2_set_event_handler(co2_event_handler, &co2_sensor);
 
     // ---------------------------
 
@@ -153,6 +176,7 @@ void button_event_handler(bc_button_t *self, bc_button_event_t event, void *even
 
 void temperature_tag_event_handler(bc_tag_temperature_t *self, bc_tag_temperature_event_t event, void *event_param)
 {
+    sensor_t *sensor = (sensor_t *) event_param;
     float value;
 
     if (event != BC_TAG_TEMPERATURE_EVENT_UPDATE)
@@ -160,14 +184,19 @@ void temperature_tag_event_handler(bc_tag_temperature_t *self, bc_tag_temperatur
         return;
     }
 
-    if (bc_tag_temperature_get_temperature_celsius(self, &value))
+    if (bc_tag_temperature_get_temperature_celsius(self, &value) && sensor_filter_add(&sensor->filter, value, &value))
     {
-        bc_radio_pub_thermometer(*(uint8_t *)event_param, &value);
+        if (sensor_stats_add(&sensor->stats, value))
+        {
+            _radio_pub_stats(RADIO_BUFFER_THERMOMETER, sensor->i2c, &sensor->stats, NULL);
+            sensor_stats_reset(&sensor->stats);
+        }
     }
 }
 
 void humidity_tag_event_handler(bc_tag_humidity_t *self, bc_tag_humidity_event_t event, void *event_param)
 {
+    sensor_t *sensor = (sensor_t *) event_param;
     float value;
 
     if (event != BC_TAG_HUMIDITY_EVENT_UPDATE)
@@ -175,14 +204,19 @@ void humidity_tag_event_handler(bc_tag_humidity_t *self, bc_tag_humidity_event_t
         return;
     }
 
-    if (bc_tag_humidity_get_humidity_percentage(self, &value))
+    if (bc_tag_humidity_get_humidity_percentage(self, &value) && sensor_filter_add(&sensor->filter, value, &value))
     {
-        bc_radio_pub_humidity(*(uint8_t *)event_param, &value);
+        if (sensor_stats_add(&sensor->stats, value))
+        {
+            _radio_pub_stats(RADIO_BUFFER_HUMIDITY, sensor->i2c, &sensor->stats, NULL);
+            sensor_stats_reset(&sensor->stats);
+        }
     }
 }
 
 void lux_meter_event_handler(bc_tag_lux_meter_t *self, bc_tag_lux_meter_event_t event, void *event_param)
 {
+    sensor_t *sensor = (sensor_t *) event_param;
     float value;
 
     if (event != BC_TAG_LUX_METER_EVENT_UPDATE)
@@ -190,14 +224,19 @@ void lux_meter_event_handler(bc_tag_lux_meter_t *self, bc_tag_lux_meter_event_t
         return;
     }
 
-    if (bc_tag_lux_meter_get_luminosity_lux(self, &value))
+    if (bc_tag_lux_meter_get_luminosity_lux(self, &value) && sensor_filter_add(&sensor->filter, value, &value))
     {
-        bc_radio_pub_luminosity(*(uint8_t *)event_param, &value);
+        if (sensor_stats_add(&sensor->stats, value))
+        {
+            _radio_pub_stats(RADIO_BUFFER_LUX_METER, sensor->i2c, &sensor->stats, NULL);
+            sensor_stats_reset(&sensor->stats);
+        }
     }
 }
 
 void barometer_tag_event_handler(bc_tag_barometer_t *self, bc_tag_barometer_event_t event, void *event_param)
 {
+    barometer_t *sensor = (barometer_t *) event_param;
     float pascal;
     float meter;
 
@@ -216,20 +255,34 @@ void barometer_tag_event_handler(bc_tag_barometer_t *self, bc_tag_barometer_even
         return;
     }
 
-    bc_radio_pub_barometer(*(uint8_t *)event_param, &pascal, &meter);
+    if (sensor_filter_add(&sensor->altitude_filter, meter, &meter))
+    {
+        sensor_stats_add(&sensor->altitude, meter);
+    }
+
+    if (sensor_filter_add(&sensor->pressure_filter, pascal, &pascal) && sensor_stats_add(&sensor->pressure, pascal))
+    {
+        _radio_pub_stats(RADIO_BUFFER_BAROMETER, sensor->i2c, &sensor->pressure, &sensor->altitude);
+        sensor_stats_reset(&sensor->pressure);
+        sensor_stats_reset(&sensor->altitude);
+    }
 
 }
 
 void co2_event_handler(bc_module_co2_event_t event, void *event_param)
 {
-    (void) event_param;
+    sensor_t *sensor = (sensor_t *) event_param;
     float value;
 
     if (event == BC_MODULE_CO2_EVENT_UPDATE)
     {
-        if (bc_module_co2_get_concentration(&value))
+        if (bc_module_co2_get_concentration(&value) && sensor_filter_add(&sensor->filter, value, &value))
         {
-            bc_radio_pub_co2(&value);
+            if (sensor_stats_add(&sensor->stats, value))
+            {
+                _radio_pub_stats(RADIO_BUFFER_CO2, 0, &sensor->stats, NULL);
+                sensor_stats_reset(&sensor->stats);
+            }
         }
     }
 }
@@ -241,9 +294,37 @@ void encoder_event_handler(bc_module_encoder_event_t event, void *param)
     if (event == BC_MODULE_ENCODER_EVENT_ROTATION)
     {
         int increment = bc_module_encoder_get_increment();
-        uint8_t buffer[1 + sizeof(increment)];
-        buffer[0] = 0x00;
-        memcpy(&buffer[1], &increment, sizeof(increment));
-        bc_radio_pub_buffer(&buffer, sizeof(buffer));
+
+        if (!radio_schema_add_int(&radio_pending.schema, RADIO_BUFFER_ENCODER, increment))
+        {
+            _radio_flush_task(NULL);
+            radio_schema_add_int(&radio_pending.schema, RADIO_BUFFER_ENCODER, increment);
+        }
+
+        bc_scheduler_plan_now(radio_pending.task_id);
+    }
+}
+
+static void _radio_pub_stats(radio_buffer_type_t type, uint8_t i2c, sensor_stats_t *stats, sensor_stats_t *stats2)
+{
+    // Records of one scheduler pass share a packet, a full packet goes out before the next record
+    if (!radio_schema_add_stats(&radio_pending.schema, type, i2c, stats, stats2))
+    {
+        _radio_flush_task(NULL);
+        radio_schema_add_stats(&radio_pending.schema, type, i2c, stats, stats2);
     }
+
+    bc_scheduler_plan_now(radio_pending.task_id);
+}
+
+static void _radio_flush_task(void *param)
+{
+    (void) param;
+
+    if (radio_pending.schema.length > 1)
+    {
+        bc_radio_pub_buffer(radio_pending.schema.buffer, radio_pending.schema.length);
+    }
+
+    radio_schema_begin(&radio_pending.schema);
 }
@@ -3,6 +3,27 @@
 
 #include <bc_common.h>
 #include <bcl.h>
+#include <sensor_stats.h>
+#include <sensor_filter.h>
+#include <radio_schema.h>
+
+typedef struct
+{
+    uint8_t i2c;
+    sensor_filter_t filter;
+    sensor_stats_t stats;
+
+} sensor_t;
+
+typedef struct
+{
+    uint8_t i2c;
+    sensor_filter_t pressure_filter;
+    sensor_filter_t altitude_filter;
+    sensor_stats_t pressure;
+    sensor_stats_t altitude;
+
+} barometer_t;
 
 void button_event_handler(bc_button_t *self, bc_button_event_t event, void *event_param);
 void temperature_tag_event_handler(bc_tag_temperature_t *self, bc_tag_temperature_event_t event, void *event_param);
@@ -0,0 +1,174 @@
+#include <b64.h>
+#include <base64.h>
+#include <time.h>
+
+#define BENCH_PIXELS 150
+#define BENCH_ROUNDS 20000
+
+static uint8_t _bench_output[BENCH_PIXELS * 4 + 3];
+
+static bool _bench_sdk(const char *input, size_t length);
+static bool _bench_characters(const char *input, size_t length);
+static bool _bench_quanta(const char *input, size_t length);
+static void _bench_run(const char *name, bool (*decode)(const char *, size_t), const char *input, size_t length, const uint8_t *expected);
+static void _bench_encode(const uint8_t *input, size_t length, char *output);
+static double _bench_time_get(void);
+
+int main(void)
+{
+    static uint8_t framebuffer[BENCH_PIXELS * 4];
+    static char input[BENCH_PIXELS * 4 / 3 * 4 + 5];
+    uint32_t random = 1;
+
+    for (size_t i = 0; i < sizeof(framebuffer); i++)
+    {
+        random = random * 1664525UL + 1013904223UL;
+        framebuffer[i] = random >> 24;
+    }
+
+    _bench_encode(framebuffer, sizeof(framebuffer), input);
+
+    printf("%zu bytes of base64 for %d RGBW pixels, %d rounds\n", strlen(input), BENCH_PIXELS, BENCH_ROUNDS);
+
+    _bench_run("sdk", _bench_sdk, input, strlen(input), framebuffer);
+    _bench_run("characters", _bench_characters, input, strlen(input), framebuffer);
+    _bench_run("quanta", _bench_quanta, input, strlen(input), framebuffer);
+
+    return 0;
+}
+
+// Length pass and decode pass, like the SDK decoder the payload getters used before. The SDK is not built here,
+// this runs the simulator's stand-in from sim/src/sim_base64.c, so the number only approximates the SDK
+static bool _bench_sdk(const char *input, size_t length)
+{
+    uint32_t output_length = sizeof(_bench_output);
+
+    if (base64_calculate_decode_length(input, length) > output_length)
+    {
+        return false;
+    }
+
+    return base64_decode(input, length, _bench_output, &output_length);
+}
+
+// The character by character decoder of the streaming framebuffer path
+static bool _bench_characters(const char *input, size_t length)
+{
+    uint32_t bits = 0;
+    size_t count = 0;
+    size_t padding = 0;
+    size_t position = 0;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        char character = input[i];
+        uint32_t value;
+
+        if (character >= 'A' && character <= 'Z')
+        {
+            value = character - 'A';
+        }
+        else if (character >= 'a' && character <= 'z')
+        {
+            value = character - 'a' + 26;
+        }
+        else if (character >= '0' && character <= '9')
+        {
+            value = character - '0' + 52;
+        }
+        else if (character == '+')
+        {
+            value = 62;
+        }
+        else if (character == '/')
+        {
+            value = 63;
+        }
+        else if (character == '=' && count >= 2)
+        {
+            value = 0;
+            padding++;
+        }
+        else
+        {
+            return false;
+        }
+
+        bits = (bits << 6) | value;
+
+        if (++count < 4)
+        {
+            continue;
+        }
+
+        _bench_output[position] = bits >> 16;
+        _bench_output[position + 1] = bits >> 8;
+        _bench_output[position + 2] = bits;
+
+        position += 3 - padding;
+        bits = 0;
+        count = 0;
+    }
+
+    return count == 0;
+}
+
+static bool _bench_quanta(const char *input, size_t length)
+{
+    return b64_decode_quanta(input, length / 4, _bench_output) == length / 4;
+}
+
+static void _bench_run(const char *name, bool (*decode)(const char *, size_t), const char *input, size_t length, const uint8_t *expected)
+{
+    memset(_bench_output, 0, sizeof(_bench_output));
+
+    if (!decode(input, length) || (memcmp(_bench_output, expected, BENCH_PIXELS * 4) != 0))
+    {
+        printf("%-10s wrong output\n", name);
+        return;
+    }
+
+    double start = _bench_time_get();
+
+    for (int i = 0; i < BENCH_ROUNDS; i++)
+    {
+        decode(input, length);
+
+        // Keep the compiler from dropping the rounds
+        __asm__ volatile("" : : "r"(_bench_output) : "memory");
+    }
+
+    double elapsed = _bench_time_get() - start;
+
+    printf("%-10s %8.1f MB/s %8.0f ns per frame\n", name, length * (double) BENCH_ROUNDS / elapsed / 1e6,
+           elapsed / BENCH_ROUNDS * 1e9);
+}
+
+static void _bench_encode(const uint8_t *input, size_t length, char *output)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    for (size_t i = 0; i < length; i += 3)
+    {
+        uint32_t bits = (uint32_t) input[i] << 16;
+
+        bits |= i + 1 < length ? (uint32_t) input[i + 1] << 8 : 0;
+        bits |= i + 2 < length ? input[i + 2] : 0;
+
+        *output++ = alphabet[(bits >> 18) & 0x3f];
+        *output++ = alphabet[(bits >> 12) & 0x3f];
+        *output++ = i + 1 < length ? alphabet[(bits >> 6) & 0x3f] : '=';
+        *output++ = i + 2 < length ? alphabet[bits & 0x3f] : '=';
+    }
+
+    *output = '\0';
+}
+
+static double _bench_time_get(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
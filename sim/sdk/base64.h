@@ -0,0 +1,9 @@
+#ifndef _BASE64_H
+#define _BASE64_H
+
+#include <bc_common.h>
+
+bool base64_decode(const char *input, uint32_t input_length, uint8_t *output, uint32_t *output_length);
+uint32_t base64_calculate_decode_length(const char *input, uint32_t length);
+
+#endif /* _BASE64_H */
@@ -0,0 +1,30 @@
+#ifndef _BC_BUTTON_H
+#define _BC_BUTTON_H
+
+#include <bc_gpio.h>
+#include <bc_scheduler.h>
+
+typedef enum
+{
+    BC_BUTTON_EVENT_PRESS = 0,
+    BC_BUTTON_EVENT_RELEASE = 1,
+    BC_BUTTON_EVENT_CLICK = 2,
+    BC_BUTTON_EVENT_HOLD = 3
+
+} bc_button_event_t;
+
+typedef struct bc_button_t bc_button_t;
+
+struct bc_button_t
+{
+    void *_node;
+    bc_gpio_channel_t _channel;
+    void (*_event_handler)(bc_button_t *, bc_button_event_t, void *);
+    void *_event_param;
+
+};
+
+void bc_button_init(bc_button_t *self, bc_gpio_channel_t gpio_channel, bc_gpio_pull_t gpio_pull, bool idle_state);
+void bc_button_set_event_handler(bc_button_t *self, void (*event_handler)(bc_button_t *, bc_button_event_t, void *), void *event_param);
+
+#endif /* _BC_BUTTON_H */
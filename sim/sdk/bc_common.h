@@ -0,0 +1,16 @@
+#ifndef _BC_COMMON_H
+#define _BC_COMMON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <inttypes.h>
+#include <math.h>
+
+#define BC_SCHEDULER_MAX_TASKS 32
+
+#endif /* _BC_COMMON_H */
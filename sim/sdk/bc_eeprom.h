@@ -0,0 +1,10 @@
+#ifndef _BC_EEPROM_H
+#define _BC_EEPROM_H
+
+#include <bc_common.h>
+
+bool bc_eeprom_write(uint32_t address, const void *buffer, size_t length);
+bool bc_eeprom_read(uint32_t address, void *buffer, size_t length);
+size_t bc_eeprom_get_size(void);
+
+#endif /* _BC_EEPROM_H */
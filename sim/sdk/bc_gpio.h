@@ -0,0 +1,39 @@
+#ifndef _BC_GPIO_H
+#define _BC_GPIO_H
+
+#include <bc_common.h>
+
+typedef enum
+{
+    BC_GPIO_P0 = 0,
+    BC_GPIO_P1 = 1,
+    BC_GPIO_P2 = 2,
+    BC_GPIO_P3 = 3,
+    BC_GPIO_P4 = 4,
+    BC_GPIO_P5 = 5,
+    BC_GPIO_P6 = 6,
+    BC_GPIO_P7 = 7,
+    BC_GPIO_P8 = 8,
+    BC_GPIO_P9 = 9,
+    BC_GPIO_P10 = 10,
+    BC_GPIO_P11 = 11,
+    BC_GPIO_P12 = 12,
+    BC_GPIO_P13 = 13,
+    BC_GPIO_P14 = 14,
+    BC_GPIO_P15 = 15,
+    BC_GPIO_P16 = 16,
+    BC_GPIO_P17 = 17,
+    BC_GPIO_LED = 18,
+    BC_GPIO_BUTTON = 19
+
+} bc_gpio_channel_t;
+
+typedef enum
+{
+    BC_GPIO_PULL_NONE = 0,
+    BC_GPIO_PULL_UP = 1,
+    BC_GPIO_PULL_DOWN = 2
+
+} bc_gpio_pull_t;
+
+#endif /* _BC_GPIO_H */
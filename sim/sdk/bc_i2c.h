@@ -0,0 +1,13 @@
+#ifndef _BC_I2C_H
+#define _BC_I2C_H
+
+#include <bc_common.h>
+
+typedef enum
+{
+    BC_I2C_I2C0 = 0,
+    BC_I2C_I2C1 = 1
+
+} bc_i2c_channel_t;
+
+#endif /* _BC_I2C_H */
@@ -0,0 +1,30 @@
+#ifndef _BC_LED_H
+#define _BC_LED_H
+
+#include <bc_gpio.h>
+#include <bc_scheduler.h>
+
+typedef enum
+{
+    BC_LED_MODE_OFF = 0,
+    BC_LED_MODE_ON = 1,
+    BC_LED_MODE_BLINK = 2,
+    BC_LED_MODE_BLINK_SLOW = 3,
+    BC_LED_MODE_BLINK_FAST = 4,
+    BC_LED_MODE_FLASH = 5
+
+} bc_led_mode_t;
+
+typedef struct
+{
+    void *_node;
+    bc_gpio_channel_t _channel;
+    bc_led_mode_t _mode;
+
+} bc_led_t;
+
+void bc_led_init(bc_led_t *self, bc_gpio_channel_t gpio_channel, bool open_drain_output, bool idle_state);
+void bc_led_set_mode(bc_led_t *self, bc_led_mode_t mode);
+void bc_led_pulse(bc_led_t *self, bc_tick_t duration);
+
+#endif /* _BC_LED_H */
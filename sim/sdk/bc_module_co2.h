@@ -0,0 +1,18 @@
+#ifndef _BC_MODULE_CO2_H
+#define _BC_MODULE_CO2_H
+
+#include <bc_scheduler.h>
+
+typedef enum
+{
+    BC_MODULE_CO2_EVENT_ERROR = 0,
+    BC_MODULE_CO2_EVENT_UPDATE = 1
+
+} bc_module_co2_event_t;
+
+void bc_module_co2_init(void);
+void bc_module_co2_set_event_handler(void (*event_handler)(bc_module_co2_event_t, void *), void *event_param);
+void bc_module_co2_set_update_interval(bc_tick_t interval);
+bool bc_module_co2_get_concentration(float *ppm);
+
+#endif /* _BC_MODULE_CO2_H */
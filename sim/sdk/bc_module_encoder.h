@@ -0,0 +1,21 @@
+#ifndef _BC_MODULE_ENCODER_H
+#define _BC_MODULE_ENCODER_H
+
+#include <bc_common.h>
+
+typedef enum
+{
+    BC_MODULE_ENCODER_EVENT_ROTATION = 0,
+    BC_MODULE_ENCODER_EVENT_PRESS = 1,
+    BC_MODULE_ENCODER_EVENT_RELEASE = 2,
+    BC_MODULE_ENCODER_EVENT_CLICK = 3,
+    BC_MODULE_ENCODER_EVENT_HOLD = 4,
+    BC_MODULE_ENCODER_EVENT_ERROR = 5
+
+} bc_module_encoder_event_t;
+
+bool bc_module_encoder_init(void);
+void bc_module_encoder_set_event_handler(void (*event_handler)(bc_module_encoder_event_t, void *), void *event_param);
+int bc_module_encoder_get_increment(void);
+
+#endif /* _BC_MODULE_ENCODER_H */
@@ -0,0 +1,35 @@
+#ifndef _BC_MODULE_LCD_H
+#define _BC_MODULE_LCD_H
+
+#include <bc_common.h>
+
+typedef struct
+{
+    const char *name;
+    int width;
+    int height;
+
+} bc_font_t;
+
+typedef struct
+{
+    uint8_t buffer[128 * 128 / 8];
+
+} bc_module_lcd_framebuffer_t;
+
+extern bc_module_lcd_framebuffer_t _bc_module_lcd_framebuffer;
+
+extern const bc_font_t bc_font_ubuntu_11;
+extern const bc_font_t bc_font_ubuntu_13;
+extern const bc_font_t bc_font_ubuntu_15;
+extern const bc_font_t bc_font_ubuntu_24;
+extern const bc_font_t bc_font_ubuntu_28;
+extern const bc_font_t bc_font_ubuntu_33;
+
+void bc_module_lcd_init(bc_module_lcd_framebuffer_t *framebuffer);
+void bc_module_lcd_clear(void);
+void bc_module_lcd_set_font(const bc_font_t *font);
+int bc_module_lcd_draw_string(int left, int top, char *str);
+bool bc_module_lcd_update(void);
+
+#endif /* _BC_MODULE_LCD_H */
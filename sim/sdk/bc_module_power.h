@@ -0,0 +1,11 @@
+#ifndef _BC_MODULE_POWER_H
+#define _BC_MODULE_POWER_H
+
+#include <bc_led_strip.h>
+
+void bc_module_power_init(void);
+void bc_module_power_relay_set_state(bool state);
+bool bc_module_power_relay_get_state(void);
+const bc_led_strip_driver_t *bc_module_power_get_led_strip_driver(void);
+
+#endif /* _BC_MODULE_POWER_H */
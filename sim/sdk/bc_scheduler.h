@@ -0,0 +1,18 @@
+#ifndef _BC_SCHEDULER_H
+#define _BC_SCHEDULER_H
+
+#include <bc_tick.h>
+
+typedef size_t bc_scheduler_task_id_t;
+
+bc_scheduler_task_id_t bc_scheduler_register(void (*task)(void *), void *param, bc_tick_t tick);
+void bc_scheduler_unregister(bc_scheduler_task_id_t task_id);
+bc_scheduler_task_id_t bc_scheduler_get_current_task_id(void);
+void bc_scheduler_plan_now(bc_scheduler_task_id_t task_id);
+void bc_scheduler_plan_absolute(bc_scheduler_task_id_t task_id, bc_tick_t tick);
+void bc_scheduler_plan_relative(bc_scheduler_task_id_t task_id, bc_tick_t tick);
+void bc_scheduler_plan_current_now(void);
+void bc_scheduler_plan_current_absolute(bc_tick_t tick);
+void bc_scheduler_plan_current_relative(bc_tick_t tick);
+
+#endif /* _BC_SCHEDULER_H */
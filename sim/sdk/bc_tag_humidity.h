@@ -0,0 +1,38 @@
+#ifndef _BC_TAG_HUMIDITY_H
+#define _BC_TAG_HUMIDITY_H
+
+#include <sim_sensor.h>
+
+#define BC_TAG_HUMIDITY_I2C_ADDRESS_DEFAULT 0x40
+#define BC_TAG_HUMIDITY_I2C_ADDRESS_ALTERNATE 0x41
+
+typedef enum
+{
+    BC_TAG_HUMIDITY_REVISION_R1 = 0,
+    BC_TAG_HUMIDITY_REVISION_R2 = 1
+
+} bc_tag_humidity_revision_t;
+
+typedef enum
+{
+    BC_TAG_HUMIDITY_EVENT_ERROR = 0,
+    BC_TAG_HUMIDITY_EVENT_UPDATE = 1
+
+} bc_tag_humidity_event_t;
+
+typedef struct bc_tag_humidity_t bc_tag_humidity_t;
+
+struct bc_tag_humidity_t
+{
+    sim_sensor_t _sensor;
+    void (*_event_handler)(bc_tag_humidity_t *, bc_tag_humidity_event_t, void *);
+    void *_event_param;
+
+};
+
+void bc_tag_humidity_init(bc_tag_humidity_t *self, bc_tag_humidity_revision_t revision, bc_i2c_channel_t i2c_channel, uint8_t i2c_address);
+void bc_tag_humidity_set_event_handler(bc_tag_humidity_t *self, void (*event_handler)(bc_tag_humidity_t *, bc_tag_humidity_event_t, void *), void *event_param);
+void bc_tag_humidity_set_update_interval(bc_tag_humidity_t *self, bc_tick_t interval);
+bool bc_tag_humidity_get_humidity_percentage(bc_tag_humidity_t *self, float *percentage);
+
+#endif /* _BC_TAG_HUMIDITY_H */
@@ -0,0 +1,31 @@
+#ifndef _BC_TAG_LUX_METER_H
+#define _BC_TAG_LUX_METER_H
+
+#include <sim_sensor.h>
+
+#define BC_TAG_LUX_METER_I2C_ADDRESS_DEFAULT 0x44
+#define BC_TAG_LUX_METER_I2C_ADDRESS_ALTERNATE 0x45
+
+typedef enum
+{
+    BC_TAG_LUX_METER_EVENT_ERROR = 0,
+    BC_TAG_LUX_METER_EVENT_UPDATE = 1
+
+} bc_tag_lux_meter_event_t;
+
+typedef struct bc_tag_lux_meter_t bc_tag_lux_meter_t;
+
+struct bc_tag_lux_meter_t
+{
+    sim_sensor_t _sensor;
+    void (*_event_handler)(bc_tag_lux_meter_t *, bc_tag_lux_meter_event_t, void *);
+    void *_event_param;
+
+};
+
+void bc_tag_lux_meter_init(bc_tag_lux_meter_t *self, bc_i2c_channel_t i2c_channel, uint8_t i2c_address);
+void bc_tag_lux_meter_set_event_handler(bc_tag_lux_meter_t *self, void (*event_handler)(bc_tag_lux_meter_t *, bc_tag_lux_meter_event_t, void *), void *event_param);
+void bc_tag_lux_meter_set_update_interval(bc_tag_lux_meter_t *self, bc_tick_t interval);
+bool bc_tag_lux_meter_get_luminosity_lux(bc_tag_lux_meter_t *self, float *lux);
+
+#endif /* _BC_TAG_LUX_METER_H */
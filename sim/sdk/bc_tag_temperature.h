@@ -0,0 +1,31 @@
+#ifndef _BC_TAG_TEMPERATURE_H
+#define _BC_TAG_TEMPERATURE_H
+
+#include <sim_sensor.h>
+
+#define BC_TAG_TEMPERATURE_I2C_ADDRESS_DEFAULT 0x48
+#define BC_TAG_TEMPERATURE_I2C_ADDRESS_ALTERNATE 0x49
+
+typedef enum
+{
+    BC_TAG_TEMPERATURE_EVENT_ERROR = 0,
+    BC_TAG_TEMPERATURE_EVENT_UPDATE = 1
+
+} bc_tag_temperature_event_t;
+
+typedef struct bc_tag_temperature_t bc_tag_temperature_t;
+
+struct bc_tag_temperature_t
+{
+    sim_sensor_t _sensor;
+    void (*_event_handler)(bc_tag_temperature_t *, bc_tag_temperature_event_t, void *);
+    void *_event_param;
+
+};
+
+void bc_tag_temperature_init(bc_tag_temperature_t *self, bc_i2c_channel_t i2c_channel, uint8_t i2c_address);
+void bc_tag_temperature_set_event_handler(bc_tag_temperature_t *self, void (*event_handler)(bc_tag_temperature_t *, bc_tag_temperature_event_t, void *), void *event_param);
+void bc_tag_temperature_set_update_interval(bc_tag_temperature_t *self, bc_tick_t interval);
+bool bc_tag_temperature_get_temperature_celsius(bc_tag_temperature_t *self, float *celsius);
+
+#endif /* _BC_TAG_TEMPERATURE_H */
@@ -0,0 +1,12 @@
+#ifndef _BC_TICK_H
+#define _BC_TICK_H
+
+#include <bc_common.h>
+
+#define BC_TICK_INFINITY ((bc_tick_t) -1)
+
+typedef uint64_t bc_tick_t;
+
+bc_tick_t bc_tick_get(void);
+
+#endif /* _BC_TICK_H */
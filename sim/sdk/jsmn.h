@@ -0,0 +1,25 @@
+#ifndef __JSMN_H_
+#define __JSMN_H_
+
+#include <stddef.h>
+
+typedef enum
+{
+    JSMN_UNDEFINED = 0,
+    JSMN_OBJECT = 1,
+    JSMN_ARRAY = 2,
+    JSMN_STRING = 3,
+    JSMN_PRIMITIVE = 4
+
+} jsmntype_t;
+
+typedef struct
+{
+    jsmntype_t type;
+    int start;
+    int end;
+    int size;
+
+} jsmntok_t;
+
+#endif /* __JSMN_H_ */
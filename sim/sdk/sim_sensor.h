@@ -0,0 +1,39 @@
+#ifndef _SIM_SENSOR_H
+#define _SIM_SENSOR_H
+
+#include <bc_i2c.h>
+#include <bc_scheduler.h>
+
+typedef enum
+{
+    SIM_SENSOR_TEMPERATURE = 0,
+    SIM_SENSOR_HUMIDITY = 1,
+    SIM_SENSOR_LUX_METER = 2,
+    SIM_SENSOR_BAROMETER = 3,
+    SIM_SENSOR_CO2 = 4,
+    SIM_SENSOR_COUNT = 5
+
+} sim_sensor_kind_t;
+
+typedef struct sim_sensor_t sim_sensor_t;
+
+struct sim_sensor_t
+{
+    void *_node;
+    sim_sensor_kind_t _kind;
+    uint8_t _i2c;
+    bool _present;
+    bc_tick_t _update_interval;
+    bc_scheduler_task_id_t _task_id;
+    bool _valid;
+    float _value;
+    void (*_event)(sim_sensor_t *sensor, bool valid);
+    void *_owner;
+
+};
+
+void sim_sensor_init(sim_sensor_t *self, sim_sensor_kind_t kind, bc_i2c_channel_t i2c_channel, uint8_t i2c_address, void *owner, void (*event)(sim_sensor_t *, bool));
+void sim_sensor_set_update_interval(sim_sensor_t *self, bc_tick_t interval);
+bool sim_sensor_get(sim_sensor_t *self, float *value);
+
+#endif /* _SIM_SENSOR_H */
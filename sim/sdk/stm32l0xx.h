@@ -0,0 +1,91 @@
+#ifndef _STM32L0XX_H
+#define _STM32L0XX_H
+
+#include <stdint.h>
+
+typedef struct
+{
+    volatile uint32_t CR1;
+    volatile uint32_t CR2;
+    volatile uint32_t SMCR;
+    volatile uint32_t DIER;
+    volatile uint32_t SR;
+    volatile uint32_t EGR;
+    volatile uint32_t CCMR1;
+    volatile uint32_t CCMR2;
+    volatile uint32_t CCER;
+    volatile uint32_t CNT;
+    volatile uint32_t PSC;
+    volatile uint32_t ARR;
+    volatile uint32_t RESERVED1;
+    volatile uint32_t CCR1;
+    volatile uint32_t CCR2;
+    volatile uint32_t CCR3;
+    volatile uint32_t CCR4;
+
+} TIM_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t CR;
+    volatile uint32_t ICSCR;
+    volatile uint32_t CRRCR;
+    volatile uint32_t CFGR;
+    volatile uint32_t CIER;
+    volatile uint32_t CIFR;
+    volatile uint32_t CICR;
+    volatile uint32_t IOPRSTR;
+    volatile uint32_t AHBRSTR;
+    volatile uint32_t APB2RSTR;
+    volatile uint32_t APB1RSTR;
+    volatile uint32_t IOPENR;
+    volatile uint32_t AHBENR;
+    volatile uint32_t APB2ENR;
+    volatile uint32_t APB1ENR;
+
+} RCC_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t MODER;
+    volatile uint32_t OTYPER;
+    volatile uint32_t OSPEEDR;
+    volatile uint32_t PUPDR;
+    volatile uint32_t IDR;
+    volatile uint32_t ODR;
+    volatile uint32_t BSRR;
+    volatile uint32_t LCKR;
+    volatile uint32_t AFR[2];
+    volatile uint32_t BRR;
+
+} GPIO_TypeDef;
+
+extern RCC_TypeDef sim_rcc;
+extern GPIO_TypeDef sim_gpioa;
+extern TIM_TypeDef sim_tim2;
+extern uint32_t SystemCoreClock;
+
+// Every access refreshes the counter from the host clock, so profiled sections measure host time
+TIM_TypeDef *sim_tim6_get(void);
+
+// The main stack pointer lies in the block that stands in for the RAM of the linker script, wide enough for a host pointer
+uintptr_t __get_MSP(void);
+
+#define TIM2 (&sim_tim2)
+#define TIM6 (sim_tim6_get())
+#define RCC (&sim_rcc)
+#define GPIOA (&sim_gpioa)
+
+#define RCC_IOPENR_GPIOAEN (1UL << 0)
+#define RCC_APB1ENR_TIM2EN (1UL << 0)
+#define RCC_APB1ENR_TIM6EN (1UL << 4)
+#define TIM_CR1_CEN (1UL << 0)
+#define TIM_CR1_ARPE (1UL << 7)
+#define TIM_DIER_UDE (1UL << 8)
+#define TIM_EGR_UG (1UL << 0)
+#define TIM_CCMR1_OC2PE (1UL << 11)
+#define TIM_CCMR1_OC2M_1 (1UL << 13)
+#define TIM_CCMR1_OC2M_2 (1UL << 14)
+#define TIM_CCER_CC2E (1UL << 4)
+
+#endif /* _STM32L0XX_H */
@@ -0,0 +1,590 @@
+#include <sim.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SIM_APP(_prefix) \
+    extern void _prefix##_application_init(void) __attribute__((weak)); \
+    extern void _prefix##_application_task(void) __attribute__((weak)); \
+    extern void _prefix##_bc_radio_on_push_button(uint32_t *, uint16_t *) __attribute__((weak)); \
+    extern void _prefix##_bc_radio_on_thermometer(uint32_t *, uint8_t *, float *) __attribute__((weak)); \
+    extern void _prefix##_bc_radio_on_humidity(uint32_t *, uint8_t *, float *) __attribute__((weak)); \
+    extern void _prefix##_bc_radio_on_lux_meter(uint32_t *, uint8_t *, float *) __attribute__((weak)); \
+    extern void _prefix##_bc_radio_on_barometer(uint32_t *, uint8_t *, float *, float *) __attribute__((weak)); \
+    extern void _prefix##_bc_radio_on_co2(uint32_t *, float *) __attribute__((weak)); \
+    extern void _prefix##_bc_radio_on_buffer(uint32_t *, uint8_t *, size_t *) __attribute__((weak)); \
+    static const sim_app_t _prefix##_app = \
+    { \
+        .init = _prefix##_application_init, \
+        .task = _prefix##_application_task, \
+        .on_push_button = _prefix##_bc_radio_on_push_button, \
+        .on_thermometer = _prefix##_bc_radio_on_thermometer, \
+        .on_humidity = _prefix##_bc_radio_on_humidity, \
+        .on_lux_meter = _prefix##_bc_radio_on_lux_meter, \
+        .on_barometer = _prefix##_bc_radio_on_barometer, \
+        .on_co2 = _prefix##_bc_radio_on_co2, \
+        .on_buffer = _prefix##_bc_radio_on_buffer \
+    };
+
+SIM_APP(base)
+SIM_APP(remote)
+
+#define SIM_SCRIPT_LINES 1024
+#define SIM_PROBE_PENDING 16
+
+static sim_node_t _sim_nodes[] =
+{
+    { .id = 0x0001, .name = "base", .app = &base_app },
+    { .id = 0x0002, .name = "remote", .app = &remote_app }
+};
+
+static struct
+{
+    sim_node_t *current;
+    bc_tick_t now;
+    bc_tick_t duration;
+    bool realtime;
+    bool all_tags;
+    bool quit;
+    FILE *trace;
+
+    struct
+    {
+        bc_tick_t tick[SIM_SCRIPT_LINES];
+        char *line[SIM_SCRIPT_LINES];
+        size_t length;
+        size_t index;
+
+    } script;
+
+    struct
+    {
+        const char *name;
+        bc_tick_t pending[SIM_PROBE_PENDING];
+        size_t head;
+        size_t length;
+        uint32_t count;
+        uint64_t total;
+        bc_tick_t min;
+        bc_tick_t max;
+
+    } probes[SIM_PROBE_COUNT];
+
+} _sim =
+{
+    .duration = BC_TICK_INFINITY,
+    .probes = {
+        [SIM_PROBE_BUTTON_USB] = { .name = "button-usb" },
+        [SIM_PROBE_FRAME_DMA] = { .name = "frame-dma" },
+        [SIM_PROBE_BUTTON_LIGHT] = { .name = "button-light" }
+    }
+};
+
+static void _sim_usage(const char *name);
+static bool _sim_script_load(const char *path);
+static void _sim_script_run(void);
+static void _sim_console_run(void);
+static void _sim_command(char *line);
+static void _sim_pace(void);
+static uint64_t _sim_wall_get(void);
+
+int main(int argc, char **argv)
+{
+    const char *eeprom = NULL;
+    bool pty = true;
+    int option;
+
+    _sim.trace = stderr;
+
+    while ((option = getopt(argc, argv, "d:rs:t:qae:nu:h")) != -1)
+    {
+        switch (option)
+        {
+            case 'd':
+            {
+                _sim.duration = strtoull(optarg, NULL, 10);
+                break;
+            }
+            case 'r':
+            {
+                _sim.realtime = true;
+                break;
+            }
+            case 's':
+            {
+                if (!_sim_script_load(optarg))
+                {
+                    fprintf(stderr, "sim: cannot read script %s\n", optarg);
+                    return 1;
+                }
+                break;
+            }
+            case 't':
+            {
+                _sim.trace = fopen(optarg, "w");
+                if (_sim.trace == NULL)
+                {
+                    fprintf(stderr, "sim: cannot open trace %s\n", optarg);
+                    return 1;
+                }
+                break;
+            }
+            case 'q':
+            {
+                _sim.trace = NULL;
+                break;
+            }
+            case 'a':
+            {
+                _sim.all_tags = true;
+                break;
+            }
+            case 'e':
+            {
+                eeprom = optarg;
+                break;
+            }
+            case 'n':
+            {
+                pty = false;
+                break;
+            }
+            case 'u':
+            {
+                sim_usb_cdc_set_tx_rate(strtoul(optarg, NULL, 10));
+                break;
+            }
+            default:
+            {
+                _sim_usage(argv[0]);
+                return option == 'h' ? 0 : 1;
+            }
+        }
+    }
+
+    sim_usb_cdc_set_pty(pty);
+
+    if (_sim.realtime)
+    {
+        fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+    }
+
+    for (size_t i = 0; i < sim_node_get_count(); i++)
+    {
+        sim_node_t *node = &_sim_nodes[i];
+
+        node->random = node->id * 2654435761UL;
+
+        sim_eeprom_load(node, eeprom);
+
+        sim_node_set_current(node);
+        sim_scheduler_start(node);
+    }
+
+    while (!_sim.quit && (_sim.now < _sim.duration))
+    {
+        _sim_pace();
+
+        _sim_script_run();
+        _sim_console_run();
+
+        sim_load_run();
+        sim_radio_deliver();
+        sim_led_strip_run();
+
+        for (size_t i = 0; i < sim_node_get_count(); i++)
+        {
+            sim_node_set_current(&_sim_nodes[i]);
+            sim_scheduler_run(&_sim_nodes[i]);
+        }
+
+        bc_tick_t next = sim_radio_get_next();
+
+        if (sim_load_get_next() < next)
+        {
+            next = sim_load_get_next();
+        }
+
+        if (sim_led_strip_get_next() < next)
+        {
+            next = sim_led_strip_get_next();
+        }
+
+        for (size_t i = 0; i < sim_node_get_count(); i++)
+        {
+            bc_tick_t tick = sim_scheduler_get_next(&_sim_nodes[i]);
+
+            if (tick < next)
+            {
+                next = tick;
+            }
+        }
+
+        if ((_sim.script.index < _sim.script.length) && (_sim.script.tick[_sim.script.index] < next))
+        {
+            next = _sim.script.tick[_sim.script.index];
+        }
+
+        // Busy tasks keep the clock moving one tick per pass, idle periods are skipped
+        if ((next <= _sim.now) || _sim.realtime)
+        {
+            next = _sim.now + 1;
+        }
+
+        _sim.now = next;
+    }
+
+    for (size_t i = 0; i < sim_node_get_count(); i++)
+    {
+        sim_usb_cdc_close(&_sim_nodes[i]);
+    }
+
+    sim_probe_report();
+    sim_load_report();
+    sim_radio_report();
+
+    return 0;
+}
+
+sim_node_t *sim_node_get_current(void)
+{
+    return _sim.current;
+}
+
+void sim_node_set_current(sim_node_t *node)
+{
+    _sim.current = node;
+}
+
+sim_node_t *sim_node_find(const char *name)
+{
+    for (size_t i = 0; i < sim_node_get_count(); i++)
+    {
+        if (strcmp(_sim_nodes[i].name, name) == 0)
+        {
+            return &_sim_nodes[i];
+        }
+    }
+
+    return NULL;
+}
+
+sim_node_t *sim_node_get(size_t index)
+{
+    return index < sim_node_get_count() ? &_sim_nodes[index] : NULL;
+}
+
+size_t sim_node_get_count(void)
+{
+    return sizeof(_sim_nodes) / sizeof(_sim_nodes[0]);
+}
+
+bool sim_option_all_tags(void)
+{
+    return _sim.all_tags;
+}
+
+bc_tick_t sim_clock_get(void)
+{
+    return _sim.now;
+}
+
+void sim_trace(const char *format, ...)
+{
+    if (_sim.trace == NULL)
+    {
+        return;
+    }
+
+    fprintf(_sim.trace, "%8" PRIu64 ".%03" PRIu64 " %-6s ", _sim.now / 1000, _sim.now % 1000,
+            _sim.current != NULL ? _sim.current->name : "-");
+
+    va_list ap;
+    va_start(ap, format);
+    vfprintf(_sim.trace, format, ap);
+    va_end(ap);
+
+    fputc('\n', _sim.trace);
+    fflush(_sim.trace);
+}
+
+void sim_probe_start(sim_probe_t probe, bc_tick_t tick)
+{
+    if (_sim.probes[probe].length == SIM_PROBE_PENDING)
+    {
+        return;
+    }
+
+    size_t index = (_sim.probes[probe].head + _sim.probes[probe].length) % SIM_PROBE_PENDING;
+
+    _sim.probes[probe].pending[index] = tick;
+    _sim.probes[probe].length++;
+}
+
+void sim_probe_stop(sim_probe_t probe, bc_tick_t tick)
+{
+    if (_sim.probes[probe].length == 0)
+    {
+        return;
+    }
+
+    bc_tick_t latency = tick - _sim.probes[probe].pending[_sim.probes[probe].head];
+
+    _sim.probes[probe].head = (_sim.probes[probe].head + 1) % SIM_PROBE_PENDING;
+    _sim.probes[probe].length--;
+
+    if ((_sim.probes[probe].count == 0) || (latency < _sim.probes[probe].min))
+    {
+        _sim.probes[probe].min = latency;
+    }
+
+    if (latency > _sim.probes[probe].max)
+    {
+        _sim.probes[probe].max = latency;
+    }
+
+    _sim.probes[probe].count++;
+    _sim.probes[probe].total += latency;
+
+    sim_trace("latency %s %" PRIu64 " ms", _sim.probes[probe].name, latency);
+}
+
+void sim_probe_report(void)
+{
+    for (int i = 0; i < SIM_PROBE_COUNT; i++)
+    {
+        if (_sim.probes[i].count == 0)
+        {
+            continue;
+        }
+
+        printf("latency %-10s count %" PRIu32 " min %" PRIu64 " ms max %" PRIu64 " ms mean %.1f ms\n",
+               _sim.probes[i].name, _sim.probes[i].count, _sim.probes[i].min, _sim.probes[i].max,
+               (double) _sim.probes[i].total / _sim.probes[i].count);
+    }
+}
+
+static void _sim_usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [-d ms] [-r] [-s script] [-t trace | -q] [-a] [-e directory] [-n] [-u bytes]\n"
+            "  -d  stop after this many milliseconds of virtual time\n"
+            "  -r  run in real time and read commands from stdin\n"
+            "  -s  run commands from a script of \"<ms> <command>\" lines\n"
+            "  -t  write the trace to a file instead of stderr\n"
+            "  -q  no trace\n"
+            "  -a  attach every tag on both I2C channels, not only the default ones\n"
+            "  -e  keep EEPROM images of the nodes in a directory\n"
+            "  -n  no pty for the base USB port, use the usb command to talk to it\n"
+            "  -u  bytes the USB port sends per millisecond, 64 by default\n"
+            "commands:\n"
+            "  button <node> [press|hold]\n"
+            "  encoder <node> <increment>\n"
+            "  usb <line>\n"
+            "  set <node> <temperature|humidity|lux-meter|barometer|co2> <value|auto>\n"
+            "  load <remotes> <interval> <jitter> <thermometer,humidity,lux-meter,barometer,co2,encoder,button>\n"
+            "  load stop\n"
+            "  quit\n",
+            name);
+}
+
+static bool _sim_script_load(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    char line[4096];
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    while ((_sim.script.length < SIM_SCRIPT_LINES) && (fgets(line, sizeof(line), file) != NULL))
+    {
+        char *command;
+        unsigned long long tick = strtoull(line, &command, 10);
+
+        if ((command == line) || (line[0] == '#'))
+        {
+            continue;
+        }
+
+        while (isspace((unsigned char) *command))
+        {
+            command++;
+        }
+
+        _sim.script.tick[_sim.script.length] = tick;
+        _sim.script.line[_sim.script.length] = strdup(command);
+        _sim.script.length++;
+    }
+
+    fclose(file);
+
+    return true;
+}
+
+static void _sim_script_run(void)
+{
+    while ((_sim.script.index < _sim.script.length) && (_sim.script.tick[_sim.script.index] <= _sim.now))
+    {
+        _sim_command(_sim.script.line[_sim.script.index++]);
+    }
+}
+
+static void _sim_console_run(void)
+{
+    static char line[4096];
+    static size_t length;
+    char character;
+
+    if (!_sim.realtime)
+    {
+        return;
+    }
+
+    while (read(STDIN_FILENO, &character, 1) == 1)
+    {
+        if (character == '\n')
+        {
+            line[length] = '\0';
+            _sim_command(line);
+            length = 0;
+        }
+        else if (length < sizeof(line) - 1)
+        {
+            line[length++] = character;
+        }
+    }
+}
+
+static void _sim_command(char *line)
+{
+    char *end = line + strlen(line);
+
+    while ((end > line) && isspace((unsigned char) end[-1]))
+    {
+        *--end = '\0';
+    }
+
+    char *command = strtok(line, " ");
+
+    if (command == NULL)
+    {
+        return;
+    }
+
+    sim_node_set_current(NULL);
+
+    if (strcmp(command, "usb") == 0)
+    {
+        char *text = command + strlen(command) + 1;
+
+        if (text < end)
+        {
+            sim_usb_cdc_inject(sim_node_find("base"), text);
+        }
+
+        return;
+    }
+
+    if (strcmp(command, "quit") == 0)
+    {
+        _sim.quit = true;
+        return;
+    }
+
+    if (strcmp(command, "load") == 0)
+    {
+        char *count = strtok(NULL, " ");
+        char *interval = strtok(NULL, " ");
+        char *jitter = strtok(NULL, " ");
+        char *mix = strtok(NULL, " ");
+
+        if ((count != NULL) && (strcmp(count, "stop") == 0))
+        {
+            sim_load_stop();
+        }
+        else if (mix != NULL)
+        {
+            sim_load_start(atoi(count), strtoull(interval, NULL, 10), strtoull(jitter, NULL, 10), mix);
+        }
+        else
+        {
+            sim_trace("load needs remotes, interval, jitter and a mix");
+        }
+
+        return;
+    }
+
+    char *name = strtok(NULL, " ");
+    char *argument = strtok(NULL, " ");
+    char *value = strtok(NULL, " ");
+    sim_node_t *node = name != NULL ? sim_node_find(name) : NULL;
+
+    if (node == NULL)
+    {
+        sim_trace("unknown node in command %s", command);
+        return;
+    }
+
+    if (strcmp(command, "button") == 0)
+    {
+        bool hold = (argument != NULL) && (strcmp(argument, "hold") == 0);
+
+        if (!hold)
+        {
+            sim_probe_start(SIM_PROBE_BUTTON_USB, _sim.now);
+            sim_probe_start(SIM_PROBE_BUTTON_LIGHT, _sim.now);
+        }
+
+        sim_button_event(node, hold ? BC_BUTTON_EVENT_HOLD : BC_BUTTON_EVENT_PRESS);
+    }
+    else if ((strcmp(command, "encoder") == 0) && (argument != NULL))
+    {
+        sim_encoder_rotate(node, atoi(argument));
+    }
+    else if ((strcmp(command, "set") == 0) && (argument != NULL) && (value != NULL))
+    {
+        if (!sim_sensor_override(node, argument, value))
+        {
+            sim_trace("unknown sensor %s", argument);
+        }
+    }
+    else
+    {
+        sim_trace("unknown command %s", command);
+    }
+}
+
+static void _sim_pace(void)
+{
+    static uint64_t start;
+
+    if (!_sim.realtime)
+    {
+        return;
+    }
+
+    if (start == 0)
+    {
+        start = _sim_wall_get();
+    }
+
+    uint64_t elapsed = _sim_wall_get() - start;
+
+    if (_sim.now > elapsed)
+    {
+        usleep((useconds_t) (_sim.now - elapsed) * 1000);
+    }
+}
+
+static uint64_t _sim_wall_get(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
@@ -0,0 +1,184 @@
+#ifndef _SIM_H
+#define _SIM_H
+
+#include <bcl.h>
+
+#define SIM_EEPROM_SIZE 6144
+#define SIM_LED_STRIP_MAX_BYTES 4096
+
+typedef struct
+{
+    void (*init)(void);
+    void (*task)(void);
+    void (*on_push_button)(uint32_t *peer_device_address, uint16_t *event_count);
+    void (*on_thermometer)(uint32_t *peer_device_address, uint8_t *i2c, float *temperature);
+    void (*on_humidity)(uint32_t *peer_device_address, uint8_t *i2c, float *percentage);
+    void (*on_lux_meter)(uint32_t *peer_device_address, uint8_t *i2c, float *illuminance);
+    void (*on_barometer)(uint32_t *peer_device_address, uint8_t *i2c, float *pressure, float *altitude);
+    void (*on_co2)(uint32_t *peer_device_address, float *concentration);
+    void (*on_buffer)(uint32_t *peer_device_address, uint8_t *buffer, size_t *length);
+
+} sim_app_t;
+
+typedef struct
+{
+    void (*task)(void *);
+    void *param;
+    bc_tick_t tick;
+
+} sim_task_t;
+
+typedef struct
+{
+    uint32_t id;
+    const char *name;
+    const sim_app_t *app;
+
+    struct
+    {
+        sim_task_t tasks[BC_SCHEDULER_MAX_TASKS];
+        size_t length;
+        bc_scheduler_task_id_t current;
+
+    } scheduler;
+
+    struct
+    {
+        uint8_t memory[SIM_EEPROM_SIZE];
+        char path[256];
+
+    } eeprom;
+
+    struct
+    {
+        bool enabled;
+        int master;
+        int slave;
+        char inject[4096];
+        size_t inject_length;
+        char rx_line[128];
+        size_t rx_length;
+        bc_tick_t rx_start;
+        bool frame_pending;
+        size_t tx_pending;
+        size_t tx_pending_max;
+        bc_tick_t tx_tick;
+        uint32_t tx_rejected;
+
+    } usb;
+
+    struct
+    {
+        bool initialized;
+        bool listening;
+        bool enrollment;
+        void (*event_handler)(bc_radio_event_t, void *);
+        void *event_param;
+
+    } radio;
+
+    struct
+    {
+        void (*event_handler)(bc_module_co2_event_t, void *);
+        void *event_param;
+        sim_sensor_t sensor;
+
+    } co2;
+
+    struct
+    {
+        void (*event_handler)(bc_module_encoder_event_t, void *);
+        void *event_param;
+        int increment;
+
+    } encoder;
+
+    struct
+    {
+        bool overridden;
+        float value;
+
+    } models[SIM_SENSOR_COUNT];
+
+    struct
+    {
+        uint8_t wire[SIM_LED_STRIP_MAX_BYTES];
+        size_t wire_length;
+        uint8_t shown[SIM_LED_STRIP_MAX_BYTES];
+        size_t shown_length;
+        uint8_t byte;
+        int bits;
+        int low;
+
+    } led_strip;
+
+    struct
+    {
+        const bc_font_t *font;
+        char text[512];
+        size_t length;
+        char shown[512];
+
+    } lcd;
+
+    bc_button_t *button;
+    bool power_relay;
+    uint32_t random;
+
+} sim_node_t;
+
+typedef enum
+{
+    SIM_PROBE_BUTTON_USB = 0,
+    SIM_PROBE_FRAME_DMA = 1,
+    SIM_PROBE_BUTTON_LIGHT = 2,
+    SIM_PROBE_COUNT = 3
+
+} sim_probe_t;
+
+sim_node_t *sim_node_get_current(void);
+void sim_node_set_current(sim_node_t *node);
+sim_node_t *sim_node_find(const char *name);
+sim_node_t *sim_node_get(size_t index);
+size_t sim_node_get_count(void);
+bool sim_option_all_tags(void);
+
+bc_tick_t sim_clock_get(void);
+void sim_trace(const char *format, ...);
+
+void sim_scheduler_start(sim_node_t *node);
+void sim_scheduler_run(sim_node_t *node);
+bc_tick_t sim_scheduler_get_next(sim_node_t *node);
+
+bc_tick_t sim_led_strip_get_next(void);
+void sim_led_strip_run(void);
+
+void sim_usb_cdc_set_pty(bool enabled);
+void sim_usb_cdc_set_tx_rate(size_t bytes_per_tick);
+bc_tick_t sim_usb_cdc_get_tx_delay(sim_node_t *node);
+void sim_usb_cdc_inject(sim_node_t *node, const char *line);
+void sim_usb_cdc_close(sim_node_t *node);
+
+bc_tick_t sim_radio_get_next(void);
+void sim_radio_deliver(void);
+void sim_radio_report(void);
+bool sim_radio_inject_push_button(uint32_t peer, uint16_t event_count);
+bool sim_radio_inject_buffer(uint32_t peer, const void *buffer, size_t length);
+
+void sim_load_start(int count, bc_tick_t interval, bc_tick_t jitter, const char *mix);
+void sim_load_stop(void);
+bc_tick_t sim_load_get_next(void);
+void sim_load_run(void);
+void sim_load_report(void);
+
+void sim_eeprom_load(sim_node_t *node, const char *directory);
+
+void sim_button_event(sim_node_t *node, bc_button_event_t event);
+void sim_encoder_rotate(sim_node_t *node, int increment);
+bool sim_sensor_override(sim_node_t *node, const char *kind, const char *value);
+
+void sim_probe_start(sim_probe_t probe, bc_tick_t tick);
+void sim_probe_stop(sim_probe_t probe, bc_tick_t tick);
+void sim_probe_report(void);
+
+#endif /* _SIM_H */
@@ -0,0 +1,91 @@
+#include <base64.h>
+
+static int _sim_base64_value(char character);
+
+bool base64_decode(const char *input, uint32_t input_length, uint8_t *output, uint32_t *output_length)
+{
+    uint32_t length = base64_calculate_decode_length(input, input_length);
+    uint32_t bits = 0;
+    uint32_t count = 0;
+    uint32_t position = 0;
+
+    if ((input_length % 4 != 0) || (length > *output_length))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < input_length; i++)
+    {
+        if (input[i] == '=')
+        {
+            break;
+        }
+
+        int value = _sim_base64_value(input[i]);
+
+        if (value < 0)
+        {
+            return false;
+        }
+
+        bits = (bits << 6) | (uint32_t) value;
+        count += 6;
+
+        if (count >= 8)
+        {
+            count -= 8;
+            output[position++] = (uint8_t) (bits >> count);
+        }
+    }
+
+    *output_length = position;
+
+    return true;
+}
+
+uint32_t base64_calculate_decode_length(const char *input, uint32_t length)
+{
+    uint32_t padding = 0;
+
+    if ((length >= 1) && (input[length - 1] == '='))
+    {
+        padding++;
+    }
+
+    if ((length >= 2) && (input[length - 2] == '='))
+    {
+        padding++;
+    }
+
+    return length / 4 * 3 - padding;
+}
+
+static int _sim_base64_value(char character)
+{
+    if ((character >= 'A') && (character <= 'Z'))
+    {
+        return character - 'A';
+    }
+
+    if ((character >= 'a') && (character <= 'z'))
+    {
+        return character - 'a' + 26;
+    }
+
+    if ((character >= '0') && (character <= '9'))
+    {
+        return character - '0' + 52;
+    }
+
+    if (character == '+')
+    {
+        return 62;
+    }
+
+    if (character == '/')
+    {
+        return 63;
+    }
+
+    return -1;
+}
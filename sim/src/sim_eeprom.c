@@ -0,0 +1,86 @@
+#include <sim.h>
+
+static void _sim_eeprom_save(sim_node_t *node);
+
+void sim_eeprom_load(sim_node_t *node, const char *directory)
+{
+    memset(node->eeprom.memory, 0, sizeof(node->eeprom.memory));
+
+    if (directory == NULL)
+    {
+        node->eeprom.path[0] = '\0';
+        return;
+    }
+
+    snprintf(node->eeprom.path, sizeof(node->eeprom.path), "%s/%s.eeprom", directory, node->name);
+
+    FILE *file = fopen(node->eeprom.path, "rb");
+
+    if (file == NULL)
+    {
+        return;
+    }
+
+    if (fread(node->eeprom.memory, 1, sizeof(node->eeprom.memory), file) != sizeof(node->eeprom.memory))
+    {
+        fprintf(stderr, "sim: short eeprom image %s\n", node->eeprom.path);
+    }
+
+    fclose(file);
+}
+
+bool bc_eeprom_write(uint32_t address, const void *buffer, size_t length)
+{
+    sim_node_t *node = sim_node_get_current();
+
+    if ((address + length) > sizeof(node->eeprom.memory))
+    {
+        return false;
+    }
+
+    memcpy(node->eeprom.memory + address, buffer, length);
+
+    sim_trace("eeprom write %zu bytes at 0x%04" PRIx32, length, address);
+
+    _sim_eeprom_save(node);
+
+    return true;
+}
+
+bool bc_eeprom_read(uint32_t address, void *buffer, size_t length)
+{
+    sim_node_t *node = sim_node_get_current();
+
+    if ((address + length) > sizeof(node->eeprom.memory))
+    {
+        return false;
+    }
+
+    memcpy(buffer, node->eeprom.memory + address, length);
+
+    return true;
+}
+
+size_t bc_eeprom_get_size(void)
+{
+    return sizeof(sim_node_get_current()->eeprom.memory);
+}
+
+static void _sim_eeprom_save(sim_node_t *node)
+{
+    if (node->eeprom.path[0] == '\0')
+    {
+        return;
+    }
+
+    FILE *file = fopen(node->eeprom.path, "wb");
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "sim: cannot write eeprom image %s\n", node->eeprom.path);
+        return;
+    }
+
+    fwrite(node->eeprom.memory, 1, sizeof(node->eeprom.memory), file);
+    fclose(file);
+}
@@ -0,0 +1,194 @@
+#include <sim.h>
+#include <bc_dma.h>
+#include <stm32l0xx.h>
+
+// 1 ms of virtual time at 800 kbit/s
+#define SIM_LED_STRIP_SLOTS_PER_TICK 800
+
+// The strip latches the received data after 50 us of low line
+#define SIM_LED_STRIP_LATCH_SLOTS 40
+
+GPIO_TypeDef sim_gpioa;
+TIM_TypeDef sim_tim2;
+
+// Only DMA channel 2 is played, it feeds the compare register of TIM2 that drives the strip
+static struct
+{
+    sim_node_t *owner;
+    void (*event_handler)(bc_dma_channel_t, bc_dma_event_t, void *);
+    void *event_param;
+    const uint8_t *memory;
+    uint32_t length;
+    bool circular;
+    bool enabled;
+    uint32_t position;
+    bc_tick_t tick;
+
+} _sim_led_strip;
+
+static void _sim_led_strip_slot(sim_node_t *node, uint8_t pulse);
+static void _sim_led_strip_latch(sim_node_t *node);
+static void _sim_led_strip_event(bc_dma_event_t event);
+
+void bc_dma_init(void)
+{
+}
+
+void bc_dma_channel_config(bc_dma_channel_t channel, bc_dma_channel_config_t *config)
+{
+    if (channel != BC_DMA_CHANNEL_2)
+    {
+        return;
+    }
+
+    _sim_led_strip.memory = (const uint8_t *) config->address_memory;
+    _sim_led_strip.length = config->length;
+    _sim_led_strip.circular = config->mode == BC_DMA_MODE_CIRCULAR;
+}
+
+// The node that sets the handler drives the strip, the handler is called by the simulated transfer
+void bc_dma_set_event_handler(bc_dma_channel_t channel, void (*event_handler)(bc_dma_channel_t, bc_dma_event_t, void *), void *event_param)
+{
+    if (channel != BC_DMA_CHANNEL_2)
+    {
+        return;
+    }
+
+    _sim_led_strip.owner = sim_node_get_current();
+    _sim_led_strip.event_handler = event_handler;
+    _sim_led_strip.event_param = event_param;
+}
+
+void bc_dma_channel_run(bc_dma_channel_t channel)
+{
+    if (channel != BC_DMA_CHANNEL_2)
+    {
+        return;
+    }
+
+    _sim_led_strip.enabled = true;
+    _sim_led_strip.position = 0;
+}
+
+void bc_dma_channel_stop(bc_dma_channel_t channel)
+{
+    if (channel != BC_DMA_CHANNEL_2)
+    {
+        return;
+    }
+
+    _sim_led_strip.enabled = false;
+}
+
+bc_tick_t sim_led_strip_get_next(void)
+{
+    bool enabled = _sim_led_strip.enabled && (sim_tim2.CR1 & TIM_CR1_CEN);
+
+    return enabled ? sim_clock_get() + 1 : BC_TICK_INFINITY;
+}
+
+// Plays the transfers of the ticks since the last call, the timer requests one compare value per bit period
+void sim_led_strip_run(void)
+{
+    bc_tick_t now = sim_clock_get();
+    uint64_t slots = (now - _sim_led_strip.tick) * SIM_LED_STRIP_SLOTS_PER_TICK;
+    sim_node_t *node = _sim_led_strip.owner;
+
+    _sim_led_strip.tick = now;
+
+    if (node == NULL)
+    {
+        return;
+    }
+
+    sim_node_set_current(node);
+
+    for (; (slots > 0) && _sim_led_strip.enabled && (sim_tim2.CR1 & TIM_CR1_CEN); slots--)
+    {
+        _sim_led_strip_slot(node, _sim_led_strip.memory[_sim_led_strip.position++]);
+
+        if (_sim_led_strip.position == _sim_led_strip.length / 2)
+        {
+            _sim_led_strip_event(BC_DMA_EVENT_HALF_DONE);
+        }
+        else if (_sim_led_strip.position == _sim_led_strip.length)
+        {
+            _sim_led_strip.position = 0;
+            _sim_led_strip.enabled = _sim_led_strip.circular;
+
+            _sim_led_strip_event(BC_DMA_EVENT_DONE);
+        }
+    }
+}
+
+static void _sim_led_strip_slot(sim_node_t *node, uint8_t pulse)
+{
+    if (pulse == 0)
+    {
+        node->led_strip.bits = 0;
+
+        if (++node->led_strip.low == SIM_LED_STRIP_LATCH_SLOTS)
+        {
+            _sim_led_strip_latch(node);
+        }
+
+        return;
+    }
+
+    node->led_strip.low = 0;
+
+    // A pulse longer than half the bit period is a one
+    node->led_strip.byte = (node->led_strip.byte << 1) | (pulse > (sim_tim2.ARR + 1) / 2);
+
+    if (++node->led_strip.bits == 8)
+    {
+        node->led_strip.bits = 0;
+
+        if (node->led_strip.wire_length < sizeof(node->led_strip.wire))
+        {
+            node->led_strip.wire[node->led_strip.wire_length++] = node->led_strip.byte;
+        }
+    }
+}
+
+static void _sim_led_strip_latch(sim_node_t *node)
+{
+    size_t length = node->led_strip.wire_length;
+    const uint8_t *wire = node->led_strip.wire;
+
+    if (length == 0)
+    {
+        return;
+    }
+
+    if ((length != node->led_strip.shown_length) || (memcmp(wire, node->led_strip.shown, length) != 0))
+    {
+        memcpy(node->led_strip.shown, wire, length);
+        node->led_strip.shown_length = length;
+
+        sim_probe_stop(SIM_PROBE_BUTTON_LIGHT, sim_clock_get());
+
+        // Bytes in the order of the wire, green first
+        sim_trace("led-strip show %zu bytes, first %02x %02x %02x %02x, last %02x %02x %02x %02x", length,
+                  wire[0], length > 1 ? wire[1] : 0, length > 2 ? wire[2] : 0, length > 3 ? wire[3] : 0,
+                  length > 3 ? wire[length - 4] : 0, length > 2 ? wire[length - 3] : 0,
+                  length > 1 ? wire[length - 2] : 0, wire[length - 1]);
+    }
+
+    if (node->usb.frame_pending)
+    {
+        node->usb.frame_pending = false;
+
+        sim_probe_stop(SIM_PROBE_FRAME_DMA, sim_clock_get());
+    }
+
+    node->led_strip.wire_length = 0;
+}
+
+static void _sim_led_strip_event(bc_dma_event_t event)
+{
+    if (_sim_led_strip.event_handler != NULL)
+    {
+        _sim_led_strip.event_handler(BC_DMA_CHANNEL_2, event, _sim_led_strip.event_param);
+    }
+}
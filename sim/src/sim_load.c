@@ -0,0 +1,225 @@
+#include <sim.h>
+
+#define SIM_LOAD_REMOTES 256
+#define SIM_LOAD_PEER 0x100000
+
+// The packets are built by the remote firmware's own schema encoder, linked under the prefix of its copy of common/
+#define radio_schema_begin remote_radio_schema_begin
+#define radio_schema_add_int remote_radio_schema_add_int
+#define radio_schema_add_stats remote_radio_schema_add_stats
+
+#include <radio_schema.h>
+
+// The push button goes out as an event of its own, after the kinds of the schema
+#define SIM_LOAD_PUSH_BUTTON RADIO_BUFFER_COUNT
+#define SIM_LOAD_COUNT (RADIO_BUFFER_COUNT + 1)
+
+static const char *_sim_load_kinds[SIM_LOAD_COUNT] =
+{
+    [RADIO_BUFFER_ENCODER] = "encoder",
+    [RADIO_BUFFER_THERMOMETER] = "thermometer",
+    [RADIO_BUFFER_HUMIDITY] = "humidity",
+    [RADIO_BUFFER_LUX_METER] = "lux-meter",
+    [RADIO_BUFFER_BAROMETER] = "barometer",
+    [RADIO_BUFFER_CO2] = "co2",
+    [SIM_LOAD_PUSH_BUTTON] = "button"
+};
+
+static struct
+{
+    struct
+    {
+        bc_tick_t next;
+        uint16_t event_count;
+
+    } remotes[SIM_LOAD_REMOTES];
+
+    int count;
+    bc_tick_t interval;
+    bc_tick_t jitter;
+    bool mix[SIM_LOAD_COUNT];
+    uint32_t random;
+    bc_tick_t start;
+    uint32_t offered;
+    uint32_t refused;
+
+} _sim_load;
+
+static void _sim_load_send(int index, int kind);
+static sensor_stats_t *_sim_load_stats_set(sensor_stats_t *stats, float value, float spread);
+static bc_tick_t _sim_load_random(bc_tick_t range);
+
+void sim_load_start(int count, bc_tick_t interval, bc_tick_t jitter, const char *mix)
+{
+    char list[128];
+
+    if ((count < 1) || (count > SIM_LOAD_REMOTES) || (interval == 0) || (jitter >= interval))
+    {
+        sim_trace("load needs 1 to %d remotes and a jitter below the interval", SIM_LOAD_REMOTES);
+        return;
+    }
+
+    memset(_sim_load.mix, 0, sizeof(_sim_load.mix));
+
+    snprintf(list, sizeof(list), "%s", mix);
+
+    for (char *name = strtok(list, ","); name != NULL; name = strtok(NULL, ","))
+    {
+        int i;
+
+        for (i = 0; (i < SIM_LOAD_COUNT) && (strcmp(name, _sim_load_kinds[i]) != 0); i++)
+        {
+        }
+
+        if (i == SIM_LOAD_COUNT)
+        {
+            sim_trace("load unknown kind %s", name);
+            return;
+        }
+
+        _sim_load.mix[i] = true;
+    }
+
+    _sim_load.count = count;
+    _sim_load.interval = interval;
+    _sim_load.jitter = jitter;
+    _sim_load.random = 0x2545f491;
+    _sim_load.start = sim_clock_get();
+
+    // Remotes start spread over one interval like devices that were powered on at random
+    for (int i = 0; i < count; i++)
+    {
+        _sim_load.remotes[i].next = _sim_load.start + _sim_load_random(interval);
+        _sim_load.remotes[i].event_count = 0;
+    }
+
+    sim_trace("load %d remotes every %" PRIu64 " +- %" PRIu64 " ms, %s", count, interval, jitter, mix);
+}
+
+void sim_load_stop(void)
+{
+    sim_trace("load stop");
+
+    _sim_load.count = 0;
+}
+
+bc_tick_t sim_load_get_next(void)
+{
+    bc_tick_t next = BC_TICK_INFINITY;
+
+    for (int i = 0; i < _sim_load.count; i++)
+    {
+        if (_sim_load.remotes[i].next < next)
+        {
+            next = _sim_load.remotes[i].next;
+        }
+    }
+
+    return next;
+}
+
+void sim_load_run(void)
+{
+    bc_tick_t now = sim_clock_get();
+
+    for (int i = 0; i < _sim_load.count; i++)
+    {
+        if (_sim_load.remotes[i].next > now)
+        {
+            continue;
+        }
+
+        for (int kind = 0; kind < SIM_LOAD_COUNT; kind++)
+        {
+            if (_sim_load.mix[kind])
+            {
+                _sim_load_send(i, kind);
+            }
+        }
+
+        _sim_load.remotes[i].next = now + _sim_load.interval - _sim_load.jitter + _sim_load_random(2 * _sim_load.jitter + 1);
+    }
+}
+
+void sim_load_report(void)
+{
+    if (_sim_load.offered == 0)
+    {
+        return;
+    }
+
+    bc_tick_t duration = sim_clock_get() - _sim_load.start;
+
+    printf("load offered %" PRIu32 " refused %" PRIu32 " rate %.1f packets/s\n", _sim_load.offered, _sim_load.refused,
+           duration != 0 ? _sim_load.offered * 1000.0 / duration : 0.0);
+}
+
+static void _sim_load_send(int index, int kind)
+{
+    radio_schema_t schema;
+    sensor_stats_t stats[RADIO_SCHEMA_QUANTITIES];
+    uint32_t peer = SIM_LOAD_PEER + index;
+    bool sent = false;
+
+    radio_schema_begin(&schema);
+
+    switch (kind)
+    {
+        case SIM_LOAD_PUSH_BUTTON:
+        {
+            sent = sim_radio_inject_push_button(peer, _sim_load.remotes[index].event_count++);
+            break;
+        }
+        case RADIO_BUFFER_ENCODER:
+        {
+            radio_schema_add_int(&schema, kind, 1);
+            break;
+        }
+        case RADIO_BUFFER_THERMOMETER:
+        {
+            radio_schema_add_stats(&schema, kind, 0, _sim_load_stats_set(&stats[0], 20.f, 1.f), NULL);
+            break;
+        }
+        case RADIO_BUFFER_BAROMETER:
+        {
+            radio_schema_add_stats(&schema, kind, 0, _sim_load_stats_set(&stats[0], 101325.f, 20.f),
+                                   _sim_load_stats_set(&stats[1], 0.f, 2.f));
+            break;
+        }
+        default:
+        {
+            radio_schema_add_stats(&schema, kind, 0, _sim_load_stats_set(&stats[0], 20.f + kind * 100.f, 1.f), NULL);
+            break;
+        }
+    }
+
+    if (kind != SIM_LOAD_PUSH_BUTTON)
+    {
+        sent = sim_radio_inject_buffer(peer, schema.buffer, schema.length);
+    }
+
+    _sim_load.offered++;
+
+    if (!sent)
+    {
+        _sim_load.refused++;
+    }
+}
+
+// A window of five samples spread around the value
+static sensor_stats_t *_sim_load_stats_set(sensor_stats_t *stats, float value, float spread)
+{
+    stats->count = 5;
+    stats->min = value - spread;
+    stats->max = value + spread;
+    stats->sum = value * stats->count;
+
+    return stats;
+}
+
+static bc_tick_t _sim_load_random(bc_tick_t range)
+{
+    _sim_load.random = _sim_load.random * 1664525UL + 1013904223UL;
+
+    return range != 0 ? (_sim_load.random >> 8) % range : 0;
+}
@@ -0,0 +1,204 @@
+#include <sim.h>
+
+static const char *_sim_led_modes[] = { "off", "on", "blink", "blink-slow", "blink-fast", "flash" };
+
+const bc_font_t bc_font_ubuntu_11 = { "ubuntu-11", 6, 11 };
+const bc_font_t bc_font_ubuntu_13 = { "ubuntu-13", 7, 13 };
+const bc_font_t bc_font_ubuntu_15 = { "ubuntu-15", 8, 15 };
+const bc_font_t bc_font_ubuntu_24 = { "ubuntu-24", 13, 24 };
+const bc_font_t bc_font_ubuntu_28 = { "ubuntu-28", 15, 28 };
+const bc_font_t bc_font_ubuntu_33 = { "ubuntu-33", 18, 33 };
+
+bc_module_lcd_framebuffer_t _bc_module_lcd_framebuffer;
+
+void bc_led_init(bc_led_t *self, bc_gpio_channel_t gpio_channel, bool open_drain_output, bool idle_state)
+{
+    (void) open_drain_output;
+    (void) idle_state;
+
+    memset(self, 0, sizeof(*self));
+
+    self->_node = sim_node_get_current();
+    self->_channel = gpio_channel;
+}
+
+void bc_led_set_mode(bc_led_t *self, bc_led_mode_t mode)
+{
+    if (self->_mode != mode)
+    {
+        sim_trace("led %s", _sim_led_modes[mode]);
+    }
+
+    self->_mode = mode;
+}
+
+void bc_led_pulse(bc_led_t *self, bc_tick_t duration)
+{
+    (void) self;
+
+    sim_trace("led pulse %" PRIu64 " ms", duration);
+}
+
+bool bc_module_relay_init(bc_module_relay_t *self, uint8_t i2c_address)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_node = sim_node_get_current();
+    self->_i2c_address = i2c_address;
+    self->_state = BC_MODULE_RELAY_STATE_UNKNOWN;
+
+    return true;
+}
+
+void bc_module_relay_set_state(bc_module_relay_t *self, bool state)
+{
+    sim_trace("relay 0x%02x %s", self->_i2c_address, state ? "true" : "false");
+
+    self->_state = state ? BC_MODULE_RELAY_STATE_TRUE : BC_MODULE_RELAY_STATE_FALSE;
+}
+
+bc_module_relay_state_t bc_module_relay_get_state(bc_module_relay_t *self)
+{
+    return self->_state;
+}
+
+void bc_module_power_init(void)
+{
+    sim_node_get_current()->power_relay = false;
+}
+
+void bc_module_power_relay_set_state(bool state)
+{
+    sim_trace("power relay %s", state ? "true" : "false");
+
+    sim_node_get_current()->power_relay = state;
+}
+
+bool bc_module_power_relay_get_state(void)
+{
+    return sim_node_get_current()->power_relay;
+}
+
+void bc_led_strip_init(bc_led_strip_t *self, const bc_led_strip_driver_t *driver, const bc_led_strip_buffer_t *buffer)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_driver = driver;
+    self->_buffer = buffer;
+
+    self->_driver->init(buffer);
+}
+
+int bc_led_strip_get_pixel_count(bc_led_strip_t *self)
+{
+    return self->_buffer->count;
+}
+
+bc_led_strip_type_t bc_led_strip_get_strip_type(bc_led_strip_t *self)
+{
+    return self->_buffer->type;
+}
+
+void bc_led_strip_set_pixel(bc_led_strip_t *self, int position, uint32_t color)
+{
+    self->_driver->set_pixel(position, color);
+}
+
+void bc_led_strip_set_pixel_rgbw(bc_led_strip_t *self, int position, uint8_t red, uint8_t green, uint8_t blue, uint8_t white)
+{
+    self->_driver->set_pixel_rgbw(position, red, green, blue, white);
+}
+
+bool bc_led_strip_set_rgbw_framebuffer(bc_led_strip_t *self, uint8_t *framebuffer, size_t length)
+{
+    size_t stride = self->_buffer->type == BC_LED_STRIP_TYPE_RGBW ? 4 : 3;
+
+    if (length > (size_t) self->_buffer->count * stride)
+    {
+        return false;
+    }
+
+    for (size_t i = 0, position = 0; i + stride <= length; i += stride, position++)
+    {
+        self->_driver->set_pixel_rgbw(position, framebuffer[i], framebuffer[i + 1], framebuffer[i + 2], stride == 4 ? framebuffer[i + 3] : 0);
+    }
+
+    return true;
+}
+
+void bc_led_strip_fill(bc_led_strip_t *self, uint32_t color)
+{
+    for (int i = 0; i < self->_buffer->count; i++)
+    {
+        self->_driver->set_pixel(i, color);
+    }
+}
+
+bool bc_led_strip_write(bc_led_strip_t *self)
+{
+    return self->_driver->write();
+}
+
+bool bc_led_strip_is_ready(bc_led_strip_t *self)
+{
+    return self->_driver->is_ready();
+}
+
+void bc_led_strip_effect_stop(bc_led_strip_t *self)
+{
+    (void) self;
+}
+
+void bc_module_lcd_init(bc_module_lcd_framebuffer_t *framebuffer)
+{
+    (void) framebuffer;
+
+    sim_node_get_current()->lcd.font = &bc_font_ubuntu_15;
+}
+
+void bc_module_lcd_clear(void)
+{
+    sim_node_t *node = sim_node_get_current();
+
+    node->lcd.text[0] = '\0';
+    node->lcd.length = 0;
+}
+
+void bc_module_lcd_set_font(const bc_font_t *font)
+{
+    sim_node_get_current()->lcd.font = font;
+}
+
+int bc_module_lcd_draw_string(int left, int top, char *str)
+{
+    sim_node_t *node = sim_node_get_current();
+
+    (void) top;
+
+    if (node->lcd.length < sizeof(node->lcd.text))
+    {
+        node->lcd.length += snprintf(node->lcd.text + node->lcd.length, sizeof(node->lcd.text) - node->lcd.length,
+                                     "%s%s", node->lcd.length != 0 ? " | " : "", str);
+
+        if (node->lcd.length >= sizeof(node->lcd.text))
+        {
+            node->lcd.length = sizeof(node->lcd.text) - 1;
+        }
+    }
+
+    return left + node->lcd.font->width * (int) strlen(str);
+}
+
+bool bc_module_lcd_update(void)
+{
+    sim_node_t *node = sim_node_get_current();
+
+    if (strcmp(node->lcd.text, node->lcd.shown) != 0)
+    {
+        strcpy(node->lcd.shown, node->lcd.text);
+
+        sim_trace("lcd %s", node->lcd.shown);
+    }
+
+    return true;
+}
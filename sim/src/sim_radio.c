@@ -0,0 +1,487 @@
+#include <sim.h>
+
+#define SIM_RADIO_QUEUE 64
+#define SIM_RADIO_PAYLOAD 64
+#define SIM_RADIO_OVERHEAD 16
+#define SIM_RADIO_BITRATE 19200
+
+typedef enum
+{
+    SIM_RADIO_PACKET_PAIR = 0,
+    SIM_RADIO_PACKET_PUSH_BUTTON = 1,
+    SIM_RADIO_PACKET_THERMOMETER = 2,
+    SIM_RADIO_PACKET_HUMIDITY = 3,
+    SIM_RADIO_PACKET_LUX_METER = 4,
+    SIM_RADIO_PACKET_BAROMETER = 5,
+    SIM_RADIO_PACKET_CO2 = 6,
+    SIM_RADIO_PACKET_BUFFER = 7
+
+} sim_radio_packet_type_t;
+
+typedef struct
+{
+    sim_radio_packet_type_t type;
+    sim_node_t *sender;
+    uint32_t peer;
+    bc_tick_t created;
+    bc_tick_t done;
+    uint8_t i2c;
+    float value[2];
+    uint16_t event_count;
+    uint8_t buffer[SIM_RADIO_PAYLOAD];
+    size_t length;
+
+} sim_radio_packet_t;
+
+typedef struct
+{
+    bc_tick_t *samples;
+    size_t length;
+    size_t size;
+
+} sim_radio_latency_t;
+
+static struct
+{
+    sim_radio_packet_t queue[SIM_RADIO_QUEUE];
+    size_t head;
+    size_t length;
+    bc_tick_t free;
+    uint32_t sent;
+    uint32_t delivered;
+    uint32_t dropped;
+    size_t depth_max;
+    uint64_t depth_total;
+    sim_radio_latency_t air;
+    sim_radio_latency_t usb;
+
+} _sim_radio;
+
+static sim_radio_packet_t *_sim_radio_packet_new(sim_radio_packet_type_t type, size_t length);
+static sim_radio_packet_t *_sim_radio_packet_queue(sim_node_t *sender, uint32_t peer, sim_radio_packet_type_t type, size_t length);
+static void _sim_radio_packet_deliver(sim_radio_packet_t *packet, sim_node_t *node);
+static void _sim_radio_latency_add(sim_radio_latency_t *latency, bc_tick_t value);
+static void _sim_radio_latency_report(const char *name, sim_radio_latency_t *latency);
+static int _sim_radio_latency_compare(const void *a, const void *b);
+
+bc_tick_t sim_radio_get_next(void)
+{
+    return _sim_radio.length != 0 ? _sim_radio.queue[_sim_radio.head].done : BC_TICK_INFINITY;
+}
+
+void sim_radio_deliver(void)
+{
+    while ((_sim_radio.length != 0) && (_sim_radio.queue[_sim_radio.head].done <= sim_clock_get()))
+    {
+        sim_radio_packet_t packet = _sim_radio.queue[_sim_radio.head];
+
+        _sim_radio.head = (_sim_radio.head + 1) % SIM_RADIO_QUEUE;
+        _sim_radio.length--;
+
+        for (size_t i = 0; i < sim_node_get_count(); i++)
+        {
+            sim_node_t *node = sim_node_get(i);
+
+            if ((node == packet.sender) || !node->radio.listening)
+            {
+                continue;
+            }
+
+            sim_node_set_current(node);
+
+            _sim_radio_packet_deliver(&packet, node);
+
+            _sim_radio_latency_add(&_sim_radio.air, sim_clock_get() - packet.created);
+
+            // End to end is done when the last byte the handler wrote has left the USB FIFO
+            if (node->usb.enabled)
+            {
+                _sim_radio_latency_add(&_sim_radio.usb, sim_clock_get() + sim_usb_cdc_get_tx_delay(node) - packet.created);
+            }
+        }
+    }
+}
+
+bool sim_radio_inject_push_button(uint32_t peer, uint16_t event_count)
+{
+    sim_radio_packet_t *packet = _sim_radio_packet_queue(NULL, peer, SIM_RADIO_PACKET_PUSH_BUTTON, sizeof(event_count));
+
+    if (packet == NULL)
+    {
+        return false;
+    }
+
+    packet->event_count = event_count;
+
+    return true;
+}
+
+bool sim_radio_inject_buffer(uint32_t peer, const void *buffer, size_t length)
+{
+    if (length > SIM_RADIO_PAYLOAD)
+    {
+        return false;
+    }
+
+    sim_radio_packet_t *packet = _sim_radio_packet_queue(NULL, peer, SIM_RADIO_PACKET_BUFFER, length);
+
+    if (packet == NULL)
+    {
+        return false;
+    }
+
+    memcpy(packet->buffer, buffer, length);
+    packet->length = length;
+
+    return true;
+}
+
+void sim_radio_report(void)
+{
+    bc_tick_t now = sim_clock_get();
+
+    printf("radio sent %" PRIu32 " delivered %" PRIu32 " dropped %" PRIu32 "\n",
+           _sim_radio.sent, _sim_radio.delivered, _sim_radio.dropped);
+
+    if (_sim_radio.sent == 0)
+    {
+        return;
+    }
+
+    printf("radio throughput %.1f packets/s queue depth max %zu mean %.1f\n",
+           now != 0 ? _sim_radio.delivered * 1000.0 / now : 0.0, _sim_radio.depth_max,
+           (double) _sim_radio.depth_total / _sim_radio.sent);
+
+    _sim_radio_latency_report("air", &_sim_radio.air);
+    _sim_radio_latency_report("usb", &_sim_radio.usb);
+
+    for (size_t i = 0; i < sim_node_get_count(); i++)
+    {
+        sim_node_t *node = sim_node_get(i);
+
+        if (node->usb.enabled)
+        {
+            printf("usb %s tx pending max %zu rejected %" PRIu32 "\n", node->name, node->usb.tx_pending_max, node->usb.tx_rejected);
+        }
+    }
+}
+
+void bc_radio_init(void)
+{
+    sim_node_t *node = sim_node_get_current();
+
+    node->radio.initialized = true;
+}
+
+void bc_radio_set_event_handler(void (*event_handler)(bc_radio_event_t, void *), void *event_param)
+{
+    sim_node_t *node = sim_node_get_current();
+
+    node->radio.event_handler = event_handler;
+    node->radio.event_param = event_param;
+}
+
+void bc_radio_listen(void)
+{
+    sim_node_get_current()->radio.listening = true;
+}
+
+void bc_radio_enrollment_start(void)
+{
+    sim_trace("radio enrollment start");
+
+    sim_node_get_current()->radio.enrollment = true;
+}
+
+void bc_radio_enrollment_stop(void)
+{
+    sim_trace("radio enrollment stop");
+
+    sim_node_get_current()->radio.enrollment = false;
+}
+
+void bc_radio_enroll_to_gateway(void)
+{
+    _sim_radio_packet_new(SIM_RADIO_PACKET_PAIR, 0);
+}
+
+bool bc_radio_pub_push_button(uint16_t *event_count)
+{
+    sim_radio_packet_t *packet = _sim_radio_packet_new(SIM_RADIO_PACKET_PUSH_BUTTON, sizeof(*event_count));
+
+    if (packet == NULL)
+    {
+        return false;
+    }
+
+    packet->event_count = *event_count;
+
+    return true;
+}
+
+bool bc_radio_pub_thermometer(uint8_t i2c, float *temperature)
+{
+    sim_radio_packet_t *packet = _sim_radio_packet_new(SIM_RADIO_PACKET_THERMOMETER, 1 + sizeof(float));
+
+    if (packet == NULL)
+    {
+        return false;
+    }
+
+    packet->i2c = i2c;
+    packet->value[0] = *temperature;
+
+    return true;
+}
+
+bool bc_radio_pub_humidity(uint8_t i2c, float *percentage)
+{
+    sim_radio_packet_t *packet = _sim_radio_packet_new(SIM_RADIO_PACKET_HUMIDITY, 1 + sizeof(float));
+
+    if (packet == NULL)
+    {
+        return false;
+    }
+
+    packet->i2c = i2c;
+    packet->value[0] = *percentage;
+
+    return true;
+}
+
+bool bc_radio_pub_luminosity(uint8_t i2c, float *lux)
+{
+    sim_radio_packet_t *packet = _sim_radio_packet_new(SIM_RADIO_PACKET_LUX_METER, 1 + sizeof(float));
+
+    if (packet == NULL)
+    {
+        return false;
+    }
+
+    packet->i2c = i2c;
+    packet->value[0] = *lux;
+
+    return true;
+}
+
+bool bc_radio_pub_barometer(uint8_t i2c, float *pascal, float *meter)
+{
+    sim_radio_packet_t *packet = _sim_radio_packet_new(SIM_RADIO_PACKET_BAROMETER, 1 + 2 * sizeof(float));
+
+    if (packet == NULL)
+    {
+        return false;
+    }
+
+    packet->i2c = i2c;
+    packet->value[0] = *pascal;
+    packet->value[1] = *meter;
+
+    return true;
+}
+
+bool bc_radio_pub_co2(float *concentration)
+{
+    sim_radio_packet_t *packet = _sim_radio_packet_new(SIM_RADIO_PACKET_CO2, sizeof(float));
+
+    if (packet == NULL)
+    {
+        return false;
+    }
+
+    packet->value[0] = *concentration;
+
+    return true;
+}
+
+bool bc_radio_pub_buffer(void *buffer, size_t length)
+{
+    if (length > SIM_RADIO_PAYLOAD)
+    {
+        return false;
+    }
+
+    sim_radio_packet_t *packet = _sim_radio_packet_new(SIM_RADIO_PACKET_BUFFER, length);
+
+    if (packet == NULL)
+    {
+        return false;
+    }
+
+    memcpy(packet->buffer, buffer, length);
+    packet->length = length;
+
+    return true;
+}
+
+static sim_radio_packet_t *_sim_radio_packet_new(sim_radio_packet_type_t type, size_t length)
+{
+    sim_node_t *node = sim_node_get_current();
+
+    return _sim_radio_packet_queue(node, node->id, type, length);
+}
+
+static sim_radio_packet_t *_sim_radio_packet_queue(sim_node_t *sender, uint32_t peer, sim_radio_packet_type_t type, size_t length)
+{
+    if (_sim_radio.length == SIM_RADIO_QUEUE)
+    {
+        _sim_radio.dropped++;
+
+        sim_trace("radio queue full, packet dropped");
+
+        return NULL;
+    }
+
+    sim_radio_packet_t *packet = &_sim_radio.queue[(_sim_radio.head + _sim_radio.length) % SIM_RADIO_QUEUE];
+
+    memset(packet, 0, sizeof(*packet));
+
+    // One shared channel, packets go on air one after another
+    bc_tick_t start = _sim_radio.free > sim_clock_get() ? _sim_radio.free : sim_clock_get();
+    bc_tick_t airtime = ((SIM_RADIO_OVERHEAD + length) * 8 * 1000 + SIM_RADIO_BITRATE - 1) / SIM_RADIO_BITRATE;
+
+    packet->type = type;
+    packet->sender = sender;
+    packet->peer = peer;
+    packet->created = sim_clock_get();
+    packet->done = start + airtime;
+
+    _sim_radio.free = packet->done;
+    _sim_radio.length++;
+    _sim_radio.sent++;
+
+    if (_sim_radio.length > _sim_radio.depth_max)
+    {
+        _sim_radio.depth_max = _sim_radio.length;
+    }
+
+    _sim_radio.depth_total += _sim_radio.length;
+
+    if (sender != NULL)
+    {
+        sim_trace("radio tx type %d, %zu bytes, on air until %" PRIu64, type, length, packet->done);
+    }
+
+    return packet;
+}
+
+static void _sim_radio_packet_deliver(sim_radio_packet_t *packet, sim_node_t *node)
+{
+    uint32_t peer = packet->peer;
+    const sim_app_t *app = node->app;
+
+    _sim_radio.delivered++;
+
+    switch (packet->type)
+    {
+        case SIM_RADIO_PACKET_PAIR:
+        {
+            if (node->radio.enrollment && (node->radio.event_handler != NULL))
+            {
+                node->radio.event_handler(BC_RADIO_EVENT_PAIR_SUCCESS, node->radio.event_param);
+            }
+            break;
+        }
+        case SIM_RADIO_PACKET_PUSH_BUTTON:
+        {
+            if (app->on_push_button != NULL)
+            {
+                app->on_push_button(&peer, &packet->event_count);
+            }
+            break;
+        }
+        case SIM_RADIO_PACKET_THERMOMETER:
+        {
+            if (app->on_thermometer != NULL)
+            {
+                app->on_thermometer(&peer, &packet->i2c, &packet->value[0]);
+            }
+            break;
+        }
+        case SIM_RADIO_PACKET_HUMIDITY:
+        {
+            if (app->on_humidity != NULL)
+            {
+                app->on_humidity(&peer, &packet->i2c, &packet->value[0]);
+            }
+            break;
+        }
+        case SIM_RADIO_PACKET_LUX_METER:
+        {
+            if (app->on_lux_meter != NULL)
+            {
+                app->on_lux_meter(&peer, &packet->i2c, &packet->value[0]);
+            }
+            break;
+        }
+        case SIM_RADIO_PACKET_BAROMETER:
+        {
+            if (app->on_barometer != NULL)
+            {
+                app->on_barometer(&peer, &packet->i2c, &packet->value[0], &packet->value[1]);
+            }
+            break;
+        }
+        case SIM_RADIO_PACKET_CO2:
+        {
+            if (app->on_co2 != NULL)
+            {
+                app->on_co2(&peer, &packet->value[0]);
+            }
+            break;
+        }
+        case SIM_RADIO_PACKET_BUFFER:
+        {
+            if (app->on_buffer != NULL)
+            {
+                app->on_buffer(&peer, packet->buffer, &packet->length);
+            }
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
+
+static void _sim_radio_latency_add(sim_radio_latency_t *latency, bc_tick_t value)
+{
+    if (latency->length == latency->size)
+    {
+        size_t size = latency->size != 0 ? latency->size * 2 : 1024;
+        bc_tick_t *samples = realloc(latency->samples, size * sizeof(*samples));
+
+        if (samples == NULL)
+        {
+            return;
+        }
+
+        latency->samples = samples;
+        latency->size = size;
+    }
+
+    latency->samples[latency->length++] = value;
+}
+
+static void _sim_radio_latency_report(const char *name, sim_radio_latency_t *latency)
+{
+    if (latency->length == 0)
+    {
+        return;
+    }
+
+    qsort(latency->samples, latency->length, sizeof(*latency->samples), _sim_radio_latency_compare);
+
+    printf("radio latency %-3s p50 %" PRIu64 " ms p90 %" PRIu64 " ms p99 %" PRIu64 " ms max %" PRIu64 " ms\n", name,
+           latency->samples[latency->length * 50 / 100], latency->samples[latency->length * 90 / 100],
+           latency->samples[latency->length * 99 / 100], latency->samples[latency->length - 1]);
+}
+
+static int _sim_radio_latency_compare(const void *a, const void *b)
+{
+    bc_tick_t x = *(const bc_tick_t *) a;
+    bc_tick_t y = *(const bc_tick_t *) b;
+
+    return x < y ? -1 : x > y;
+}
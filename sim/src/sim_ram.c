@@ -0,0 +1,25 @@
+#include <sim.h>
+
+#define SIM_RAM_SIZE (20 * 1024)
+#define SIM_RAM_DATA 512
+#define SIM_RAM_BSS (14 * 1024)
+#define SIM_RAM_STACK 1024
+
+#define SIM_RAM_STRING(_x) #_x
+#define SIM_RAM_SYMBOL(_name, _offset) ".globl " #_name "\n.set " #_name ", _sim_ram + " SIM_RAM_STRING(_offset) "\n"
+
+// The firmware paints and scans the stack between the end of bss and the end of RAM through the linker script
+// symbols, here they point into a block no host code touches, laid out like the RAM of the Core Module
+static uint32_t _sim_ram[SIM_RAM_SIZE / sizeof(uint32_t)] __attribute__((used));
+
+__asm__(
+    SIM_RAM_SYMBOL(_sdata, 0)
+    SIM_RAM_SYMBOL(_sbss, SIM_RAM_DATA)
+    SIM_RAM_SYMBOL(_ebss, SIM_RAM_DATA + SIM_RAM_BSS)
+    SIM_RAM_SYMBOL(_estack, SIM_RAM_SIZE)
+);
+
+uintptr_t __get_MSP(void)
+{
+    return (uintptr_t) &_sim_ram[(SIM_RAM_SIZE - SIM_RAM_STACK) / sizeof(uint32_t)];
+}
@@ -0,0 +1,146 @@
+#include <sim.h>
+#include <stm32l0xx.h>
+#include <time.h>
+
+static TIM_TypeDef _sim_tim6;
+
+RCC_TypeDef sim_rcc;
+uint32_t SystemCoreClock = 32000000;
+
+static void _sim_scheduler_application_task(void *param);
+
+void sim_scheduler_start(sim_node_t *node)
+{
+    // The SDK registers the application task first, so it always gets task id 0
+    bc_scheduler_register(_sim_scheduler_application_task, node, node->app->task != NULL ? 0 : BC_TICK_INFINITY);
+
+    if (node->app->init != NULL)
+    {
+        node->app->init();
+    }
+}
+
+void sim_scheduler_run(sim_node_t *node)
+{
+    bc_tick_t now = sim_clock_get();
+
+    for (size_t i = 0; i < node->scheduler.length; i++)
+    {
+        sim_task_t *task = &node->scheduler.tasks[i];
+
+        if ((task->task == NULL) || (task->tick > now))
+        {
+            continue;
+        }
+
+        task->tick = BC_TICK_INFINITY;
+
+        node->scheduler.current = i;
+
+        task->task(task->param);
+    }
+}
+
+bc_tick_t sim_scheduler_get_next(sim_node_t *node)
+{
+    bc_tick_t next = BC_TICK_INFINITY;
+
+    for (size_t i = 0; i < node->scheduler.length; i++)
+    {
+        if ((node->scheduler.tasks[i].task != NULL) && (node->scheduler.tasks[i].tick < next))
+        {
+            next = node->scheduler.tasks[i].tick;
+        }
+    }
+
+    return next;
+}
+
+bc_tick_t bc_tick_get(void)
+{
+    return sim_clock_get();
+}
+
+bc_scheduler_task_id_t bc_scheduler_register(void (*task)(void *), void *param, bc_tick_t tick)
+{
+    sim_node_t *node = sim_node_get_current();
+
+    for (size_t i = 0; i < BC_SCHEDULER_MAX_TASKS; i++)
+    {
+        if (node->scheduler.tasks[i].task == NULL)
+        {
+            node->scheduler.tasks[i].task = task;
+            node->scheduler.tasks[i].param = param;
+            node->scheduler.tasks[i].tick = tick;
+
+            if (i >= node->scheduler.length)
+            {
+                node->scheduler.length = i + 1;
+            }
+
+            return i;
+        }
+    }
+
+    sim_trace("scheduler out of tasks");
+
+    abort();
+}
+
+void bc_scheduler_unregister(bc_scheduler_task_id_t task_id)
+{
+    sim_node_get_current()->scheduler.tasks[task_id].task = NULL;
+}
+
+bc_scheduler_task_id_t bc_scheduler_get_current_task_id(void)
+{
+    return sim_node_get_current()->scheduler.current;
+}
+
+void bc_scheduler_plan_now(bc_scheduler_task_id_t task_id)
+{
+    sim_node_get_current()->scheduler.tasks[task_id].tick = 0;
+}
+
+void bc_scheduler_plan_absolute(bc_scheduler_task_id_t task_id, bc_tick_t tick)
+{
+    sim_node_get_current()->scheduler.tasks[task_id].tick = tick;
+}
+
+void bc_scheduler_plan_relative(bc_scheduler_task_id_t task_id, bc_tick_t tick)
+{
+    sim_node_get_current()->scheduler.tasks[task_id].tick = sim_clock_get() + tick;
+}
+
+void bc_scheduler_plan_current_now(void)
+{
+    bc_scheduler_plan_now(bc_scheduler_get_current_task_id());
+}
+
+void bc_scheduler_plan_current_absolute(bc_tick_t tick)
+{
+    bc_scheduler_plan_absolute(bc_scheduler_get_current_task_id(), tick);
+}
+
+void bc_scheduler_plan_current_relative(bc_tick_t tick)
+{
+    bc_scheduler_plan_relative(bc_scheduler_get_current_task_id(), tick);
+}
+
+TIM_TypeDef *sim_tim6_get(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    _sim_tim6.CNT = (uint32_t) ((uint64_t) now.tv_sec * 1000000 + now.tv_nsec / 1000) & 0xffff;
+
+    return &_sim_tim6;
+}
+
+static void _sim_scheduler_application_task(void *param)
+{
+    sim_node_t *node = (sim_node_t *) param;
+
+    node->app->task();
+}
@@ -0,0 +1,391 @@
+#include <sim.h>
+
+#define SIM_SENSOR_PERIOD 3600000
+
+static const struct
+{
+    const char *name;
+    float mean;
+    float amplitude;
+    float noise;
+    float min;
+    float max;
+
+} _sim_sensor_models[SIM_SENSOR_COUNT] =
+{
+    [SIM_SENSOR_TEMPERATURE] = { "temperature", 22.f, 3.f, 0.1f, -40.f, 125.f },
+    [SIM_SENSOR_HUMIDITY] = { "humidity", 45.f, 10.f, 0.5f, 0.f, 100.f },
+    [SIM_SENSOR_LUX_METER] = { "lux-meter", 300.f, 250.f, 5.f, 0.f, 83865.f },
+    [SIM_SENSOR_BAROMETER] = { "barometer", 101325.f, 200.f, 2.f, 50000.f, 115000.f },
+    [SIM_SENSOR_CO2] = { "co2", 600.f, 200.f, 10.f, 0.f, 10000.f }
+};
+
+static void _sim_sensor_task(void *param);
+static float _sim_sensor_model(sim_node_t *node, sim_sensor_t *sensor);
+static void _sim_tag_temperature_event(sim_sensor_t *sensor, bool valid);
+static void _sim_tag_humidity_event(sim_sensor_t *sensor, bool valid);
+static void _sim_tag_lux_meter_event(sim_sensor_t *sensor, bool valid);
+static void _sim_tag_barometer_event(sim_sensor_t *sensor, bool valid);
+static void _sim_module_co2_event(sim_sensor_t *sensor, bool valid);
+
+void sim_sensor_init(sim_sensor_t *self, sim_sensor_kind_t kind, bc_i2c_channel_t i2c_channel, uint8_t i2c_address, void *owner, void (*event)(sim_sensor_t *, bool))
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_node = sim_node_get_current();
+    self->_kind = kind;
+    self->_i2c = (i2c_channel << 7) | i2c_address;
+    self->_owner = owner;
+    self->_event = event;
+    self->_update_interval = BC_TICK_INFINITY;
+
+    // Without -a only the first tag of each kind answers, the others report errors like a missing tag
+    self->_present = sim_option_all_tags() || (self->_i2c == 0x48) || (self->_i2c == 0x40) ||
+                     (self->_i2c == 0x44) || (self->_i2c == 0x60) || (kind == SIM_SENSOR_CO2);
+
+    self->_task_id = bc_scheduler_register(_sim_sensor_task, self, BC_TICK_INFINITY);
+}
+
+void sim_sensor_set_update_interval(sim_sensor_t *self, bc_tick_t interval)
+{
+    self->_update_interval = interval;
+
+    if (interval == BC_TICK_INFINITY)
+    {
+        bc_scheduler_plan_absolute(self->_task_id, BC_TICK_INFINITY);
+    }
+    else
+    {
+        bc_scheduler_plan_now(self->_task_id);
+    }
+}
+
+bool sim_sensor_get(sim_sensor_t *self, float *value)
+{
+    if (!self->_valid)
+    {
+        return false;
+    }
+
+    *value = self->_value;
+
+    return true;
+}
+
+bool sim_sensor_override(sim_node_t *node, const char *kind, const char *value)
+{
+    for (int i = 0; i < SIM_SENSOR_COUNT; i++)
+    {
+        if (strcmp(_sim_sensor_models[i].name, kind) == 0)
+        {
+            node->models[i].overridden = strcmp(value, "auto") != 0;
+            node->models[i].value = strtof(value, NULL);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void bc_tag_temperature_init(bc_tag_temperature_t *self, bc_i2c_channel_t i2c_channel, uint8_t i2c_address)
+{
+    memset(self, 0, sizeof(*self));
+
+    sim_sensor_init(&self->_sensor, SIM_SENSOR_TEMPERATURE, i2c_channel, i2c_address, self, _sim_tag_temperature_event);
+}
+
+void bc_tag_temperature_set_event_handler(bc_tag_temperature_t *self, void (*event_handler)(bc_tag_temperature_t *, bc_tag_temperature_event_t, void *), void *event_param)
+{
+    self->_event_handler = event_handler;
+    self->_event_param = event_param;
+}
+
+void bc_tag_temperature_set_update_interval(bc_tag_temperature_t *self, bc_tick_t interval)
+{
+    sim_sensor_set_update_interval(&self->_sensor, interval);
+}
+
+bool bc_tag_temperature_get_temperature_celsius(bc_tag_temperature_t *self, float *celsius)
+{
+    return sim_sensor_get(&self->_sensor, celsius);
+}
+
+void bc_tag_humidity_init(bc_tag_humidity_t *self, bc_tag_humidity_revision_t revision, bc_i2c_channel_t i2c_channel, uint8_t i2c_address)
+{
+    (void) revision;
+
+    memset(self, 0, sizeof(*self));
+
+    sim_sensor_init(&self->_sensor, SIM_SENSOR_HUMIDITY, i2c_channel, i2c_address, self, _sim_tag_humidity_event);
+}
+
+void bc_tag_humidity_set_event_handler(bc_tag_humidity_t *self, void (*event_handler)(bc_tag_humidity_t *, bc_tag_humidity_event_t, void *), void *event_param)
+{
+    self->_event_handler = event_handler;
+    self->_event_param = event_param;
+}
+
+void bc_tag_humidity_set_update_interval(bc_tag_humidity_t *self, bc_tick_t interval)
+{
+    sim_sensor_set_update_interval(&self->_sensor, interval);
+}
+
+bool bc_tag_humidity_get_humidity_percentage(bc_tag_humidity_t *self, float *percentage)
+{
+    return sim_sensor_get(&self->_sensor, percentage);
+}
+
+void bc_tag_lux_meter_init(bc_tag_lux_meter_t *self, bc_i2c_channel_t i2c_channel, uint8_t i2c_address)
+{
+    memset(self, 0, sizeof(*self));
+
+    sim_sensor_init(&self->_sensor, SIM_SENSOR_LUX_METER, i2c_channel, i2c_address, self, _sim_tag_lux_meter_event);
+}
+
+void bc_tag_lux_meter_set_event_handler(bc_tag_lux_meter_t *self, void (*event_handler)(bc_tag_lux_meter_t *, bc_tag_lux_meter_event_t, void *), void *event_param)
+{
+    self->_event_handler = event_handler;
+    self->_event_param = event_param;
+}
+
+void bc_tag_lux_meter_set_update_interval(bc_tag_lux_meter_t *self, bc_tick_t interval)
+{
+    sim_sensor_set_update_interval(&self->_sensor, interval);
+}
+
+bool bc_tag_lux_meter_get_luminosity_lux(bc_tag_lux_meter_t *self, float *lux)
+{
+    return sim_sensor_get(&self->_sensor, lux);
+}
+
+void bc_tag_barometer_init(bc_tag_barometer_t *self, bc_i2c_channel_t i2c_channel)
+{
+    memset(self, 0, sizeof(*self));
+
+    sim_sensor_init(&self->_sensor, SIM_SENSOR_BAROMETER, i2c_channel, 0x60, self, _sim_tag_barometer_event);
+}
+
+void bc_tag_barometer_set_event_handler(bc_tag_barometer_t *self, void (*event_handler)(bc_tag_barometer_t *, bc_tag_barometer_event_t, void *), void *event_param)
+{
+    self->_event_handler = event_handler;
+    self->_event_param = event_param;
+}
+
+void bc_tag_barometer_set_update_interval(bc_tag_barometer_t *self, bc_tick_t interval)
+{
+    sim_sensor_set_update_interval(&self->_sensor, interval);
+}
+
+bool bc_tag_barometer_get_pressure_pascal(bc_tag_barometer_t *self, float *pascal)
+{
+    return sim_sensor_get(&self->_sensor, pascal);
+}
+
+bool bc_tag_barometer_get_altitude_meter(bc_tag_barometer_t *self, float *meter)
+{
+    float pascal;
+
+    if (!sim_sensor_get(&self->_sensor, &pascal))
+    {
+        return false;
+    }
+
+    *meter = 44330.f * (1.f - powf(pascal / 101325.f, 1.f / 5.255f));
+
+    return true;
+}
+
+void bc_module_co2_init(void)
+{
+    sim_node_t *node = sim_node_get_current();
+
+    sim_sensor_init(&node->co2.sensor, SIM_SENSOR_CO2, BC_I2C_I2C0, 0x38, node, _sim_module_co2_event);
+}
+
+void bc_module_co2_set_event_handler(void (*event_handler)(bc_module_co2_event_t, void *), void *event_param)
+{
+    sim_node_t *node = sim_node_get_current();
+
+    node->co2.event_handler = event_handler;
+    node->co2.event_param = event_param;
+}
+
+void bc_module_co2_set_update_interval(bc_tick_t interval)
+{
+    sim_sensor_set_update_interval(&sim_node_get_current()->co2.sensor, interval);
+}
+
+bool bc_module_co2_get_concentration(float *ppm)
+{
+    return sim_sensor_get(&sim_node_get_current()->co2.sensor, ppm);
+}
+
+bool bc_module_encoder_init(void)
+{
+    return true;
+}
+
+void bc_module_encoder_set_event_handler(void (*event_handler)(bc_module_encoder_event_t, void *), void *event_param)
+{
+    sim_node_t *node = sim_node_get_current();
+
+    node->encoder.event_handler = event_handler;
+    node->encoder.event_param = event_param;
+}
+
+int bc_module_encoder_get_increment(void)
+{
+    sim_node_t *node = sim_node_get_current();
+    int increment = node->encoder.increment;
+
+    node->encoder.increment = 0;
+
+    return increment;
+}
+
+void sim_encoder_rotate(sim_node_t *node, int increment)
+{
+    sim_node_set_current(node);
+
+    sim_trace("encoder %+d", increment);
+
+    node->encoder.increment += increment;
+
+    if (node->encoder.event_handler != NULL)
+    {
+        node->encoder.event_handler(BC_MODULE_ENCODER_EVENT_ROTATION, node->encoder.event_param);
+    }
+}
+
+void bc_button_init(bc_button_t *self, bc_gpio_channel_t gpio_channel, bc_gpio_pull_t gpio_pull, bool idle_state)
+{
+    (void) gpio_pull;
+    (void) idle_state;
+
+    memset(self, 0, sizeof(*self));
+
+    self->_node = sim_node_get_current();
+    self->_channel = gpio_channel;
+
+    sim_node_get_current()->button = self;
+}
+
+void bc_button_set_event_handler(bc_button_t *self, void (*event_handler)(bc_button_t *, bc_button_event_t, void *), void *event_param)
+{
+    self->_event_handler = event_handler;
+    self->_event_param = event_param;
+}
+
+void sim_button_event(sim_node_t *node, bc_button_event_t event)
+{
+    sim_node_set_current(node);
+
+    sim_trace("button %s", event == BC_BUTTON_EVENT_HOLD ? "hold" : "press");
+
+    if ((node->button != NULL) && (node->button->_event_handler != NULL))
+    {
+        node->button->_event_handler(node->button, event, node->button->_event_param);
+    }
+}
+
+static void _sim_sensor_task(void *param)
+{
+    sim_sensor_t *self = (sim_sensor_t *) param;
+    sim_node_t *node = (sim_node_t *) self->_node;
+
+    self->_valid = self->_present;
+
+    if (self->_valid)
+    {
+        self->_value = _sim_sensor_model(node, self);
+    }
+
+    self->_event(self, self->_valid);
+
+    if (self->_update_interval != BC_TICK_INFINITY)
+    {
+        bc_scheduler_plan_current_relative(self->_update_interval);
+    }
+}
+
+static float _sim_sensor_model(sim_node_t *node, sim_sensor_t *sensor)
+{
+    const float pi = 3.14159265f;
+    float phase = (float) ((node->id * 131 + sensor->_i2c) % 360) * pi / 180.f;
+    float t = (float) (sim_clock_get() % SIM_SENSOR_PERIOD) / SIM_SENSOR_PERIOD;
+    float value;
+
+    if (node->models[sensor->_kind].overridden)
+    {
+        return node->models[sensor->_kind].value;
+    }
+
+    node->random = node->random * 1664525UL + 1013904223UL;
+
+    value = _sim_sensor_models[sensor->_kind].mean;
+    value += _sim_sensor_models[sensor->_kind].amplitude * sinf(2.f * pi * t + phase);
+    value += _sim_sensor_models[sensor->_kind].noise * ((float) (node->random >> 8) / (1 << 24) - 0.5f);
+
+    if (value < _sim_sensor_models[sensor->_kind].min)
+    {
+        value = _sim_sensor_models[sensor->_kind].min;
+    }
+
+    if (value > _sim_sensor_models[sensor->_kind].max)
+    {
+        value = _sim_sensor_models[sensor->_kind].max;
+    }
+
+    return value;
+}
+
+static void _sim_tag_temperature_event(sim_sensor_t *sensor, bool valid)
+{
+    bc_tag_temperature_t *self = (bc_tag_temperature_t *) sensor->_owner;
+
+    if (self->_event_handler != NULL)
+    {
+        self->_event_handler(self, valid ? BC_TAG_TEMPERATURE_EVENT_UPDATE : BC_TAG_TEMPERATURE_EVENT_ERROR, self->_event_param);
+    }
+}
+
+static void _sim_tag_humidity_event(sim_sensor_t *sensor, bool valid)
+{
+    bc_tag_humidity_t *self = (bc_tag_humidity_t *) sensor->_owner;
+
+    if (self->_event_handler != NULL)
+    {
+        self->_event_handler(self, valid ? BC_TAG_HUMIDITY_EVENT_UPDATE : BC_TAG_HUMIDITY_EVENT_ERROR, self->_event_param);
+    }
+}
+
+static void _sim_tag_lux_meter_event(sim_sensor_t *sensor, bool valid)
+{
+    bc_tag_lux_meter_t *self = (bc_tag_lux_meter_t *) sensor->_owner;
+
+    if (self->_event_handler != NULL)
+    {
+        self->_event_handler(self, valid ? BC_TAG_LUX_METER_EVENT_UPDATE : BC_TAG_LUX_METER_EVENT_ERROR, self->_event_param);
+    }
+}
+
+static void _sim_tag_barometer_event(sim_sensor_t *sensor, bool valid)
+{
+    bc_tag_barometer_t *self = (bc_tag_barometer_t *) sensor->_owner;
+
+    if (self->_event_handler != NULL)
+    {
+        self->_event_handler(self, valid ? BC_TAG_BAROMETER_EVENT_UPDATE : BC_TAG_BAROMETER_EVENT_ERROR, self->_event_param);
+    }
+}
+
+static void _sim_module_co2_event(sim_sensor_t *sensor, bool valid)
+{
+    sim_node_t *node = (sim_node_t *) sensor->_owner;
+
+    if (node->co2.event_handler != NULL)
+    {
+        node->co2.event_handler(valid ? BC_MODULE_CO2_EVENT_UPDATE : BC_MODULE_CO2_EVENT_ERROR, node->co2.event_param);
+    }
+}
@@ -0,0 +1,214 @@
+#define _XOPEN_SOURCE 600
+
+#include <sim.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define SIM_USB_CDC_TX_FIFO 1024
+
+static bool _sim_usb_cdc_pty = true;
+static size_t _sim_usb_cdc_tx_rate = 64;
+
+static void _sim_usb_cdc_open(sim_node_t *node);
+static void _sim_usb_cdc_rx(sim_node_t *node, char character);
+static void _sim_usb_cdc_tx_drain(sim_node_t *node);
+
+void sim_usb_cdc_set_pty(bool enabled)
+{
+    _sim_usb_cdc_pty = enabled;
+}
+
+void sim_usb_cdc_set_tx_rate(size_t bytes_per_tick)
+{
+    _sim_usb_cdc_tx_rate = bytes_per_tick != 0 ? bytes_per_tick : 1;
+}
+
+bc_tick_t sim_usb_cdc_get_tx_delay(sim_node_t *node)
+{
+    _sim_usb_cdc_tx_drain(node);
+
+    return (node->usb.tx_pending + _sim_usb_cdc_tx_rate - 1) / _sim_usb_cdc_tx_rate;
+}
+
+void sim_usb_cdc_inject(sim_node_t *node, const char *line)
+{
+    size_t length = strlen(line);
+
+    if ((node == NULL) || (node->usb.inject_length + length + 1 > sizeof(node->usb.inject)))
+    {
+        sim_trace("usb inject overflow");
+        return;
+    }
+
+    memcpy(node->usb.inject + node->usb.inject_length, line, length);
+    node->usb.inject_length += length;
+    node->usb.inject[node->usb.inject_length++] = '\n';
+}
+
+void sim_usb_cdc_close(sim_node_t *node)
+{
+    if (!node->usb.enabled || (node->usb.master < 0))
+    {
+        return;
+    }
+
+    close(node->usb.slave);
+    close(node->usb.master);
+
+    node->usb.master = -1;
+}
+
+void bc_usb_cdc_init(void)
+{
+    sim_node_t *node = sim_node_get_current();
+
+    node->usb.enabled = true;
+    node->usb.master = -1;
+    node->usb.slave = -1;
+
+    if (_sim_usb_cdc_pty)
+    {
+        _sim_usb_cdc_open(node);
+    }
+}
+
+bool bc_usb_cdc_write(const void *buffer, size_t length)
+{
+    sim_node_t *node = sim_node_get_current();
+    const char *text = (const char *) buffer;
+
+    _sim_usb_cdc_tx_drain(node);
+
+    // Like the SDK, a write that does not fit in the transmit FIFO is refused as a whole
+    if (node->usb.tx_pending + length > SIM_USB_CDC_TX_FIFO)
+    {
+        node->usb.tx_rejected++;
+
+        sim_trace("usb tx rejected, %zu bytes pending", node->usb.tx_pending);
+
+        return false;
+    }
+
+    node->usb.tx_pending += length;
+
+    if (node->usb.tx_pending > node->usb.tx_pending_max)
+    {
+        node->usb.tx_pending_max = node->usb.tx_pending;
+    }
+
+    if (strstr(text, "/push-button/") != NULL)
+    {
+        sim_probe_stop(SIM_PROBE_BUTTON_USB, sim_clock_get());
+    }
+
+    sim_trace("usb tx %.*s", (int) (length > 0 && text[length - 1] == '\n' ? length - 1 : length), text);
+
+    if (node->usb.master < 0)
+    {
+        return true;
+    }
+
+    ssize_t written = write(node->usb.master, buffer, length);
+
+    return (written >= 0) || (errno != EAGAIN);
+}
+
+size_t bc_usb_cdc_read(void *buffer, size_t length)
+{
+    sim_node_t *node = sim_node_get_current();
+    char *output = (char *) buffer;
+    size_t count = 0;
+
+    if (node->usb.inject_length != 0)
+    {
+        count = node->usb.inject_length < length ? node->usb.inject_length : length;
+
+        memcpy(output, node->usb.inject, count);
+        memmove(node->usb.inject, node->usb.inject + count, node->usb.inject_length - count);
+        node->usb.inject_length -= count;
+    }
+    else if (node->usb.master >= 0)
+    {
+        ssize_t received = read(node->usb.master, output, length);
+
+        count = received > 0 ? (size_t) received : 0;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        _sim_usb_cdc_rx(node, output[i]);
+    }
+
+    return count;
+}
+
+static void _sim_usb_cdc_open(sim_node_t *node)
+{
+    struct termios termios;
+
+    node->usb.master = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if ((node->usb.master < 0) || (grantpt(node->usb.master) != 0) || (unlockpt(node->usb.master) != 0))
+    {
+        fprintf(stderr, "sim: cannot open pty for %s\n", node->name);
+        node->usb.master = -1;
+        return;
+    }
+
+    // Keep the slave open so the master does not see a hangup between client sessions
+    node->usb.slave = open(ptsname(node->usb.master), O_RDWR | O_NOCTTY);
+
+    if ((node->usb.slave >= 0) && (tcgetattr(node->usb.slave, &termios) == 0))
+    {
+        cfmakeraw(&termios);
+        tcsetattr(node->usb.slave, TCSANOW, &termios);
+    }
+
+    fcntl(node->usb.master, F_SETFL, fcntl(node->usb.master, F_GETFL) | O_NONBLOCK);
+
+    printf("%s usb %s\n", node->name, ptsname(node->usb.master));
+    fflush(stdout);
+}
+
+static void _sim_usb_cdc_rx(sim_node_t *node, char character)
+{
+    if (node->usb.rx_length == 0)
+    {
+        node->usb.rx_start = sim_clock_get();
+    }
+
+    if (character == '\n')
+    {
+        node->usb.rx_line[node->usb.rx_length < sizeof(node->usb.rx_line) ? node->usb.rx_length : sizeof(node->usb.rx_line) - 1] = '\0';
+
+        sim_trace("usb rx %s%s", node->usb.rx_line, node->usb.rx_length >= sizeof(node->usb.rx_line) ? "..." : "");
+
+        if (strstr(node->usb.rx_line, "framebuffer/set") != NULL)
+        {
+            sim_probe_start(SIM_PROBE_FRAME_DMA, node->usb.rx_start);
+            node->usb.frame_pending = true;
+        }
+
+        node->usb.rx_length = 0;
+
+        return;
+    }
+
+    if (node->usb.rx_length < sizeof(node->usb.rx_line) - 1)
+    {
+        node->usb.rx_line[node->usb.rx_length] = character;
+    }
+
+    node->usb.rx_length++;
+}
+
+static void _sim_usb_cdc_tx_drain(sim_node_t *node)
+{
+    bc_tick_t now = sim_clock_get();
+    size_t drained = (size_t) (now - node->usb.tx_tick) * _sim_usb_cdc_tx_rate;
+
+    node->usb.tx_pending = drained < node->usb.tx_pending ? node->usb.tx_pending - drained : 0;
+    node->usb.tx_tick = now;
+}